@@ -0,0 +1,123 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_BUDGET_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_BUDGET_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "./allocation_stats.hpp"
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Upper bounds for the memory allocated by a block of statements, unlimited by default.
+/**
+ * Each limit is inclusive and compared to the AllocationStats of the block:
+ * max_allocations to allocation_count, max_bytes to bytes_requested and
+ * max_peak_live_bytes to peak_live_bytes.
+ */
+struct AllocationBudget
+{
+  uint64_t max_allocations = std::numeric_limits<uint64_t>::max();
+  uint64_t max_bytes = std::numeric_limits<uint64_t>::max();
+  int64_t max_peak_live_bytes = std::numeric_limits<int64_t>::max();
+
+  /// Return a copy of this budget with the given maximum number of allocations.
+  AllocationBudget
+  with_max_allocations(uint64_t value) const
+  {
+    AllocationBudget budget(*this);
+    budget.max_allocations = value;
+    return budget;
+  }
+
+  /// Return a copy of this budget with the given maximum number of bytes requested.
+  AllocationBudget
+  with_max_bytes(uint64_t value) const
+  {
+    AllocationBudget budget(*this);
+    budget.max_bytes = value;
+    return budget;
+  }
+
+  /// Return a copy of this budget with the given maximum peak of the live bytes.
+  AllocationBudget
+  with_max_peak_live_bytes(int64_t value) const
+  {
+    AllocationBudget budget(*this);
+    budget.max_peak_live_bytes = value;
+    return budget;
+  }
+};
+
+/// Internal table of the allocations by call site, see ScopedAllocationBudget.
+struct AllocationCallSites;
+
+/// Checks that the memory allocated by this thread while it is alive stays within a budget.
+/**
+ * Built on ScopedAllocationStats, so it also requires the interposition
+ * library, and additionally captures the stack of each allocation, so that a
+ * failed check can tell where the allocations came from.
+ *
+ * The googletest macros EXPECT_ALLOCATION_BUDGET(), EXPECT_MAX_ALLOCATIONS()
+ * and so on in gtest_quickstart.hpp wrap a block of statements with one.
+ */
+class ScopedAllocationBudget
+{
+public:
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  explicit ScopedAllocationBudget(const AllocationBudget & budget);
+
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  ~ScopedAllocationBudget();
+
+  ScopedAllocationBudget(const ScopedAllocationBudget &) = delete;
+  ScopedAllocationBudget & operator=(const ScopedAllocationBudget &) = delete;
+
+  /// Return true if the allocations made since construction are within the budget.
+  /**
+   * If not and report is not nullptr, it is set to a description of each
+   * exceeded limit followed by the allocations by call site, most bytes first.
+   * Memory allocated to build the report is not counted.
+   */
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  bool
+  check(std::string * report = nullptr) const;
+
+  /// Return the counters for the memory operations made since construction.
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  AllocationStats
+  get_stats() const;
+
+  /// Return the budget given on construction.
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  const AllocationBudget &
+  get_budget() const;
+
+private:
+  AllocationBudget budget_;
+  AllocationCallSites * call_sites_;
+  ScopedAllocationStats stats_;
+};
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_BUDGET_HPP_
@@ -0,0 +1,141 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_LIFETIMES_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_LIFETIMES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Number of buckets of AllocationLifetimes, one per power of two of a 64-bit duration.
+static constexpr size_t ALLOCATION_LIFETIME_BUCKET_COUNT = 65;
+
+/// Allocations freed before this many nanoseconds, 2^14 or about 16 microseconds, are short-lived.
+static constexpr uint64_t SHORT_LIVED_ALLOCATION_NS = 1 << 14;
+
+/// Call sites with fewer frees than this are never flagged, there is not enough data.
+static constexpr uint64_t ALLOCATION_LIFETIME_MIN_FREED_COUNT = 16;
+
+/// How long the allocations from a call stack lived, counted when they are freed.
+struct AllocationLifetimes
+{
+  /// Program counters of the call stack which allocated, innermost first, empty if unknown.
+  std::vector<void *> stack;
+  /// Number of frees by lifetime, 0 for 0 ns and bucket i for [2^(i-1), 2^i) ns.
+  uint64_t buckets[ALLOCATION_LIFETIME_BUCKET_COUNT];
+  /// Sum of the bytes requested by the freed allocations.
+  uint64_t bytes_freed;
+  /// Number of frees made by the thread which allocated the memory.
+  uint64_t freed_by_allocating_thread_count;
+  /// Number of frees shorter than SHORT_LIVED_ALLOCATION_NS made by the allocating thread.
+  uint64_t short_lived_count;
+  /// Number of allocations made by a thread right after it freed the previous one of this stack.
+  /**
+   * Right after means without allocating anything else in between, which is
+   * what allocating and freeing in a loop looks like.
+   */
+  uint64_t allocated_after_free_count;
+
+  /// Return the number of frees in all buckets.
+  uint64_t
+  freed_count() const
+  {
+    uint64_t count = 0;
+    for (uint64_t bucket_count : buckets) {
+      count += bucket_count;
+    }
+    return count;
+  }
+
+  /// Return true if at least 90% of the frees were short-lived, i.e. a stack buffer could do.
+  bool
+  is_short_lived() const
+  {
+    const uint64_t count = freed_count();
+    return count >= ALLOCATION_LIFETIME_MIN_FREED_COUNT && short_lived_count * 10 >= count * 9;
+  }
+
+  /// Return true if at least half of the frees were followed by an allocation from here.
+  /** Those allocations could reuse the memory, e.g. from a pool or by hoisting them. */
+  bool
+  is_allocated_in_loop() const
+  {
+    const uint64_t count = freed_count();
+    return count >= ALLOCATION_LIFETIME_MIN_FREED_COUNT && allocated_after_free_count * 2 >= count;
+  }
+};
+
+/// Start recording when each heap allocation is made and freed, and by which thread.
+/**
+ * Keeps the live allocation table, see enable_live_allocation_tracking(),
+ * with the time of each allocation, and adds the lifetime of every freed
+ * allocation to the counters of the call stack which allocated it, until
+ * disable_allocation_lifetime_analysis() is called.
+ * Memory allocated before is not known, so its frees are not counted.
+ *
+ * Setting the `MEMORY_TOOLS_ALLOCATION_LIFETIMES` environment variable to
+ * `1` enables it at load time, and prints the lifetimes of the call sites
+ * which freed the most to stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ *
+ * \returns false if the live allocation table is not available, otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+enable_allocation_lifetime_analysis();
+
+/// Stop recording allocation lifetimes, the counters are kept until reset.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_allocation_lifetime_analysis();
+
+/// Return true if allocation lifetimes are being recorded.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+allocation_lifetime_analysis_enabled();
+
+/// Set the counters of every call stack back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_allocation_lifetimes();
+
+/// Return the lifetimes of every call stack which had memory freed, most frees first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<AllocationLifetimes>
+get_allocation_lifetimes();
+
+/// Return the lifetimes of the call stacks with the most frees, symbolized.
+/**
+ * Each call site says if it is short-lived or allocated in a loop, and the
+ * report starts with the number of such call sites.
+ * Memory allocated to build the report is not counted.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_allocation_lifetimes(size_t max_call_sites = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_LIFETIMES_HPP_
@@ -0,0 +1,103 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_REPORT_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_REPORT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Heap allocations made from a call stack, and those of them which are still live.
+struct AllocationHotspot
+{
+  /// Program counters of the call stack, innermost first, empty if it is unknown.
+  std::vector<void *> stack;
+  /// Number of allocations, estimated if the heap profile is sampled.
+  uint64_t count;
+  /// Sum of the bytes requested, estimated if the heap profile is sampled.
+  uint64_t bytes;
+  /// Number of allocations not freed yet.
+  uint64_t live_count;
+  /// Sum of the bytes requested by the allocations not freed yet.
+  uint64_t live_bytes;
+};
+
+/// Start collecting the allocation hot spots, by call stack.
+/**
+ * Enables the heap profile, see enable_heap_profiling(), for the number of
+ * allocations and bytes of each call stack, and keeps the live allocation
+ * table, see enable_live_allocation_tracking(), for what they still hold,
+ * until disable_allocation_report() is called.
+ *
+ * Setting the `MEMORY_TOOLS_REPORT` environment variable to a path enables
+ * it at load time, and writes the report there at exit, or to stderr if the
+ * path is `-`.
+ * A `%p` in the path is replaced by the process id, so that every process
+ * of a test suite gets its own report.
+ * `MEMORY_TOOLS_REPORT_TOP` sets the number of call sites listed in each
+ * ranking, 10 by default.
+ * Since the variables are passed down to the test process, this gives an
+ * allocation profile of any test added with `osrf_testing_tools_cpp_add_test`
+ * without changing its code.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ *
+ * \returns false if the live allocation table is not available, in which
+ *   case the allocations are still counted but the live bytes stay 0,
+ *   otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+enable_allocation_report();
+
+/// Stop collecting the allocation hot spots, what was collected is kept.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_allocation_report();
+
+/// Return true if the allocation hot spots are being collected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+allocation_report_enabled();
+
+/// Return every call stack which allocated or still holds memory, most allocations first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<AllocationHotspot>
+get_allocation_hotspots();
+
+/// Return the call stacks with the most allocations, bytes and live bytes, symbolized.
+/** Memory allocated to build the report is not counted. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_allocation_report(size_t max_call_sites = 10);
+
+/// Write the report given by format_allocation_report() to a file.
+/** \returns false if the file could not be written */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+write_allocation_report(const std::string & path, size_t max_call_sites = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_REPORT_HPP_
@@ -0,0 +1,115 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Number of buckets of an AllocationSizeHistogram, one per power of two of a 64-bit size.
+static constexpr size_t ALLOCATION_SIZE_BUCKET_COUNT = 65;
+
+/// Return the bucket of the given size, 0 for 0 bytes and i for [2^(i-1), 2^i) bytes.
+inline
+size_t
+get_allocation_size_bucket(uint64_t size)
+{
+  size_t bucket = 0;
+  while (0 != size) {
+    ++bucket;
+    size >>= 1;
+  }
+  return bucket;
+}
+
+/// Sizes requested by the allocations from a call stack, bucketed by power of two.
+struct AllocationSizeHistogram
+{
+  /// Program counters of the call stack, innermost first, empty if it is unknown.
+  std::vector<void *> stack;
+  /// Number of allocations in each bucket, see get_allocation_size_bucket().
+  uint64_t buckets[ALLOCATION_SIZE_BUCKET_COUNT];
+  /// Sum of the bytes requested.
+  uint64_t bytes_requested;
+
+  /// Return the number of allocations in all buckets.
+  uint64_t
+  count() const
+  {
+    uint64_t count = 0;
+    for (uint64_t bucket_count : buckets) {
+      count += bucket_count;
+    }
+    return count;
+  }
+};
+
+/// Start bucketing the sizes of the heap allocations by call stack.
+/**
+ * Allocations made with malloc, realloc, calloc, the aligned allocation
+ * functions and operator new are counted, for all threads, until
+ * disable_allocation_size_histograms() is called.
+ * This shows the call sites where a pool, a small buffer optimization or a
+ * reserve() would save most calls to the allocator.
+ *
+ * Setting the `MEMORY_TOOLS_ALLOCATION_SIZE_HISTOGRAMS` environment variable
+ * to `1` enables it at load time, and prints the histograms of the call
+ * sites with the most allocations to stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+enable_allocation_size_histograms();
+
+/// Stop counting allocation sizes, the histograms are kept until reset.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_allocation_size_histograms();
+
+/// Return true if allocation sizes are being counted.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+allocation_size_histograms_enabled();
+
+/// Set every histogram back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_allocation_size_histograms();
+
+/// Return the histogram of every call stack which allocated, most allocations first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<AllocationSizeHistogram>
+get_allocation_size_histograms();
+
+/// Return the histograms of the call stacks with the most allocations, symbolized.
+/** Memory allocated to build the report is not counted. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_allocation_size_histograms(size_t max_call_sites = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_HPP_
@@ -0,0 +1,206 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_STATS_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_STATS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./memory_tools_service.hpp"
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Counters of the memory operations made while a ScopedAllocationStats was alive.
+/**
+ * Bytes requested are what was asked for, e.g. count * size for calloc().
+ * Bytes allocated and freed are the usable sizes of the blocks, as given by
+ * malloc_usable_size() on Linux or malloc_size() on macOS, since the
+ * requested size of freed memory is not known.
+ * Those are 0 where the usable size is not available, e.g. on Windows.
+ * For the memory mapping functions all of them are the size of the mapping.
+ */
+struct AllocationStats
+{
+  /// Number of operations, indexed by MemoryFunctionType.
+  uint64_t operation_count[MEMORY_FUNCTION_TYPE_COUNT];
+  /// Bytes requested by the operations, indexed by MemoryFunctionType.
+  uint64_t operation_bytes[MEMORY_FUNCTION_TYPE_COUNT];
+  /// Number of operations which returned new memory, including realloc().
+  uint64_t allocation_count;
+  /// Number of operations which gave memory back, including realloc().
+  uint64_t deallocation_count;
+  /// Sum of the bytes requested by the operations which returned new memory.
+  uint64_t bytes_requested;
+  /// Sum of the usable sizes of the memory returned.
+  uint64_t bytes_allocated;
+  /// Sum of the usable sizes of the memory given back.
+  uint64_t bytes_freed;
+  /// Bytes allocated minus bytes freed, negative if more was freed than allocated.
+  int64_t live_bytes;
+  /// Highest value live_bytes reached, at least 0.
+  int64_t peak_live_bytes;
+
+  /// Return the number of operations of the given type.
+  uint64_t
+  count(MemoryFunctionType memory_function_type) const
+  {
+    return operation_count[static_cast<size_t>(memory_function_type)];
+  }
+
+  /// Return the bytes requested by operations of the given type.
+  uint64_t
+  bytes(MemoryFunctionType memory_function_type) const
+  {
+    return operation_bytes[static_cast<size_t>(memory_function_type)];
+  }
+};
+
+/// Which memory operations a ScopedAllocationStats counts.
+enum class AllocationStatsScope
+{
+  /// Only those of the thread which created the ScopedAllocationStats.
+  this_thread,
+  /// Those of all threads, with peak_live_bytes taken over all of them together.
+  all_threads,
+};
+
+/// Internal per-thread counters, see ScopedAllocationStats.
+struct ThreadAllocationCounters;
+
+/// Collects AllocationStats for the memory operations made while it is alive.
+/**
+ * Every memory operation updates counters of the calling thread, which are
+ * plain stores to memory owned by the thread, and a ScopedAllocationStats
+ * takes the difference between the counters at construction and when get()
+ * is called.
+ * So it is cheap enough to wrap large benchmark loops.
+ * Only an all_threads scope also updates shared counters, to get the peak of
+ * the live bytes over all threads.
+ *
+ * Memory operations are counted whether or not monitoring is enabled, but
+ * not those made by memory tools itself or by the callbacks.
+ * Instances may be nested, and must be destroyed in the thread which created
+ * them, in the reverse order of their creation, as on the stack.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`, otherwise all
+ * counters stay 0.
+ */
+class ScopedAllocationStats
+{
+public:
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  explicit ScopedAllocationStats(AllocationStatsScope scope = AllocationStatsScope::this_thread);
+
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  ~ScopedAllocationStats();
+
+  ScopedAllocationStats(const ScopedAllocationStats &) = delete;
+  ScopedAllocationStats & operator=(const ScopedAllocationStats &) = delete;
+
+  /// Return the counters for the memory operations made since construction.
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  AllocationStats
+  get() const;
+
+  /// Return the scope given on construction.
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  AllocationStatsScope
+  get_scope() const;
+
+private:
+  AllocationStatsScope scope_;
+  ThreadAllocationCounters * thread_counters_;
+  AllocationStats start_;
+  // live bytes at construction, in the units of the peak counter used by the scope
+  int64_t start_live_bytes_;
+  // peak of an enclosing ScopedAllocationStats, restored on destruction
+  int64_t saved_peak_live_bytes_;
+};
+
+/// Counters of the memory operations made by one thread, see get_thread_allocation_stats().
+struct ThreadAllocationStats
+{
+  /// Memory tools' thread index, see get_current_thread_index().
+  uint32_t thread_index;
+  /// Name registered with set_current_thread_name(), or else the system name, empty if unknown.
+  std::string name;
+  /// Operations counted since the thread was first seen, peak_live_bytes being its highest.
+  /**
+   * Live bytes are those allocated by the thread minus those it freed, so a
+   * thread which frees memory allocated by another may have negative ones.
+   */
+  AllocationStats stats;
+};
+
+/// Start counting the memory operations of every thread, until disabled.
+/**
+ * This keeps the counters used by ScopedAllocationStats updated without a
+ * scope alive, so the totals of each thread can be read with
+ * get_thread_allocation_stats() at any time, also after the thread exited.
+ * Operations made while neither this nor a ScopedAllocationStats was
+ * enabled are not counted.
+ *
+ * Threads are named by set_current_thread_name() if it was called, and
+ * otherwise by pthread_getname_np(), which is read when the thread first
+ * allocates and again every 4096 allocations, so a name set by the thread
+ * itself shows up once it allocates after setting it.
+ *
+ * Setting the `MEMORY_TOOLS_THREAD_STATS` environment variable to `1`
+ * enables it at load time, and prints the threads which allocated the most
+ * to stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+enable_thread_allocation_accounting();
+
+/// Stop counting the memory operations when no ScopedAllocationStats is alive.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_thread_allocation_accounting();
+
+/// Return true if the memory operations of every thread are being counted.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+thread_allocation_accounting_enabled();
+
+/// Name the calling thread in get_thread_allocation_stats(), instead of its system name.
+/** The name is copied, and kept after the thread exits. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+set_current_thread_name(const char * name);
+
+/// Return the counters of every thread which was counted, most allocations first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<ThreadAllocationStats>
+get_thread_allocation_stats();
+
+/// Return a table of the threads with the most allocations.
+/** Memory allocated to build the report is not counted. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_thread_allocation_stats(size_t max_threads = 20);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATION_STATS_HPP_
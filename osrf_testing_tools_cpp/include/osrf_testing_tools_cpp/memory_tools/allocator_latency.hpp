@@ -0,0 +1,224 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATOR_LATENCY_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATOR_LATENCY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "./memory_tools_service.hpp"
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Number of size classes of AllocatorLatencyHistogram, see get_allocator_latency_size_class().
+static constexpr size_t ALLOCATOR_LATENCY_SIZE_CLASS_COUNT = 4;
+
+/// Return the size class of an operation on the given number of bytes.
+/**
+ * The classes are up to 256 bytes, up to 4 KiB, up to 128 KiB and above,
+ * the last one being the sizes glibc serves with mmap() by default.
+ */
+inline
+size_t
+get_allocator_latency_size_class(uint64_t size)
+{
+  if (size <= 256) {
+    return 0;
+  }
+  if (size <= 4096) {
+    return 1;
+  }
+  return (size <= 128 * 1024) ? 2 : 3;
+}
+
+/// Number of buckets of an AllocatorLatencyHistogram, see get_allocator_latency_bucket().
+static constexpr size_t ALLOCATOR_LATENCY_BUCKET_COUNT = 128;
+
+/// Return the bucket of the given latency.
+/**
+ * Latencies under 4 ns have a bucket each, then every power of two is split
+ * in 4 buckets, so a bucket is at most 25% wide, up to about 7.5 s where the
+ * last bucket holds everything above.
+ */
+inline
+size_t
+get_allocator_latency_bucket(uint64_t latency_ns)
+{
+  if (latency_ns < 4) {
+    return static_cast<size_t>(latency_ns);
+  }
+  size_t exponent = 2;
+  while ((latency_ns >> exponent) > 1) {
+    ++exponent;
+  }
+  if (exponent > 32) {
+    return ALLOCATOR_LATENCY_BUCKET_COUNT - 1;
+  }
+  return 4 * (exponent - 1) + ((latency_ns >> (exponent - 2)) & 3);
+}
+
+/// Return the largest latency which falls in the given bucket.
+inline
+uint64_t
+get_allocator_latency_bucket_limit(size_t bucket)
+{
+  if (bucket < 4) {
+    return bucket;
+  }
+  if (bucket >= ALLOCATOR_LATENCY_BUCKET_COUNT - 1) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  const size_t exponent = bucket / 4 + 1;
+  const uint64_t lower = static_cast<uint64_t>(4 + bucket % 4) << (exponent - 2);
+  return lower + (static_cast<uint64_t>(1) << (exponent - 2)) - 1;
+}
+
+/// Time spent in the original allocator by one operation for one size class.
+/**
+ * Threads are identified by memory tools' thread index, see
+ * get_current_thread_index(), and the index is 0 for the histograms merged
+ * over all threads.
+ */
+struct AllocatorLatencyHistogram
+{
+  uint32_t thread_index;
+  MemoryFunctionType memory_function_type;
+  /// See get_allocator_latency_size_class().
+  size_t size_class;
+  /// Number of operations in each bucket, see get_allocator_latency_bucket().
+  uint64_t buckets[ALLOCATOR_LATENCY_BUCKET_COUNT];
+  /// Sum of the latencies.
+  uint64_t total_ns;
+  /// Largest latency, exact unlike the percentiles.
+  uint64_t max_ns;
+
+  /// Return the number of operations in all buckets.
+  uint64_t
+  count() const
+  {
+    uint64_t count = 0;
+    for (uint64_t bucket_count : buckets) {
+      count += bucket_count;
+    }
+    return count;
+  }
+
+  /// Return the latency under which the given percentage of the operations fell, 0 if empty.
+  /**
+   * This is the limit of the bucket holding that operation, so it may be up
+   * to 25% too high, but it is never more than max_ns.
+   */
+  uint64_t
+  get_percentile_ns(double percentile) const
+  {
+    const uint64_t total_count = count();
+    if (0 == total_count) {
+      return 0;
+    }
+    // the rank of the operation, starting at 1, which the percentile falls on
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_count));
+    rank = (rank < 1) ? 1 : ((rank > total_count) ? total_count : rank);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < ALLOCATOR_LATENCY_BUCKET_COUNT; ++bucket) {
+      seen += buckets[bucket];
+      if (seen >= rank) {
+        const uint64_t limit = get_allocator_latency_bucket_limit(bucket);
+        return (limit < max_ns) ? limit : max_ns;
+      }
+    }
+    return max_ns;
+  }
+
+  /// Return the number of operations in the buckets from the one of the given latency up.
+  uint64_t
+  count_at_least(uint64_t latency_ns) const
+  {
+    uint64_t count = 0;
+    for (
+      size_t bucket = get_allocator_latency_bucket(latency_ns);
+      bucket < ALLOCATOR_LATENCY_BUCKET_COUNT;
+      ++bucket)
+    {
+      count += buckets[bucket];
+    }
+    return count;
+  }
+};
+
+/// Start timing every call to the original memory functions, per thread.
+/**
+ * The time spent in the original malloc, realloc, calloc, free, aligned
+ * allocation functions, operator new and delete, and in the tracked mapping
+ * functions, see `MEMORY_TOOLS_TRACK_MMAP`, is measured with the monotonic
+ * clock and counted in a histogram per thread, operation and size class,
+ * until disable_allocator_latency_histograms() is called.
+ * Frees are classed by the usable size of the block.
+ *
+ * This tells how often the allocator itself stalls, e.g. when it trims an
+ * arena, maps memory or takes page faults, apart from the cost of the
+ * calling code.
+ * Each measured operation pays for two reads of the clock.
+ *
+ * Setting the `MEMORY_TOOLS_ALLOCATOR_LATENCY` environment variable to `1`
+ * enables it at load time, and prints the percentiles to stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+enable_allocator_latency_histograms();
+
+/// Stop timing the allocator, the histograms are kept until reset.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_allocator_latency_histograms();
+
+/// Return true if the allocator is being timed.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+allocator_latency_histograms_enabled();
+
+/// Set every histogram of every thread back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_allocator_latency_histograms();
+
+/// Return the non-empty histograms of every thread, by thread, operation and size class.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<AllocatorLatencyHistogram>
+get_allocator_latency_histograms();
+
+/// Return the non-empty histograms merged over all threads, by operation and size class.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<AllocatorLatencyHistogram>
+get_merged_allocator_latency_histograms();
+
+/// Return the percentiles by operation and size class, and the threads with the slowest calls.
+/** Memory allocated to build the report is not counted. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_allocator_latency_histograms(size_t max_threads = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__ALLOCATOR_LATENCY_HPP_
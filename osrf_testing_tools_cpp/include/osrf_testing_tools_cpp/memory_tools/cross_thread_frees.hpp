@@ -0,0 +1,124 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__CROSS_THREAD_FREES_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__CROSS_THREAD_FREES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Frees of memory allocated by another thread, for a pair of call stacks and a pair of threads.
+/**
+ * Threads are identified by memory tools' thread index, a number given to
+ * each thread in the order they first use memory tools, starting at 1, see
+ * get_current_thread_index().
+ */
+struct CrossThreadFrees
+{
+  /// Program counters of the call stack which allocated, innermost first, empty if unknown.
+  std::vector<void *> allocation_stack;
+  /// Program counters of the call stack which freed, innermost first, empty if unknown.
+  std::vector<void *> free_stack;
+  uint32_t allocating_thread;
+  uint32_t freeing_thread;
+  /// Number of frees.
+  uint64_t count;
+  /// Sum of the bytes requested by the freed allocations.
+  uint64_t bytes;
+};
+
+/// Number of the known frees, and how many of them were made by another thread.
+struct CrossThreadFreeTotals
+{
+  /// Frees of memory allocated while the analysis was enabled.
+  uint64_t free_count;
+  uint64_t cross_thread_free_count;
+  uint64_t cross_thread_bytes;
+  /// Cross-thread frees which did not fit in the table of call stack and thread pairs.
+  uint64_t dropped_count;
+};
+
+/// Start counting the frees of heap memory made by another thread than the one which allocated it.
+/**
+ * Keeps the live allocation table, see enable_live_allocation_tracking(),
+ * which records the allocating thread of each block, until
+ * disable_cross_thread_free_analysis() is called.
+ * Memory allocated before is not known, so its frees are not counted.
+ * A realloc() which moves a block counts as a free of the old block.
+ *
+ * Such frees defeat the per-thread caches of the allocators, the memory goes
+ * back to the cache or arena of the freeing thread, or takes a lock to be
+ * given back to the allocating one.
+ *
+ * Setting the `MEMORY_TOOLS_CROSS_THREAD_FREES` environment variable to `1`
+ * enables it at load time, and prints the pairs with the most frees to
+ * stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ *
+ * \returns false if the live allocation table is not available, otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+enable_cross_thread_free_analysis();
+
+/// Stop counting cross-thread frees, the counters are kept until reset.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_cross_thread_free_analysis();
+
+/// Return true if cross-thread frees are being counted.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+cross_thread_free_analysis_enabled();
+
+/// Set every counter back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_cross_thread_frees();
+
+/// Return the memory tools thread index of the calling thread.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+uint32_t
+get_current_thread_index();
+
+/// Return the number of frees, and of cross-thread frees, counted so far.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+CrossThreadFreeTotals
+get_cross_thread_free_totals();
+
+/// Return the cross-thread frees by call stack and thread pair, most frees first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<CrossThreadFrees>
+get_cross_thread_frees();
+
+/// Return the totals and the pairs with the most cross-thread frees, symbolized.
+/** Memory allocated to build the report is not counted. */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_cross_thread_frees(size_t max_pairs = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__CROSS_THREAD_FREES_HPP_
@@ -0,0 +1,74 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__EVENT_LOG_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__EVENT_LOG_HPP_
+
+#include <cstdint>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// What to do when a thread's event log buffer is full.
+enum class EventLogOverflowPolicy
+{
+  /// Discard the new event and count it, see get_dropped_event_count().
+  drop,
+  /// Wait for the buffer to be drained, draining it in the calling thread if needed.
+  block,
+};
+
+/// Return the current event log overflow policy.
+/**
+ * The initial value comes from the `MEMORY_TOOLS_EVENT_LOG_POLICY`
+ * environment variable, which may be `drop` (the default) or `block`.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+EventLogOverflowPolicy
+get_event_log_overflow_policy();
+
+/// Set the event log overflow policy, returning the previous one.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+EventLogOverflowPolicy
+set_event_log_overflow_policy(EventLogOverflowPolicy policy);
+
+/// Write out, to stdout, all memory events logged so far by any thread.
+/**
+ * Memory events which are not ignored (see MemoryToolsService::ignore())
+ * are recorded into per-thread lock-free buffers by the memory functions,
+ * rather than being printed synchronously.
+ * The buffers are drained by a background thread started in `initialize()`,
+ * unless `MEMORY_TOOLS_EVENT_LOG_DRAIN=exit` is set, and are always flushed
+ * on `uninitialize()` and at exit.
+ *
+ * Call this to make sure everything logged so far has been written, e.g.
+ * before inspecting the output.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+flush_event_log();
+
+/// Return the number of memory events dropped because a buffer was full.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+uint64_t
+get_dropped_event_count();
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__EVENT_LOG_HPP_
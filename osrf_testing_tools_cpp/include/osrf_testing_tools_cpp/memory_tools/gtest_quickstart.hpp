@@ -21,6 +21,8 @@
 
 #include <gtest/gtest.h>
 
+#include "./allocation_budget.hpp"
+#include "./live_allocations.hpp"
 #include "./memory_tools.hpp"
 #include "./testing_helpers.hpp"
 
@@ -249,6 +251,73 @@ private:
   bool is_working_;
 };
 
+/// Return success if the allocations of the given ScopedAllocationBudget are within budget.
+/**
+ * Otherwise the failure message says which limits were exceeded and where
+ * the allocations came from, e.g.:
+ *
+ *   ScopedAllocationBudget budget(AllocationBudget().with_max_allocations(1));
+ *   publish(message);
+ *   EXPECT_TRUE(allocation_budget_respected(budget));
+ */
+inline
+::testing::AssertionResult
+allocation_budget_respected(const ScopedAllocationBudget & scoped_allocation_budget)
+{
+  std::string report;
+  if (scoped_allocation_budget.check(&report)) {
+    return ::testing::AssertionSuccess();
+  }
+  return ::testing::AssertionFailure() << report;
+}
+
+/// Fail the test, non-fatally, if the given statements exceed the given AllocationBudget.
+#define EXPECT_ALLOCATION_BUDGET(budget, statements) \
+  do { \
+    osrf_testing_tools_cpp::memory_tools::ScopedAllocationBudget scoped_budget(budget); \
+    statements; \
+    EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::allocation_budget_respected(scoped_budget)); \
+  } while (false)
+
+/// Fail the test, non-fatally, if the given statements allocate more than max times.
+#define EXPECT_MAX_ALLOCATIONS(max, statements) \
+  EXPECT_ALLOCATION_BUDGET( \
+    osrf_testing_tools_cpp::memory_tools::AllocationBudget().with_max_allocations(max), \
+    statements)
+
+/// Fail the test, non-fatally, if the given statements request more than max_bytes in total.
+#define EXPECT_MAX_BYTES(max_bytes, statements) \
+  EXPECT_ALLOCATION_BUDGET( \
+    osrf_testing_tools_cpp::memory_tools::AllocationBudget().with_max_bytes(max_bytes), \
+    statements)
+
+/// Return success if nothing allocated in the scope of the given ScopedLeakCheck is still live.
+/** Otherwise the failure message lists the leaked allocations grouped by stack. */
+inline
+::testing::AssertionResult
+no_leaks(const ScopedLeakCheck & scoped_leak_check)
+{
+  std::string report;
+  if (scoped_leak_check.check(&report)) {
+    return ::testing::AssertionSuccess();
+  }
+  return ::testing::AssertionFailure() << report;
+}
+
+/// Fail the test, non-fatally, if the given statements leave heap allocations behind.
+#define EXPECT_NO_LEAKS(statements) \
+  do { \
+    osrf_testing_tools_cpp::memory_tools::ScopedLeakCheck scoped_leak_check; \
+    statements; \
+    EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::no_leaks(scoped_leak_check)); \
+  } while (false)
+
+/// Fail the test, non-fatally, if the live bytes of the given statements peak above max_bytes.
+#define EXPECT_MAX_PEAK_LIVE_BYTES(max_bytes, statements) \
+  EXPECT_ALLOCATION_BUDGET( \
+    osrf_testing_tools_cpp::memory_tools::AllocationBudget().with_max_peak_live_bytes(max_bytes), \
+    statements)
+
 }  // namespace memory_tools
 }  // namespace osrf_testing_tools_cpp
 
@@ -0,0 +1,111 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__HEAP_PROFILE_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__HEAP_PROFILE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// File formats a heap profile can be written in.
+enum class HeapProfileFormat
+{
+  /// The protobuf encoded profile.proto of pprof, uncompressed, e.g. for `pprof -http`.
+  pprof,
+  /// One line per unique stack, outermost frame first, separated by `;` and
+  /// followed by the bytes allocated, e.g. for `flamegraph.pl`.
+  collapsed,
+};
+
+/// Start counting the heap allocations and bytes requested per unique call stack.
+/**
+ * Allocations made with malloc, realloc, calloc, the aligned allocation
+ * functions and operator new are counted, for all threads, until
+ * disable_heap_profiling() is called.
+ * The counters are kept per interned stack, so the cost per allocation is
+ * capturing its stack and two atomic additions, or only a thread local
+ * counter decrement for the allocations which are not sampled, see
+ * set_heap_profile_sample_rate().
+ *
+ * Setting the `MEMORY_TOOLS_HEAP_PROFILE` environment variable to a path
+ * prefix enables it at load time, and writes the profile to `<prefix>.pb`
+ * and `<prefix>.collapsed` at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+enable_heap_profiling();
+
+/// Stop counting heap allocations, the counters are kept until reset_heap_profile().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_heap_profiling();
+
+/// Return true if heap allocations are being counted.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+heap_profiling_enabled();
+
+/// Set the counters of every call stack back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_heap_profile();
+
+/// Sample one allocation every given number of bytes allocated on average, 0 to count all.
+/**
+ * Like tcmalloc, the distance in bytes between two samples is drawn from an
+ * exponential distribution, so every byte has the same chance of being
+ * sampled and an allocation of size bytes is sampled with a probability of
+ * 1 - exp(-size / rate).
+ * Each sample is scaled back up by the inverse of that probability when it
+ * is recorded, like pprof does, so that the totals are unbiased even for a
+ * call stack which allocates very different sizes.
+ * Changing the rate only changes how the later allocations are sampled.
+ * The initial value comes from the `MEMORY_TOOLS_HEAP_PROFILE_SAMPLE_RATE`
+ * environment variable, 0 by default.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+set_heap_profile_sample_rate(uint64_t bytes);
+
+/// Return the average number of bytes allocated between two sampled allocations, 0 for none.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+uint64_t
+get_heap_profile_sample_rate();
+
+/// Write the counters of every call stack which allocated, symbolized, to the given file.
+/**
+ * The pprof profile has the sample types `alloc_objects` and `alloc_space`,
+ * the collapsed stacks only the bytes, both estimated from the samples if
+ * sampling, see set_heap_profile_sample_rate().
+ * Memory allocated to write the profile is not counted.
+ *
+ * \returns false if the file could not be written, otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+write_heap_profile(const std::string & path, HeapProfileFormat format);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__HEAP_PROFILE_HPP_
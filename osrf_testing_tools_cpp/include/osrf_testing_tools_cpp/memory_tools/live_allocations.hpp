@@ -0,0 +1,111 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__LIVE_ALLOCATIONS_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__LIVE_ALLOCATIONS_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Keep a table of the live heap allocations, with the size, stack and thread of each.
+/**
+ * The table is filled from malloc, realloc, calloc, the aligned allocation
+ * functions, operator new and their frees, and is only kept while tracking
+ * is enabled, either by this function for the rest of the process or by an
+ * alive ScopedLeakCheck.
+ * Memory allocated while it was not kept is unknown to it.
+ *
+ * Once enabled with this function, uninitialize() prints the allocations
+ * made since initialize() which are still live to stderr, grouped by stack.
+ * Setting the `MEMORY_TOOLS_LIVE_ALLOCATIONS` environment variable to `1`
+ * enables it at load time, and additionally prints everything still live at
+ * exit.
+ *
+ * The table has a fixed capacity, `MEMORY_TOOLS_LIVE_ALLOCATIONS_CAPACITY`
+ * entries (default 1048576), allocations which do not fit are not tracked.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ *
+ * \returns false if the table is not supported on this platform or could not
+ *   be allocated, otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+enable_live_allocation_tracking();
+
+/// Return true if the live allocation table is being kept.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+live_allocation_tracking_enabled();
+
+/// Number and requested bytes of a group of live allocations.
+struct LiveAllocationTotals
+{
+  uint64_t count;
+  uint64_t bytes;
+};
+
+/// Checks that the heap allocations this thread makes while it is alive are all freed.
+/**
+ * Keeps the live allocation table while alive, see enable_live_allocation_tracking().
+ * Memory allocated in the scope by other threads, or allocated before and
+ * freed in the scope, does not count.
+ *
+ * The googletest macro EXPECT_NO_LEAKS() in gtest_quickstart.hpp wraps a
+ * block of statements with one.
+ */
+class ScopedLeakCheck
+{
+public:
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  ScopedLeakCheck();
+
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  ~ScopedLeakCheck();
+
+  ScopedLeakCheck(const ScopedLeakCheck &) = delete;
+  ScopedLeakCheck & operator=(const ScopedLeakCheck &) = delete;
+
+  /// Return true if nothing this thread allocated since construction is still live.
+  /**
+   * If not and report is not nullptr, it is set to the live allocations
+   * grouped by stack, most bytes first.
+   * Also true if the table is not available, see enable_live_allocation_tracking().
+   */
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  bool
+  check(std::string * report = nullptr) const;
+
+  /// Return the allocations this thread made since construction which are still live.
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  LiveAllocationTotals
+  get_leaks() const;
+
+private:
+  bool table_available_;
+  uint32_t thread_index_;
+  uint64_t start_epoch_;
+};
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__LIVE_ALLOCATIONS_HPP_
@@ -19,11 +19,23 @@
 #ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__MEMORY_TOOLS_HPP_
 #define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__MEMORY_TOOLS_HPP_
 
+#include "./allocation_budget.hpp"
+#include "./allocation_lifetimes.hpp"
+#include "./allocation_report.hpp"
+#include "./allocation_size_histograms.hpp"
+#include "./allocation_stats.hpp"
+#include "./allocator_latency.hpp"
+#include "./cross_thread_frees.hpp"
+#include "./event_log.hpp"
+#include "./heap_profile.hpp"
 #include "./initialize.hpp"
 #include "./is_working.hpp"
+#include "./live_allocations.hpp"
 #include "./memory_tools_service.hpp"
 #include "./monitoring.hpp"
+#include "./realloc_chains.hpp"
 #include "./register_hooks.hpp"
+#include "./symbol_cache.hpp"
 #include "./testing_helpers.hpp"
 #include "./visibility_control.hpp"
 
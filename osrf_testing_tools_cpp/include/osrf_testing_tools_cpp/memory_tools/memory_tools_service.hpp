@@ -15,6 +15,9 @@
 #ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__MEMORY_TOOLS_SERVICE_HPP_
 #define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__MEMORY_TOOLS_SERVICE_HPP_
 
+#include <cstddef>
+#include <cstdint>
+
 #include "./stack_trace.hpp"
 #include "./visibility_control.hpp"
 
@@ -34,8 +37,26 @@ enum class MemoryFunctionType
   Realloc,
   Calloc,
   Free,
+  /// posix_memalign(), aligned_alloc(), memalign(), valloc() and pvalloc().
+  AlignedAlloc,
+  /// Every global operator new and operator new[], including nothrow and aligned ones.
+  OperatorNew,
+  /// Every global operator delete and operator delete[], including sized and aligned ones.
+  OperatorDelete,
+  /// mmap() and mmap64(), only if `MEMORY_TOOLS_TRACK_MMAP` is set, see on_mmap().
+  Mmap,
+  /// mremap(), only if `MEMORY_TOOLS_TRACK_MMAP` is set.
+  Mremap,
+  /// munmap(), only if `MEMORY_TOOLS_TRACK_MMAP` is set.
+  Munmap,
+  /// brk() and sbrk(), only if `MEMORY_TOOLS_TRACK_MMAP` is set.
+  Brk,
 };
 
+/// Number of MemoryFunctionType values, for arrays indexed by them.
+static constexpr size_t MEMORY_FUNCTION_TYPE_COUNT =
+  static_cast<size_t>(MemoryFunctionType::Brk) + 1;
+
 /// Service injected in to user callbacks which allow them to control behavior.
 /**
  * This is a Service (in the terminology of the dependency injection pattern)
@@ -95,6 +116,12 @@ struct MemoryToolsService
 
   /// Returns a stack trace object for introspection.
   /**
+   * The frames of memory tools itself are left out, so the first frame is
+   * where the memory function was called.
+   * The stack is captured with the unwinder selected by the
+   * `MEMORY_TOOLS_UNWINDER` environment variable, `backward` (default) or
+   * `frame_pointer`, up to `MEMORY_TOOLS_STACK_DEPTH` frames (default 64).
+   *
    * Pointer should not be used after MemoryToolsService is out of scope.
    * Will return nullptr if a stack trace is not available, e.g. on Windows.
    */
@@ -102,17 +129,52 @@ struct MemoryToolsService
   StackTrace *
   get_stack_trace();
 
+  /// Return a compact id for the call stack of this memory operation.
+  /**
+   * The stack is captured as raw program counters and interned in a
+   * process-wide table, nothing is symbolized, so this is much cheaper than
+   * get_stack_trace().
+   * The same call stack always gets the same id, which makes it suitable as a
+   * key for per call site accounting.
+   * Will return 0 if a stack id is not available, e.g. on Windows.
+   */
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  uint32_t
+  get_stack_id();
+
+  /// Return the requested size in bytes, if known, otherwise 0.
+  /**
+   * This is count * size for calloc(), and for operator delete it is only
+   * known for the sized overloads.
+   */
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  size_t
+  get_size() const;
+
+  /// Return the alignment requested by an aligned allocation, otherwise 0.
+  /**
+   * For valloc() and pvalloc() this is the page size, and for operator new and
+   * operator delete it is only set for the std::align_val_t overloads.
+   * Use get_source_function_name() to tell the aligned functions apart.
+   */
+  OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+  size_t
+  get_alignment() const;
+
   /// Return the address of the source memory function.
   OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
   const char *
   get_source_function_name() const;
 
 protected:
-  explicit MemoryToolsService(
-    MemoryFunctionType memory_function_type,
-    const char * source_function_name);
+  /// Constructor, the implementation is owned by the caller and must outlive this service.
+  /**
+   * This lets the factory keep both on the stack, so that creating a service
+   * for each memory operation does not itself allocate.
+   */
+  explicit MemoryToolsService(MemoryToolsServiceImpl & impl);
 
-  std::shared_ptr<MemoryToolsServiceImpl> impl_;
+  MemoryToolsServiceImpl * impl_;
 
   friend MemoryToolsServiceFactory;
 };
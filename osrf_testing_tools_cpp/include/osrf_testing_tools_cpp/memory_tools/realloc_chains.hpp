@@ -0,0 +1,141 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__REALLOC_CHAINS_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__REALLOC_CHAINS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Call sites whose chains are shorter than this on average are not flagged.
+static constexpr uint64_t REALLOC_CHAIN_MIN_AVERAGE_LENGTH = 3;
+
+/// The reallocs of the blocks allocated by a call stack, a chain being the reallocs of a block.
+/**
+ * A chain starts with the allocation of a block, by malloc() or realloc(nullptr, size)
+ * for instance, and each realloc() of the block, moved or not, adds one to it.
+ */
+struct ReallocChains
+{
+  /// Program counters of the call stack which allocated the blocks, innermost first.
+  /** That is where a reserve(), or a bigger first allocation, would go. */
+  std::vector<void *> stack;
+  /// Number of blocks reallocated at least once.
+  uint64_t chain_count;
+  /// Number of reallocs of those blocks.
+  uint64_t realloc_count;
+  /// Number of reallocs which made the block bigger.
+  uint64_t growth_count;
+  /// Number of reallocs which made the block at least 25% bigger.
+  uint64_t geometric_growth_count;
+  /// Bytes the reallocs which moved the block had to copy, i.e. the smaller of both sizes.
+  uint64_t bytes_copied;
+  /// Most reallocs of a single block.
+  uint64_t max_chain_length;
+  /// Biggest size requested by a realloc.
+  uint64_t max_size;
+
+  /// Return the average number of reallocs per block.
+  double
+  average_chain_length() const
+  {
+    return (0 == chain_count) ? 0.0 :
+           static_cast<double>(realloc_count) / static_cast<double>(chain_count);
+  }
+
+  /// Return true if the blocks grow through many reallocs, i.e. a reserve() is missing.
+  /**
+   * That is at least REALLOC_CHAIN_MIN_AVERAGE_LENGTH reallocs per block on
+   * average, and at least 90% of them made the block bigger.
+   */
+  bool
+  is_missing_reserve() const
+  {
+    return
+      realloc_count >= REALLOC_CHAIN_MIN_AVERAGE_LENGTH * chain_count &&
+      0 != chain_count &&
+      growth_count * 10 >= realloc_count * 9;
+  }
+
+  /// Return true if at least 90% of the reallocs made the block at least 25% bigger.
+  bool
+  grows_geometrically() const
+  {
+    return 0 != realloc_count && geometric_growth_count * 10 >= realloc_count * 9;
+  }
+};
+
+/// Start following the reallocs of each heap block back to the allocation which created it.
+/**
+ * Keeps the live allocation table, see enable_live_allocation_tracking(),
+ * with the number of reallocs that led to each block, and counts every
+ * realloc of a block for the call stack which first allocated it, until
+ * disable_realloc_chain_analysis() is called.
+ * Blocks allocated before are not known, so their reallocs are not counted.
+ *
+ * Setting the `MEMORY_TOOLS_REALLOC_CHAINS` environment variable to `1`
+ * enables it at load time, and prints the call sites which copied the most
+ * bytes to stderr at exit.
+ *
+ * Requires the interposition library, e.g. with `LD_PRELOAD`.
+ *
+ * \returns false if the live allocation table is not available, otherwise true
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+enable_realloc_chain_analysis();
+
+/// Stop following realloc chains, the counters are kept until reset.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+disable_realloc_chain_analysis();
+
+/// Return true if realloc chains are being followed.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+realloc_chain_analysis_enabled();
+
+/// Set the counters of every call stack back to zero.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+reset_realloc_chains();
+
+/// Return the realloc chains of every call stack whose blocks were reallocated, most copies first.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::vector<ReallocChains>
+get_realloc_chains();
+
+/// Return the realloc chains of the call stacks which copied the most bytes, symbolized.
+/**
+ * Call sites missing a reserve() come with the size to reserve, the biggest
+ * size their blocks reached.
+ * Memory allocated to build the report is not counted.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+std::string
+format_realloc_chains(size_t max_call_sites = 10);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__REALLOC_CHAINS_HPP_
@@ -120,6 +120,167 @@ OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
 void
 dispatch_free(MemoryToolsService & service);
 
+/// Register a hook to be called on the aligned allocation functions.
+/**
+ * Called for posix_memalign(), aligned_alloc(), memalign(), valloc() and
+ * pvalloc(), the requested alignment is given by
+ * MemoryToolsService::get_alignment().
+ *
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_aligned_alloc(AnyMemoryToolsCallback callback);
+
+/// Get the current on_aligned_alloc callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_aligned_alloc();
+
+/// Call the registered callback for the aligned allocation functions.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_aligned_alloc(MemoryToolsService & service);
+
+/// Register a hook to be called on the global operator new and operator new[].
+/**
+ * Called for every overload, including the nothrow and the aligned ones,
+ * MemoryToolsService::get_size() and get_alignment() give what was requested.
+ *
+ * While no hook is registered, the on_malloc() hook is called instead, so
+ * that C++ allocations are still seen by code which only knows about malloc.
+ *
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_operator_new(AnyMemoryToolsCallback callback);
+
+/// Get the current on_operator_new callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_operator_new();
+
+/// Call the registered callback for operator new, or the one for malloc if there is none.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_operator_new(MemoryToolsService & service);
+
+/// Register a hook to be called on the global operator delete and operator delete[].
+/**
+ * Called for every overload, including the sized and the aligned ones.
+ * The size given to sized delete is passed along as is, it is never looked up.
+ *
+ * While no hook is registered, the on_free() hook is called instead.
+ *
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_operator_delete(AnyMemoryToolsCallback callback);
+
+/// Get the current on_operator_delete callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_operator_delete();
+
+/// Call the registered callback for operator delete, or the one for free if there is none.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_operator_delete(MemoryToolsService & service);
+
+/// Register a hook to be called on mmap() and mmap64().
+/**
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * The memory mapping functions are only intercepted on Linux, and only if the
+ * `MEMORY_TOOLS_TRACK_MMAP` environment variable is set to something other
+ * than `0`, otherwise they go straight to the originals.
+ * Note that mappings made by the C library itself, e.g. by malloc() for large
+ * blocks or for thread stacks, do not go through the intercepted functions.
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_mmap(AnyMemoryToolsCallback callback);
+
+/// Get the current on_mmap callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_mmap();
+
+/// Call the registered callback for mmap.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_mmap(MemoryToolsService & service);
+
+/// Register a hook to be called on mremap().
+/**
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_mremap(AnyMemoryToolsCallback callback);
+
+/// Get the current on_mremap callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_mremap();
+
+/// Call the registered callback for mremap.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_mremap(MemoryToolsService & service);
+
+/// Register a hook to be called on munmap().
+/**
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_munmap(AnyMemoryToolsCallback callback);
+
+/// Get the current on_munmap callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_munmap();
+
+/// Call the registered callback for munmap.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_munmap(MemoryToolsService & service);
+
+/// Register a hook to be called on brk() and sbrk().
+/**
+ * Replaces any existing hook, pass nullptr to "unregister".
+ *
+ * \throws std::bad_alloc if allocating storage for the callback fails
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_brk(AnyMemoryToolsCallback callback);
+
+/// Get the current on_brk callback if set, otherwise null.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+AnyMemoryToolsCallback
+get_on_brk();
+
+/// Call the registered callback for brk.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+dispatch_brk(MemoryToolsService & service);
+
 }  // namespace memory_tools
 }  // namespace osrf_testing_tools_cpp
 
@@ -59,6 +59,11 @@ struct SourceLocation
 
 struct TraceImpl;
 
+/// A frame of a StackTrace.
+/**
+ * Only the address is captured with the stack trace, the frame is symbolized
+ * when any of its other properties is first read.
+ */
 struct Trace
 {
   OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
@@ -0,0 +1,66 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__SYMBOL_CACHE_HPP_
+#define OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__SYMBOL_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./visibility_control.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Counters of the process-wide cache of symbolized stack frames.
+/**
+ * Every frame of a StackTrace, a printed backtrace or an interned stack is
+ * symbolized through this cache, so each address is only symbolized once
+ * while it stays in the cache.
+ */
+struct SymbolCacheStatistics
+{
+  /// Frames found in the cache.
+  uint64_t hits;
+  /// Frames which had to be symbolized.
+  uint64_t misses;
+  /// Frames removed, least recently used first, to stay within the capacity.
+  uint64_t evictions;
+  /// Number of frames currently in the cache.
+  size_t size;
+  /// Maximum number of frames in the cache.
+  size_t capacity;
+};
+
+/// Return the current symbol cache counters.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+SymbolCacheStatistics
+get_symbol_cache_statistics();
+
+/// Set the maximum number of frames kept in the symbol cache, evicting as needed.
+/**
+ * The initial capacity comes from the `MEMORY_TOOLS_SYMBOL_CACHE_SIZE`
+ * environment variable, and is 16384 frames by default.
+ * A capacity of 0 disables caching.
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+set_symbol_cache_capacity(size_t capacity);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // OSRF_TESTING_TOOLS_CPP__MEMORY_TOOLS__SYMBOL_CACHE_HPP_
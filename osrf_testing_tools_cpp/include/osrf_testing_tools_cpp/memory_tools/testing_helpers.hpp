@@ -151,19 +151,257 @@ OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
 void
 expect_no_free_end();
 
+/// Register callback to be called when an aligned allocation is unexpected.
+/**
+ * Uses and is overridden by on_aligned_alloc().
+ *
+ * \sa expect_no_aligned_alloc_begin()
+ * \sa expect_no_aligned_alloc_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_aligned_alloc(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call an aligned allocation function.
+#define EXPECT_NO_ALIGNED_ALLOC(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_aligned_alloc_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_aligned_alloc_end()
+
+/// Return true if aligned allocations are expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+aligned_alloc_expected();
+
+/// Toggle calling of callback on from within the aligned allocation functions.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_aligned_alloc_begin();
+
+/// Toggle calling of callback off from within the aligned allocation functions.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_aligned_alloc_end();
+
+/// Register callback to be called when operator new is unexpected.
+/**
+ * Uses and is overridden by on_operator_new().
+ *
+ * \sa expect_no_operator_new_begin()
+ * \sa expect_no_operator_new_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_operator_new(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call operator new.
+#define EXPECT_NO_OPERATOR_NEW(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_new_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_new_end()
+
+/// Return true if operator new is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+operator_new_expected();
+
+/// Toggle calling of callback on from within operator new.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_operator_new_begin();
+
+/// Toggle calling of callback off from within operator new.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_operator_new_end();
+
+/// Register callback to be called when operator delete is unexpected.
+/**
+ * Uses and is overridden by on_operator_delete().
+ *
+ * \sa expect_no_operator_delete_begin()
+ * \sa expect_no_operator_delete_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_operator_delete(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call operator delete.
+#define EXPECT_NO_OPERATOR_DELETE(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_delete_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_delete_end()
+
+/// Return true if operator delete is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+operator_delete_expected();
+
+/// Toggle calling of callback on from within operator delete.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_operator_delete_begin();
+
+/// Toggle calling of callback off from within operator delete.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_operator_delete_end();
+
+/// Register callback to be called when mmap() and mmap64() is unexpected.
+/**
+ * Uses and is overridden by on_mmap().
+ *
+ * \sa expect_no_mmap_begin()
+ * \sa expect_no_mmap_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_mmap(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call mmap() and mmap64().
+#define EXPECT_NO_MMAP(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mmap_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mmap_end()
+
+/// Return true if mmap is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+mmap_expected();
+
+/// Toggle calling of callback on from within mmap() and mmap64().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_mmap_begin();
+
+/// Toggle calling of callback off from within mmap() and mmap64().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_mmap_end();
+
+/// Register callback to be called when mremap() is unexpected.
+/**
+ * Uses and is overridden by on_mremap().
+ *
+ * \sa expect_no_mremap_begin()
+ * \sa expect_no_mremap_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_mremap(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call mremap().
+#define EXPECT_NO_MREMAP(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mremap_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mremap_end()
+
+/// Return true if mremap is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+mremap_expected();
+
+/// Toggle calling of callback on from within mremap().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_mremap_begin();
+
+/// Toggle calling of callback off from within mremap().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_mremap_end();
+
+/// Register callback to be called when munmap() is unexpected.
+/**
+ * Uses and is overridden by on_munmap().
+ *
+ * \sa expect_no_munmap_begin()
+ * \sa expect_no_munmap_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_munmap(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call munmap().
+#define EXPECT_NO_MUNMAP(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_munmap_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_munmap_end()
+
+/// Return true if munmap is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+munmap_expected();
+
+/// Toggle calling of callback on from within munmap().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_munmap_begin();
+
+/// Toggle calling of callback off from within munmap().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_munmap_end();
+
+/// Register callback to be called when brk() and sbrk() is unexpected.
+/**
+ * Uses and is overridden by on_brk().
+ *
+ * \sa expect_no_brk_begin()
+ * \sa expect_no_brk_end()
+ */
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+on_unexpected_brk(AnyMemoryToolsCallback callback);
+
+/// Call corresponding callback if the given statements call brk() and sbrk().
+#define EXPECT_NO_BRK(statements) \
+  osrf_testing_tools_cpp::memory_tools::expect_no_brk_begin(); \
+  statements; \
+  osrf_testing_tools_cpp::memory_tools::expect_no_brk_end()
+
+/// Return true if brk is expected.
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+bool
+brk_expected();
+
+/// Toggle calling of callback on from within brk() and sbrk().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_brk_begin();
+
+/// Toggle calling of callback off from within brk() and sbrk().
+OSRF_TESTING_TOOLS_CPP_MEMORY_TOOLS_PUBLIC
+void
+expect_no_brk_end();
+
 /// Start checking for unexpected memory operations.
 #define EXPECT_NO_MEMORY_OPERATIONS_BEGIN() \
   osrf_testing_tools_cpp::memory_tools::expect_no_malloc_begin(); \
   osrf_testing_tools_cpp::memory_tools::expect_no_realloc_begin(); \
   osrf_testing_tools_cpp::memory_tools::expect_no_calloc_begin(); \
-  osrf_testing_tools_cpp::memory_tools::expect_no_free_begin()
+  osrf_testing_tools_cpp::memory_tools::expect_no_free_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_aligned_alloc_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_new_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_delete_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mmap_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mremap_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_munmap_begin(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_brk_begin()
 
 /// Stop checking for unexpected memory operations.
 #define EXPECT_NO_MEMORY_OPERATIONS_END() \
   osrf_testing_tools_cpp::memory_tools::expect_no_malloc_end(); \
   osrf_testing_tools_cpp::memory_tools::expect_no_realloc_end(); \
   osrf_testing_tools_cpp::memory_tools::expect_no_calloc_end(); \
-  osrf_testing_tools_cpp::memory_tools::expect_no_free_end()
+  osrf_testing_tools_cpp::memory_tools::expect_no_free_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_aligned_alloc_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_new_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_operator_delete_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mmap_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_mremap_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_munmap_end(); \
+  osrf_testing_tools_cpp::memory_tools::expect_no_brk_end()
 
 /// Call corresponding callback assert on any memory operation.
 #define EXPECT_NO_MEMORY_OPERATIONS(statements) \
@@ -0,0 +1,142 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocation_budget.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "./allocation_stats_impl.hpp"
+#include "./recursion_guard.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Keep failure messages readable, the call sites with the most bytes come first.
+static constexpr size_t REPORTED_CALL_SITES_MAX = 10;
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+ScopedAllocationBudget::ScopedAllocationBudget(const AllocationBudget & budget)
+: budget_(budget),
+  call_sites_(nullptr),
+  stats_(AllocationStatsScope::this_thread)
+{
+  {
+    // the table itself should not be counted
+    ScopedRecursionGuard recursion_guard;
+    call_sites_ = new (std::nothrow) AllocationCallSites();
+  }
+  if (nullptr != call_sites_) {
+    push_allocation_call_sites(call_sites_);
+  }
+}
+
+ScopedAllocationBudget::~ScopedAllocationBudget()
+{
+  if (nullptr != call_sites_) {
+    pop_allocation_call_sites();
+    ScopedRecursionGuard recursion_guard;
+    delete call_sites_;
+  }
+}
+
+static
+void
+write_call_site(std::ostringstream & out, const AllocationCallSite & call_site)
+{
+  out << "  " << call_site.count << " allocation(s), " << call_site.bytes_requested <<
+    " bytes requested, from:\n" <<
+    format_interned_stack(call_site.stack_id, REPORTED_FRAMES_MAX, "    ");
+}
+
+bool
+ScopedAllocationBudget::check(std::string * report) const
+{
+  const AllocationStats stats = stats_.get();
+  const bool allocations_exceeded = stats.allocation_count > budget_.max_allocations;
+  const bool bytes_exceeded = stats.bytes_requested > budget_.max_bytes;
+  const bool peak_exceeded = stats.peak_live_bytes > budget_.max_peak_live_bytes;
+  if (!allocations_exceeded && !bytes_exceeded && !peak_exceeded) {
+    return true;
+  }
+  if (nullptr == report) {
+    return false;
+  }
+
+  // nothing allocated from here on is counted, nor does it change the call sites
+  ScopedRecursionGuard recursion_guard;
+  std::ostringstream out;
+  out << "allocation budget exceeded:\n";
+  if (allocations_exceeded) {
+    out << "  allocations: " << stats.allocation_count << ", budget " <<
+      budget_.max_allocations << "\n";
+  }
+  if (bytes_exceeded) {
+    out << "  bytes requested: " << stats.bytes_requested << ", budget " <<
+      budget_.max_bytes << "\n";
+  }
+  if (peak_exceeded) {
+    out << "  peak live bytes: " << stats.peak_live_bytes << ", budget " <<
+      budget_.max_peak_live_bytes << "\n";
+  }
+  if (nullptr != call_sites_ && 0 != call_sites_->size) {
+    std::vector<AllocationCallSite> call_sites(
+      call_sites_->sites, call_sites_->sites + call_sites_->size);
+    std::sort(
+      call_sites.begin(), call_sites.end(),
+      [](const AllocationCallSite & lhs, const AllocationCallSite & rhs) {
+        return lhs.bytes_requested > rhs.bytes_requested;
+      });
+    out << "allocations by call site:\n";
+    uint64_t other_count = call_sites_->other_count;
+    uint64_t other_bytes_requested = call_sites_->other_bytes_requested;
+    for (size_t i = 0; i < call_sites.size(); ++i) {
+      if (i < REPORTED_CALL_SITES_MAX) {
+        write_call_site(out, call_sites[i]);
+      } else {
+        other_count += call_sites[i].count;
+        other_bytes_requested += call_sites[i].bytes_requested;
+      }
+    }
+    if (0 != other_count) {
+      out << "  " << other_count << " allocation(s), " << other_bytes_requested <<
+        " bytes requested, from other call sites\n";
+    }
+  }
+  *report = out.str();
+  return false;
+}
+
+AllocationStats
+ScopedAllocationBudget::get_stats() const
+{
+  return stats_.get();
+}
+
+const AllocationBudget &
+ScopedAllocationBudget::get_budget() const
+{
+  return budget_;
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
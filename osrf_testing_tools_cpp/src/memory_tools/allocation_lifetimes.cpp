@@ -0,0 +1,263 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocation_lifetimes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./allocation_lifetimes_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./live_allocation_table.hpp"
+#include "./per_stack_counters.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+/// Counters of a call stack, allocated the first time memory allocated from it is freed.
+struct CallSiteLifetimes
+{
+  std::atomic<uint64_t> buckets[ALLOCATION_LIFETIME_BUCKET_COUNT];
+  std::atomic<uint64_t> bytes_freed;
+  std::atomic<uint64_t> freed_by_allocating_thread_count;
+  std::atomic<uint64_t> short_lived_count;
+  std::atomic<uint64_t> allocated_after_free_count;
+};
+
+static std::atomic<bool> g_allocation_lifetimes_enabled(false);
+
+static PerStackCounters<CallSiteLifetimes> g_call_site_lifetimes;
+
+// Stack of the last allocation this thread freed, if it has not allocated since.
+static thread_local uint32_t g_tls_last_freed_stack_id = 0;
+
+bool
+allocation_lifetimes_recording_enabled() noexcept
+{
+  return g_allocation_lifetimes_enabled.load(std::memory_order_relaxed);
+}
+
+void
+allocation_lifetimes_record_allocation(uint32_t stack_id) noexcept
+{
+  const uint32_t last_freed_stack_id = g_tls_last_freed_stack_id;
+  g_tls_last_freed_stack_id = 0;
+  if (0 == last_freed_stack_id || last_freed_stack_id != stack_id) {
+    return;
+  }
+  CallSiteLifetimes * lifetimes = g_call_site_lifetimes.get(stack_id);
+  if (nullptr != lifetimes) {
+    lifetimes->allocated_after_free_count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void
+allocation_lifetimes_record_free(
+  uint32_t stack_id,
+  uint64_t size,
+  uint64_t lifetime_ns,
+  bool freed_by_allocating_thread) noexcept
+{
+  CallSiteLifetimes * lifetimes = g_call_site_lifetimes.get_or_create(stack_id);
+  if (nullptr == lifetimes) {
+    return;
+  }
+  lifetimes->buckets[get_log2_bucket(lifetime_ns)].fetch_add(1, std::memory_order_relaxed);
+  lifetimes->bytes_freed.fetch_add(size, std::memory_order_relaxed);
+  if (freed_by_allocating_thread) {
+    lifetimes->freed_by_allocating_thread_count.fetch_add(1, std::memory_order_relaxed);
+    if (lifetime_ns < SHORT_LIVED_ALLOCATION_NS) {
+      lifetimes->short_lived_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    g_tls_last_freed_stack_id = stack_id;
+  }
+}
+
+bool
+enable_allocation_lifetime_analysis()
+{
+  if (!create_live_allocation_table()) {
+    return false;
+  }
+  if (!g_allocation_lifetimes_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+  return true;
+}
+
+void
+disable_allocation_lifetime_analysis()
+{
+  if (g_allocation_lifetimes_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+allocation_lifetime_analysis_enabled()
+{
+  return allocation_lifetimes_recording_enabled();
+}
+
+void
+reset_allocation_lifetimes()
+{
+  g_call_site_lifetimes.for_each(
+    [](uint32_t, CallSiteLifetimes & lifetimes) {
+      for (auto & bucket : lifetimes.buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      lifetimes.bytes_freed.store(0, std::memory_order_relaxed);
+      lifetimes.freed_by_allocating_thread_count.store(0, std::memory_order_relaxed);
+      lifetimes.short_lived_count.store(0, std::memory_order_relaxed);
+      lifetimes.allocated_after_free_count.store(0, std::memory_order_relaxed);
+    });
+}
+
+/// Return the non-empty lifetimes with their stack id, most frees first.
+static
+std::vector<std::pair<uint32_t, AllocationLifetimes>>
+collect_allocation_lifetimes()
+{
+  std::vector<std::pair<uint32_t, AllocationLifetimes>> result;
+  g_call_site_lifetimes.for_each(
+    [&result](uint32_t stack_id, const CallSiteLifetimes & counters) {
+      AllocationLifetimes lifetimes;
+      for (size_t i = 0; i < ALLOCATION_LIFETIME_BUCKET_COUNT; ++i) {
+        lifetimes.buckets[i] = counters.buckets[i].load(std::memory_order_relaxed);
+      }
+      lifetimes.bytes_freed = counters.bytes_freed.load(std::memory_order_relaxed);
+      lifetimes.freed_by_allocating_thread_count =
+        counters.freed_by_allocating_thread_count.load(std::memory_order_relaxed);
+      lifetimes.short_lived_count = counters.short_lived_count.load(std::memory_order_relaxed);
+      lifetimes.allocated_after_free_count =
+        counters.allocated_after_free_count.load(std::memory_order_relaxed);
+      if (0 == lifetimes.freed_count()) {
+        return;
+      }
+      void * const * frames = nullptr;
+      const size_t depth = get_interned_stack(stack_id, &frames);
+      lifetimes.stack.assign(frames, frames + depth);
+      result.emplace_back(stack_id, std::move(lifetimes));
+    });
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const auto & lhs, const auto & rhs) {
+      return lhs.second.freed_count() > rhs.second.freed_count();
+    });
+  return result;
+}
+
+std::vector<AllocationLifetimes>
+get_allocation_lifetimes()
+{
+  std::vector<AllocationLifetimes> result;
+  for (auto & lifetimes : collect_allocation_lifetimes()) {
+    result.push_back(std::move(lifetimes.second));
+  }
+  return result;
+}
+
+std::string
+format_allocation_lifetimes(size_t max_call_sites)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const auto call_sites = collect_allocation_lifetimes();
+  size_t short_lived_call_sites = 0;
+  size_t in_loop_call_sites = 0;
+  for (const auto & call_site : call_sites) {
+    short_lived_call_sites += call_site.second.is_short_lived() ? 1 : 0;
+    in_loop_call_sites += call_site.second.is_allocated_in_loop() ? 1 : 0;
+  }
+  std::ostringstream out;
+  out << call_sites.size() << " call site(s) freed memory, " << short_lived_call_sites <<
+    " short-lived, " << in_loop_call_sites << " allocated in a loop\n";
+  for (size_t i = 0; i < call_sites.size() && i < max_call_sites; ++i) {
+    const AllocationLifetimes & lifetimes = call_sites[i].second;
+    const uint64_t count = lifetimes.freed_count();
+    out << count << " allocation(s) freed, " << lifetimes.bytes_freed << " bytes, " <<
+      (lifetimes.freed_by_allocating_thread_count * 100 / count) <<
+      "% by the allocating thread, from:\n" <<
+      format_interned_stack(call_sites[i].first, REPORTED_FRAMES_MAX, "  ");
+    if (lifetimes.is_short_lived()) {
+      out << "  short-lived: " << (lifetimes.short_lived_count * 100 / count) <<
+        "% freed by the allocating thread within " << SHORT_LIVED_ALLOCATION_NS <<
+        " ns, consider a stack buffer or an arena\n";
+    }
+    if (lifetimes.is_allocated_in_loop()) {
+      out << "  allocated in a loop: " << (lifetimes.allocated_after_free_count * 100 / count) <<
+        "% allocated again right after a free, consider reusing the memory or a pool\n";
+    }
+    out << "  lifetimes:\n";
+    for (size_t bucket = 0; bucket < ALLOCATION_LIFETIME_BUCKET_COUNT; ++bucket) {
+      if (0 == lifetimes.buckets[bucket]) {
+        continue;
+      }
+      out << "    ";
+      write_log2_bucket_range(out, bucket, " ns");
+      out << ": " << lifetimes.buckets[bucket] << " (" <<
+        (lifetimes.buckets[bucket] * 100 / count) << "%)\n";
+    }
+  }
+  if (call_sites.size() > max_call_sites) {
+    out << (call_sites.size() - max_call_sites) << " more call site(s)\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_allocation_lifetimes_at_exit()
+{
+  disable_allocation_lifetime_analysis();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_allocation_lifetimes();
+  SAFE_FWRITE(stderr, "[memory_tools][INFO] allocation lifetimes by call site: ");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the allocation lifetime analysis, if requested, when the library is loaded.
+static struct AllocationLifetimesInitializer
+{
+  AllocationLifetimesInitializer()
+  {
+    if (
+      environment_variable_is_enabled("MEMORY_TOOLS_ALLOCATION_LIFETIMES") &&
+      enable_allocation_lifetime_analysis())
+    {
+      std::atexit(report_allocation_lifetimes_at_exit);
+    }
+  }
+} g_allocation_lifetimes_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
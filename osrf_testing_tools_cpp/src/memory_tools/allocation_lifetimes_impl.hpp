@@ -0,0 +1,46 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__ALLOCATION_LIFETIMES_IMPL_HPP_
+#define MEMORY_TOOLS__ALLOCATION_LIFETIMES_IMPL_HPP_
+
+#include <cstdint>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if lifetimes are being recorded, see enable_allocation_lifetime_analysis().
+bool
+allocation_lifetimes_recording_enabled() noexcept;
+
+/// Called by the live allocation table when it adds an allocation made by this thread.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+allocation_lifetimes_record_allocation(uint32_t stack_id) noexcept;
+
+/// Called by the live allocation table when this thread frees a known allocation.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+allocation_lifetimes_record_free(
+  uint32_t stack_id,
+  uint64_t size,
+  uint64_t lifetime_ns,
+  bool freed_by_allocating_thread) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__ALLOCATION_LIFETIMES_IMPL_HPP_
@@ -0,0 +1,291 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocation_report.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "osrf_testing_tools_cpp/memory_tools/heap_profile.hpp"
+#include "./allocation_report_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./heap_profile.hpp"
+#include "./interposition_armed.hpp"
+#include "./live_allocation_table.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+static std::atomic<bool> g_allocation_report_enabled(false);
+// True if enable_allocation_report() turned the heap profile on, so disabling turns it off.
+static std::atomic<bool> g_allocation_report_owns_heap_profile(false);
+
+bool
+allocation_report_recording_enabled() noexcept
+{
+  return g_allocation_report_enabled.load(std::memory_order_relaxed);
+}
+
+bool
+enable_allocation_report()
+{
+  const bool table_available = create_live_allocation_table();
+  if (!g_allocation_report_enabled.exchange(true)) {
+    if (!heap_profiling_enabled()) {
+      enable_heap_profiling();
+      g_allocation_report_owns_heap_profile.store(true);
+    }
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+  return table_available;
+}
+
+void
+disable_allocation_report()
+{
+  if (g_allocation_report_enabled.exchange(false)) {
+    disarm_interposition();
+    if (g_allocation_report_owns_heap_profile.exchange(false)) {
+      disable_heap_profiling();
+    }
+  }
+}
+
+bool
+allocation_report_enabled()
+{
+  return allocation_report_recording_enabled();
+}
+
+/// A call stack which allocated or still holds memory, with its stack id.
+struct CollectedAllocationHotspot
+{
+  uint32_t stack_id;
+  AllocationHotspot hotspot;
+};
+
+/// Return the call stacks from the heap profile and the live allocation table, stacks left empty.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+static
+std::vector<CollectedAllocationHotspot>
+collect_allocation_hotspots()
+{
+  std::unordered_map<uint32_t, LiveAllocationTotals> live_totals;
+  for (const auto & group : collect_live_allocation_groups()) {
+    live_totals[group.stack_id] = group.totals;
+  }
+  std::vector<CollectedAllocationHotspot> result;
+  for (uint32_t stack_id = 0; stack_id <= STACK_TABLE_CAPACITY; ++stack_id) {
+    CollectedAllocationHotspot collected {stack_id, {{}, 0, 0, 0, 0}};
+    const bool allocated =
+      get_heap_profile_totals(stack_id, &collected.hotspot.count, &collected.hotspot.bytes);
+    const auto live = live_totals.find(stack_id);
+    if (live != live_totals.end()) {
+      collected.hotspot.live_count = live->second.count;
+      collected.hotspot.live_bytes = live->second.bytes;
+    } else if (!allocated) {
+      continue;
+    }
+    result.push_back(std::move(collected));
+  }
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const CollectedAllocationHotspot & lhs, const CollectedAllocationHotspot & rhs) {
+      return lhs.hotspot.count > rhs.hotspot.count;
+    });
+  return result;
+}
+
+std::vector<AllocationHotspot>
+get_allocation_hotspots()
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  std::vector<AllocationHotspot> result;
+  for (auto & collected : collect_allocation_hotspots()) {
+    void * const * frames = nullptr;
+    const size_t depth = get_interned_stack(collected.stack_id, &frames);
+    collected.hotspot.stack.assign(frames, frames + depth);
+    result.push_back(std::move(collected.hotspot));
+  }
+  return result;
+}
+
+/// Write the call stacks with the highest given counter, skipping those where it is 0.
+static
+void
+format_ranking(
+  std::ostringstream & out,
+  std::vector<CollectedAllocationHotspot> hotspots,
+  const char * title,
+  uint64_t AllocationHotspot::* counter,
+  size_t max_call_sites)
+{
+  std::stable_sort(
+    hotspots.begin(), hotspots.end(),
+    [counter](const CollectedAllocationHotspot & lhs, const CollectedAllocationHotspot & rhs) {
+      return lhs.hotspot.*counter > rhs.hotspot.*counter;
+    });
+  out << "top " << max_call_sites << " call site(s) by " << title << ":\n";
+  size_t rank = 0;
+  for (; rank < hotspots.size() && rank < max_call_sites; ++rank) {
+    const AllocationHotspot & hotspot = hotspots[rank].hotspot;
+    if (0 == hotspot.*counter) {
+      break;
+    }
+    out << "#" << (rank + 1) << ": " << hotspot.count << " allocation(s), " << hotspot.bytes <<
+      " bytes, " << hotspot.live_count << " live allocation(s) of " << hotspot.live_bytes <<
+      " bytes, from:\n" <<
+      format_interned_stack(hotspots[rank].stack_id, REPORTED_FRAMES_MAX, "  ");
+  }
+  if (0 == rank) {
+    out << "  none\n";
+  }
+}
+
+std::string
+format_allocation_report(size_t max_call_sites)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const auto hotspots = collect_allocation_hotspots();
+  AllocationHotspot totals {{}, 0, 0, 0, 0};
+  for (const auto & collected : hotspots) {
+    totals.count += collected.hotspot.count;
+    totals.bytes += collected.hotspot.bytes;
+    totals.live_count += collected.hotspot.live_count;
+    totals.live_bytes += collected.hotspot.live_bytes;
+  }
+  std::ostringstream out;
+  out << totals.count << " allocation(s) of " << totals.bytes << " bytes from " <<
+    hotspots.size() << " call site(s), " << totals.live_count << " allocation(s) of " <<
+    totals.live_bytes << " bytes still live\n";
+  const uint64_t sample_rate = get_heap_profile_sample_rate();
+  if (0 != sample_rate) {
+    out << "allocations are estimated from one sample every " << sample_rate << " bytes\n";
+  }
+  format_ranking(out, hotspots, "allocation count", &AllocationHotspot::count, max_call_sites);
+  format_ranking(out, hotspots, "bytes allocated", &AllocationHotspot::bytes, max_call_sites);
+  format_ranking(out, hotspots, "live bytes", &AllocationHotspot::live_bytes, max_call_sites);
+  return out.str();
+}
+
+bool
+write_allocation_report(const std::string & path, size_t max_call_sites)
+{
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_allocation_report(max_call_sites);
+  FILE * out = fopen(path.c_str(), "w");
+  if (nullptr == out) {
+    return false;
+  }
+  const bool written = report.size() == fwrite(report.data(), 1, report.size(), out);
+  return 0 == fclose(out) && written;
+}
+
+static char g_allocation_report_path[4096];
+static size_t g_allocation_report_max_call_sites = 10;
+
+/// Return the given path with every `%p` replaced by the process id.
+static
+std::string
+expand_process_id(std::string path)
+{
+#if defined(_WIN32)
+  const std::string process_id = std::to_string(_getpid());
+#else
+  const std::string process_id = std::to_string(getpid());
+#endif
+  for (
+    size_t position = path.find("%p");
+    std::string::npos != position;
+    position = path.find("%p", position + process_id.size()))
+  {
+    path.replace(position, 2, process_id);
+  }
+  return path;
+}
+
+static
+void
+write_allocation_report_at_exit()
+{
+  disable_allocation_report();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  if (0 == std::strcmp("-", g_allocation_report_path)) {
+    const std::string report = format_allocation_report(g_allocation_report_max_call_sites);
+    SAFE_FWRITE(stderr, "[memory_tools][INFO] allocation report: ");
+    SAFE_FWRITE(stderr, report.c_str());
+    return;
+  }
+  const std::string path = expand_process_id(g_allocation_report_path);
+  if (!write_allocation_report(path, g_allocation_report_max_call_sites)) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to write MEMORY_TOOLS_REPORT=");
+    SAFE_FWRITE(stderr, path.c_str());
+    SAFE_FWRITE(stderr, "\n");
+  }
+}
+
+/// Enables the allocation report, if requested, when the library is loaded.
+static struct AllocationReportInitializer
+{
+  AllocationReportInitializer()
+  {
+    char max_call_sites[32];
+    if (
+      get_environment_variable("MEMORY_TOOLS_REPORT_TOP", max_call_sites, sizeof(max_call_sites)))
+    {
+      const size_t value = std::strtoull(max_call_sites, nullptr, 10);
+      if (0 != value) {
+        g_allocation_report_max_call_sites = value;
+      }
+    }
+    if (
+      get_environment_variable(
+        "MEMORY_TOOLS_REPORT", g_allocation_report_path, sizeof(g_allocation_report_path)) &&
+      '\0' != g_allocation_report_path[0])
+    {
+      enable_allocation_report();
+      std::atexit(write_allocation_report_at_exit);
+    }
+  }
+} g_allocation_report_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,30 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__ALLOCATION_REPORT_IMPL_HPP_
+#define MEMORY_TOOLS__ALLOCATION_REPORT_IMPL_HPP_
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if the live allocation table is kept for the report, see enable_allocation_report().
+bool
+allocation_report_recording_enabled() noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__ALLOCATION_REPORT_IMPL_HPP_
@@ -0,0 +1,219 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocation_size_histograms.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./allocation_size_histograms_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./per_stack_counters.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Keep the report readable, the histogram of a call site is short anyway.
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+/// Counters of a call stack, allocated the first time the stack allocates.
+struct CallSiteSizeHistogram
+{
+  std::atomic<uint64_t> buckets[ALLOCATION_SIZE_BUCKET_COUNT];
+  std::atomic<uint64_t> bytes_requested;
+};
+
+static std::atomic<bool> g_allocation_size_histograms_enabled(false);
+
+static PerStackCounters<CallSiteSizeHistogram> g_call_site_size_histograms;
+
+bool
+allocation_size_histograms_recording_enabled() noexcept
+{
+  return g_allocation_size_histograms_enabled.load(std::memory_order_relaxed);
+}
+
+void
+allocation_size_histograms_record(const MemoryEvent & event) noexcept
+{
+  switch (event.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+    case MemoryFunctionType::Realloc:
+    case MemoryFunctionType::Calloc:
+    case MemoryFunctionType::AlignedAlloc:
+    case MemoryFunctionType::OperatorNew:
+      break;
+    default:
+      return;
+  }
+  // a failed allocation, or realloc(memory_in, 0) freeing memory_in, allocated nothing
+  if (
+    nullptr == event.memory_out ||
+    (MemoryFunctionType::Realloc == event.memory_function_type && 0 == event.size))
+  {
+    return;
+  }
+  CallSiteSizeHistogram * histogram = g_call_site_size_histograms.get_or_create(event.stack_id);
+  if (nullptr == histogram) {
+    return;
+  }
+  const uint64_t size = event.count * event.size;
+  histogram->buckets[get_allocation_size_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+  histogram->bytes_requested.fetch_add(size, std::memory_order_relaxed);
+}
+
+void
+enable_allocation_size_histograms()
+{
+  if (!g_allocation_size_histograms_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+}
+
+void
+disable_allocation_size_histograms()
+{
+  if (g_allocation_size_histograms_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+allocation_size_histograms_enabled()
+{
+  return allocation_size_histograms_recording_enabled();
+}
+
+void
+reset_allocation_size_histograms()
+{
+  g_call_site_size_histograms.for_each(
+    [](uint32_t, CallSiteSizeHistogram & histogram) {
+      for (auto & bucket : histogram.buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      histogram.bytes_requested.store(0, std::memory_order_relaxed);
+    });
+}
+
+/// Return the non-empty histograms with their stack id, most allocations first.
+static
+std::vector<std::pair<uint32_t, AllocationSizeHistogram>>
+collect_allocation_size_histograms()
+{
+  std::vector<std::pair<uint32_t, AllocationSizeHistogram>> histograms;
+  g_call_site_size_histograms.for_each(
+    [&histograms](uint32_t stack_id, const CallSiteSizeHistogram & counters) {
+      AllocationSizeHistogram histogram;
+      for (size_t i = 0; i < ALLOCATION_SIZE_BUCKET_COUNT; ++i) {
+        histogram.buckets[i] = counters.buckets[i].load(std::memory_order_relaxed);
+      }
+      histogram.bytes_requested = counters.bytes_requested.load(std::memory_order_relaxed);
+      if (0 == histogram.count()) {
+        return;
+      }
+      void * const * frames = nullptr;
+      const size_t depth = get_interned_stack(stack_id, &frames);
+      histogram.stack.assign(frames, frames + depth);
+      histograms.emplace_back(stack_id, std::move(histogram));
+    });
+  std::stable_sort(
+    histograms.begin(), histograms.end(),
+    [](const auto & lhs, const auto & rhs) {
+      return lhs.second.count() > rhs.second.count();
+    });
+  return histograms;
+}
+
+std::vector<AllocationSizeHistogram>
+get_allocation_size_histograms()
+{
+  std::vector<AllocationSizeHistogram> histograms;
+  for (auto & histogram : collect_allocation_size_histograms()) {
+    histograms.push_back(std::move(histogram.second));
+  }
+  return histograms;
+}
+
+std::string
+format_allocation_size_histograms(size_t max_call_sites)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const auto histograms = collect_allocation_size_histograms();
+  std::ostringstream out;
+  for (size_t i = 0; i < histograms.size() && i < max_call_sites; ++i) {
+    const AllocationSizeHistogram & histogram = histograms[i].second;
+    const uint64_t count = histogram.count();
+    out << count << " allocation(s), " << histogram.bytes_requested <<
+      " bytes requested, from:\n" <<
+      format_interned_stack(histograms[i].first, REPORTED_FRAMES_MAX, "  ") <<
+      "  sizes:\n";
+    for (size_t bucket = 0; bucket < ALLOCATION_SIZE_BUCKET_COUNT; ++bucket) {
+      if (0 == histogram.buckets[bucket]) {
+        continue;
+      }
+      out << "    ";
+      write_log2_bucket_range(out, bucket, "");
+      out << ": " << histogram.buckets[bucket] << " (" <<
+        (histogram.buckets[bucket] * 100 / count) << "%)\n";
+    }
+  }
+  if (histograms.size() > max_call_sites) {
+    out << (histograms.size() - max_call_sites) << " more call site(s)\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_allocation_size_histograms_at_exit()
+{
+  disable_allocation_size_histograms();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_allocation_size_histograms();
+  SAFE_FWRITE(
+    stderr, "[memory_tools][INFO] allocation sizes by call site, most allocations first:\n");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the allocation size histograms, if requested, when the library is loaded.
+static struct AllocationSizeHistogramsInitializer
+{
+  AllocationSizeHistogramsInitializer()
+  {
+    if (environment_variable_is_enabled("MEMORY_TOOLS_ALLOCATION_SIZE_HISTOGRAMS")) {
+      enable_allocation_size_histograms();
+      std::atexit(report_allocation_size_histograms_at_exit);
+    }
+  }
+} g_allocation_size_histograms_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
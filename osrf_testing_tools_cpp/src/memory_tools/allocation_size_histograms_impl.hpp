@@ -0,0 +1,37 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_IMPL_HPP_
+#define MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_IMPL_HPP_
+
+#include "./memory_event.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if allocation sizes are being counted, see enable_allocation_size_histograms().
+bool
+allocation_size_histograms_recording_enabled() noexcept;
+
+/// Add the size of the given event to the histogram of its call stack, if it is an allocation.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+allocation_size_histograms_record(const MemoryEvent & event) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__ALLOCATION_SIZE_HISTOGRAMS_IMPL_HPP_
@@ -0,0 +1,570 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocation_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <malloc.h>
+#include <pthread.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <pthread.h>
+#endif
+
+#include "./allocation_stats_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// The system name of a thread is read again after this many allocations, a power of two.
+static constexpr uint64_t THREAD_NAME_REFRESH_PERIOD = 1 << 12;
+
+/// Counters of the memory operations of one thread.
+/**
+ * Only the owning thread writes them, with relaxed loads and stores rather
+ * than read-modify-write operations, so updating them costs about as much as
+ * updating plain integers, while other threads may still read them.
+ * They are never freed, so that an all_threads scope can still read the
+ * counters of threads which have exited.
+ */
+struct ThreadAllocationCounters
+{
+  std::atomic<uint64_t> operation_count[MEMORY_FUNCTION_TYPE_COUNT];
+  std::atomic<uint64_t> operation_bytes[MEMORY_FUNCTION_TYPE_COUNT];
+  std::atomic<uint64_t> allocation_count;
+  std::atomic<uint64_t> deallocation_count;
+  std::atomic<uint64_t> bytes_requested;
+  std::atomic<uint64_t> bytes_allocated;
+  std::atomic<uint64_t> bytes_freed;
+  /// Highest value of bytes_allocated - bytes_freed, for this_thread scopes.
+  std::atomic<int64_t> peak_live_bytes;
+  /// Highest value of bytes_allocated - bytes_freed, never reset by scopes.
+  std::atomic<int64_t> lifetime_peak_live_bytes;
+  uint32_t thread_index;
+  /// Copy of the name, replaced but never freed since another thread may be reading it.
+  std::atomic<const char *> name;
+  /// True once set_current_thread_name() was called, the system name is not read anymore.
+  bool name_registered;
+  ThreadAllocationCounters * next;
+};
+
+// Number of alive ScopedAllocationStats, of any scope.
+static std::atomic<size_t> g_allocation_stats_count(0);
+// Number of alive ScopedAllocationStats with the all_threads scope.
+static std::atomic<size_t> g_all_threads_allocation_stats_count(0);
+// Live bytes and their peak over all threads, only updated while an all_threads scope is alive.
+static std::atomic<int64_t> g_all_threads_live_bytes(0);
+static std::atomic<int64_t> g_all_threads_peak_live_bytes(0);
+static std::atomic<bool> g_thread_allocation_accounting_enabled(false);
+// Lock-free list of the counters of every thread which ever recorded anything.
+static std::atomic<ThreadAllocationCounters *> g_thread_counters_list(nullptr);
+static thread_local ThreadAllocationCounters * g_tls_thread_counters = nullptr;
+// Innermost table installed with push_allocation_call_sites() in this thread.
+static thread_local AllocationCallSites * g_tls_call_sites = nullptr;
+
+bool
+allocation_stats_enabled() noexcept
+{
+  return 0 != g_allocation_stats_count.load(std::memory_order_relaxed);
+}
+
+size_t
+get_allocation_size(const void * memory) noexcept
+{
+  if (nullptr == memory) {
+    return 0;
+  }
+#if defined(__linux__)
+  return malloc_usable_size(const_cast<void *>(memory));
+#elif defined(__APPLE__)
+  return malloc_size(memory);
+#else
+  return 0;
+#endif
+}
+
+/// Return the counters of the calling thread, creating them if needed, or nullptr if that failed.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+static
+ThreadAllocationCounters *
+get_thread_counters() noexcept
+{
+  if (nullptr != g_tls_thread_counters) {
+    return g_tls_thread_counters;
+  }
+  // value-initialized, so all counters start at 0
+  auto counters = new (std::nothrow) ThreadAllocationCounters();
+  if (nullptr == counters) {
+    return nullptr;
+  }
+  counters->thread_index = get_thread_index();
+  counters->next = g_thread_counters_list.load();
+  while (!g_thread_counters_list.compare_exchange_weak(counters->next, counters)) {}
+  g_tls_thread_counters = counters;
+  return counters;
+}
+
+void
+push_allocation_call_sites(AllocationCallSites * call_sites) noexcept
+{
+  call_sites->previous = g_tls_call_sites;
+  g_tls_call_sites = call_sites;
+}
+
+bool
+allocation_call_sites_installed() noexcept
+{
+  return nullptr != g_tls_call_sites;
+}
+
+void
+pop_allocation_call_sites() noexcept
+{
+  if (nullptr != g_tls_call_sites) {
+    g_tls_call_sites = g_tls_call_sites->previous;
+  }
+}
+
+static
+void
+record_call_site(
+  AllocationCallSites & call_sites,
+  uint32_t stack_id,
+  uint64_t bytes_requested) noexcept
+{
+  for (size_t i = 0; i < call_sites.size; ++i) {
+    if (call_sites.sites[i].stack_id == stack_id) {
+      call_sites.sites[i].count++;
+      call_sites.sites[i].bytes_requested += bytes_requested;
+      return;
+    }
+  }
+  if (call_sites.size < ALLOCATION_CALL_SITES_CAPACITY) {
+    call_sites.sites[call_sites.size++] = {stack_id, 1, bytes_requested};
+  } else {
+    call_sites.other_count++;
+    call_sites.other_bytes_requested += bytes_requested;
+  }
+}
+
+template<typename T>
+static inline
+void
+add(std::atomic<T> & counter, T value) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static
+void
+update_maximum(std::atomic<int64_t> & maximum, int64_t value) noexcept
+{
+  int64_t current = maximum.load(std::memory_order_relaxed);
+  while (value > current && !maximum.compare_exchange_weak(current, value)) {}
+}
+
+/// Replace the name of the given counters with a copy of name, if it changed.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+static
+void
+store_thread_name(ThreadAllocationCounters & counters, const char * name) noexcept
+{
+  const char * current = counters.name.load(std::memory_order_acquire);
+  if (nullptr != current && 0 == std::strcmp(current, name)) {
+    return;
+  }
+  const size_t size = std::strlen(name) + 1;
+  char * copy = new (std::nothrow) char[size];
+  if (nullptr == copy) {
+    return;
+  }
+  std::memcpy(copy, name, size);
+  // the previous copy is leaked on purpose, a report may be reading it
+  counters.name.store(copy, std::memory_order_release);
+}
+
+/// Read the system name of the calling thread in to its counters.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+static
+void
+refresh_thread_name(ThreadAllocationCounters & counters) noexcept
+{
+  if (counters.name_registered) {
+    return;
+  }
+#if defined(__linux__) || defined(__APPLE__)
+  char name[64];
+  if (0 == pthread_getname_np(pthread_self(), name, sizeof(name)) && '\0' != name[0]) {
+    store_thread_name(counters, name);
+  }
+#endif
+}
+
+void
+allocation_stats_record(const MemoryEvent & event) noexcept
+{
+  ThreadAllocationCounters * counters = get_thread_counters();
+  if (nullptr == counters) {
+    return;
+  }
+  const size_t type_index = static_cast<size_t>(event.memory_function_type);
+  if (type_index >= MEMORY_FUNCTION_TYPE_COUNT) {
+    return;
+  }
+  const uint64_t requested = event.count * event.size;
+  add<uint64_t>(counters->operation_count[type_index], 1);
+  add(counters->operation_bytes[type_index], requested);
+
+  bool allocated = false;
+  bool deallocated = false;
+  uint64_t bytes_allocated = 0;
+  uint64_t bytes_freed = 0;
+  switch (event.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+    case MemoryFunctionType::Calloc:
+    case MemoryFunctionType::AlignedAlloc:
+    case MemoryFunctionType::OperatorNew:
+      allocated = nullptr != event.memory_out;
+      bytes_allocated = get_allocation_size(event.memory_out);
+      break;
+    case MemoryFunctionType::Realloc:
+      allocated = nullptr != event.memory_out;
+      bytes_allocated = get_allocation_size(event.memory_out);
+      // memory_in is kept if realloc failed, and freed by realloc(memory_in, 0)
+      deallocated = nullptr != event.memory_in && (allocated || 0 == event.size);
+      bytes_freed = deallocated ? event.memory_in_size : 0;
+      break;
+    case MemoryFunctionType::Free:
+    case MemoryFunctionType::OperatorDelete:
+    case MemoryFunctionType::Munmap:
+      deallocated = true;
+      bytes_freed = event.memory_in_size;
+      break;
+    case MemoryFunctionType::Mmap:
+    case MemoryFunctionType::Mremap:
+    case MemoryFunctionType::Brk:
+      // only count the change if it happened, a shrinking brk only gives memory back
+      if (nullptr != event.memory_out) {
+        allocated = 0 != event.size;
+        bytes_allocated = event.size;
+        deallocated = 0 != event.memory_in_size;
+        bytes_freed = event.memory_in_size;
+      }
+      break;
+  }
+  if (allocated) {
+    add<uint64_t>(counters->allocation_count, 1);
+    if (
+      g_thread_allocation_accounting_enabled.load(std::memory_order_relaxed) &&
+      1 == (counters->allocation_count.load(std::memory_order_relaxed) &
+      (THREAD_NAME_REFRESH_PERIOD - 1)))
+    {
+      refresh_thread_name(*counters);
+    }
+    add(counters->bytes_requested, requested);
+    add(counters->bytes_allocated, bytes_allocated);
+    if (nullptr != g_tls_call_sites) {
+      for (
+        auto call_sites = g_tls_call_sites;
+        nullptr != call_sites;
+        call_sites = call_sites->previous)
+      {
+        record_call_site(*call_sites, event.stack_id, requested);
+      }
+    }
+  }
+  if (deallocated) {
+    add<uint64_t>(counters->deallocation_count, 1);
+    add(counters->bytes_freed, bytes_freed);
+  }
+  if (!allocated && !deallocated) {
+    return;
+  }
+
+  const int64_t live_bytes_change =
+    static_cast<int64_t>(bytes_allocated) - static_cast<int64_t>(bytes_freed);
+  const int64_t thread_live_bytes = static_cast<int64_t>(
+    counters->bytes_allocated.load(std::memory_order_relaxed) -
+    counters->bytes_freed.load(std::memory_order_relaxed));
+  if (thread_live_bytes > counters->peak_live_bytes.load(std::memory_order_relaxed)) {
+    counters->peak_live_bytes.store(thread_live_bytes, std::memory_order_relaxed);
+  }
+  if (thread_live_bytes > counters->lifetime_peak_live_bytes.load(std::memory_order_relaxed)) {
+    counters->lifetime_peak_live_bytes.store(thread_live_bytes, std::memory_order_relaxed);
+  }
+  // only all_threads scopes pay for shared counters
+  if (0 != g_all_threads_allocation_stats_count.load(std::memory_order_relaxed)) {
+    const int64_t all_threads_live_bytes = live_bytes_change + g_all_threads_live_bytes.fetch_add(
+      live_bytes_change, std::memory_order_relaxed);
+    update_maximum(g_all_threads_peak_live_bytes, all_threads_live_bytes);
+  }
+}
+
+/// Read counters, live_bytes is bytes_allocated - bytes_freed and peak_live_bytes is left 0.
+static
+void
+accumulate_counters(const ThreadAllocationCounters & counters, AllocationStats & stats) noexcept
+{
+  for (size_t i = 0; i < MEMORY_FUNCTION_TYPE_COUNT; ++i) {
+    stats.operation_count[i] += counters.operation_count[i].load(std::memory_order_relaxed);
+    stats.operation_bytes[i] += counters.operation_bytes[i].load(std::memory_order_relaxed);
+  }
+  stats.allocation_count += counters.allocation_count.load(std::memory_order_relaxed);
+  stats.deallocation_count += counters.deallocation_count.load(std::memory_order_relaxed);
+  stats.bytes_requested += counters.bytes_requested.load(std::memory_order_relaxed);
+  stats.bytes_allocated += counters.bytes_allocated.load(std::memory_order_relaxed);
+  stats.bytes_freed += counters.bytes_freed.load(std::memory_order_relaxed);
+  stats.live_bytes = static_cast<int64_t>(stats.bytes_allocated - stats.bytes_freed);
+}
+
+static
+AllocationStats
+read_counters(AllocationStatsScope scope, const ThreadAllocationCounters * thread_counters)
+{
+  AllocationStats stats {};
+  if (AllocationStatsScope::all_threads == scope) {
+    for (
+      auto counters = g_thread_counters_list.load();
+      nullptr != counters;
+      counters = counters->next)
+    {
+      accumulate_counters(*counters, stats);
+    }
+  } else if (nullptr != thread_counters) {
+    accumulate_counters(*thread_counters, stats);
+  }
+  return stats;
+}
+
+ScopedAllocationStats::ScopedAllocationStats(AllocationStatsScope scope)
+: scope_(scope),
+  thread_counters_(nullptr),
+  start_(),
+  start_live_bytes_(0),
+  saved_peak_live_bytes_(0)
+{
+  {
+    // creating the counters of this thread allocates, which should not be counted
+    ScopedRecursionGuard recursion_guard;
+    thread_counters_ = get_thread_counters();
+  }
+  if (AllocationStatsScope::all_threads == scope_) {
+    ++g_all_threads_allocation_stats_count;
+    start_live_bytes_ = g_all_threads_live_bytes.load();
+    saved_peak_live_bytes_ = g_all_threads_peak_live_bytes.exchange(start_live_bytes_);
+  } else if (nullptr != thread_counters_) {
+    start_live_bytes_ = static_cast<int64_t>(
+      thread_counters_->bytes_allocated.load() - thread_counters_->bytes_freed.load());
+    saved_peak_live_bytes_ = thread_counters_->peak_live_bytes.exchange(start_live_bytes_);
+  }
+  start_ = read_counters(scope_, thread_counters_);
+  ++g_allocation_stats_count;
+  arm_interposition();
+}
+
+ScopedAllocationStats::~ScopedAllocationStats()
+{
+  disarm_interposition();
+  --g_allocation_stats_count;
+  // an enclosing instance must see the peak over its whole lifetime, including this one
+  if (AllocationStatsScope::all_threads == scope_) {
+    update_maximum(g_all_threads_peak_live_bytes, saved_peak_live_bytes_);
+    --g_all_threads_allocation_stats_count;
+  } else if (nullptr != thread_counters_) {
+    update_maximum(thread_counters_->peak_live_bytes, saved_peak_live_bytes_);
+  }
+}
+
+AllocationStats
+ScopedAllocationStats::get() const
+{
+  AllocationStats stats = read_counters(scope_, thread_counters_);
+  for (size_t i = 0; i < MEMORY_FUNCTION_TYPE_COUNT; ++i) {
+    stats.operation_count[i] -= start_.operation_count[i];
+    stats.operation_bytes[i] -= start_.operation_bytes[i];
+  }
+  stats.allocation_count -= start_.allocation_count;
+  stats.deallocation_count -= start_.deallocation_count;
+  stats.bytes_requested -= start_.bytes_requested;
+  stats.bytes_allocated -= start_.bytes_allocated;
+  stats.bytes_freed -= start_.bytes_freed;
+  stats.live_bytes -= start_.live_bytes;
+
+  int64_t peak_live_bytes = 0;
+  if (AllocationStatsScope::all_threads == scope_) {
+    peak_live_bytes = g_all_threads_peak_live_bytes.load();
+  } else if (nullptr != thread_counters_) {
+    peak_live_bytes = thread_counters_->peak_live_bytes.load();
+  }
+  stats.peak_live_bytes = peak_live_bytes - start_live_bytes_;
+  if (stats.peak_live_bytes < 0) {
+    stats.peak_live_bytes = 0;
+  }
+  return stats;
+}
+
+AllocationStatsScope
+ScopedAllocationStats::get_scope() const
+{
+  return scope_;
+}
+
+void
+enable_thread_allocation_accounting()
+{
+  if (!g_thread_allocation_accounting_enabled.exchange(true)) {
+    // counted like a ScopedAllocationStats which is alive until disabled
+    ++g_allocation_stats_count;
+    arm_interposition();
+  }
+}
+
+void
+disable_thread_allocation_accounting()
+{
+  if (g_thread_allocation_accounting_enabled.exchange(false)) {
+    disarm_interposition();
+    --g_allocation_stats_count;
+  }
+}
+
+bool
+thread_allocation_accounting_enabled()
+{
+  return g_thread_allocation_accounting_enabled.load();
+}
+
+void
+set_current_thread_name(const char * name)
+{
+  // creating the counters and copying the name allocates, which should not be counted
+  ScopedRecursionGuard recursion_guard;
+  ThreadAllocationCounters * counters = get_thread_counters();
+  if (nullptr == counters || nullptr == name) {
+    return;
+  }
+  counters->name_registered = true;
+  store_thread_name(*counters, name);
+}
+
+std::vector<ThreadAllocationStats>
+get_thread_allocation_stats()
+{
+  std::vector<ThreadAllocationStats> result;
+  for (
+    auto counters = g_thread_counters_list.load();
+    nullptr != counters;
+    counters = counters->next)
+  {
+    ThreadAllocationStats thread_stats {};
+    thread_stats.thread_index = counters->thread_index;
+    const char * name = counters->name.load(std::memory_order_acquire);
+    if (nullptr != name) {
+      thread_stats.name = name;
+    }
+    accumulate_counters(*counters, thread_stats.stats);
+    thread_stats.stats.peak_live_bytes = std::max<int64_t>(
+      0, counters->lifetime_peak_live_bytes.load(std::memory_order_relaxed));
+    result.push_back(std::move(thread_stats));
+  }
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const ThreadAllocationStats & lhs, const ThreadAllocationStats & rhs) {
+      if (lhs.stats.allocation_count != rhs.stats.allocation_count) {
+        return lhs.stats.allocation_count > rhs.stats.allocation_count;
+      }
+      return lhs.thread_index < rhs.thread_index;
+    });
+  return result;
+}
+
+std::string
+format_thread_allocation_stats(size_t max_threads)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const auto threads = get_thread_allocation_stats();
+  uint64_t allocation_count = 0;
+  uint64_t bytes_allocated = 0;
+  for (const auto & thread : threads) {
+    allocation_count += thread.stats.allocation_count;
+    bytes_allocated += thread.stats.bytes_allocated;
+  }
+  std::ostringstream out;
+  out << threads.size() << " thread(s) made " << allocation_count << " allocation(s) of " <<
+    bytes_allocated << " bytes\n";
+  out << std::setw(8) << "thread" << "  " << std::left << std::setw(20) << "name" << std::right <<
+    std::setw(12) << "allocations" << std::setw(12) << "frees" << std::setw(14) << "bytes" <<
+    std::setw(14) << "live bytes" << std::setw(14) << "peak bytes" << "\n";
+  for (size_t i = 0; i < threads.size() && i < max_threads; ++i) {
+    const ThreadAllocationStats & thread = threads[i];
+    out << std::setw(8) << thread.thread_index << "  " << std::left << std::setw(20) <<
+      (thread.name.empty() ? "-" : thread.name) << std::right <<
+      std::setw(12) << thread.stats.allocation_count <<
+      std::setw(12) << thread.stats.deallocation_count <<
+      std::setw(14) << thread.stats.bytes_allocated <<
+      std::setw(14) << thread.stats.live_bytes <<
+      std::setw(14) << thread.stats.peak_live_bytes << "\n";
+  }
+  if (threads.size() > max_threads) {
+    out << (threads.size() - max_threads) << " more thread(s)\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_thread_allocation_stats_at_exit()
+{
+  disable_thread_allocation_accounting();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_thread_allocation_stats();
+  SAFE_FWRITE(stderr, "[memory_tools][INFO] allocations by thread: ");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the per-thread accounting, if requested, when the library is loaded.
+static struct ThreadAllocationStatsInitializer
+{
+  ThreadAllocationStatsInitializer()
+  {
+    if (environment_variable_is_enabled("MEMORY_TOOLS_THREAD_STATS")) {
+      enable_thread_allocation_accounting();
+      std::atexit(report_thread_allocation_stats_at_exit);
+    }
+  }
+} g_thread_allocation_stats_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,81 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__ALLOCATION_STATS_IMPL_HPP_
+#define MEMORY_TOOLS__ALLOCATION_STATS_IMPL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./memory_event.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Allocations made from one stack, see AllocationCallSites.
+struct AllocationCallSite
+{
+  uint32_t stack_id;
+  uint64_t count;
+  uint64_t bytes_requested;
+};
+
+/// Maximum number of distinct stacks kept by AllocationCallSites.
+static constexpr size_t ALLOCATION_CALL_SITES_CAPACITY = 64;
+
+/// Table of the allocations made by a thread, by stack, used to explain budget failures.
+/** Allocations from more distinct stacks than fit are only counted in the other_* members. */
+struct AllocationCallSites
+{
+  AllocationCallSite sites[ALLOCATION_CALL_SITES_CAPACITY];
+  size_t size;
+  uint64_t other_count;
+  uint64_t other_bytes_requested;
+  /// Table which was installed before this one, it gets the allocations too.
+  AllocationCallSites * previous;
+};
+
+/// Install a table which gets the allocations of the calling thread, until it is removed.
+/** Needs a ScopedAllocationStats alive for allocations to be recorded at all. */
+void
+push_allocation_call_sites(AllocationCallSites * call_sites) noexcept;
+
+/// Remove the table installed last by push_allocation_call_sites() in this thread.
+void
+pop_allocation_call_sites() noexcept;
+
+/// Return true if the calling thread has a table installed by push_allocation_call_sites().
+/** Allocations then need their stack id, see record_memory_event(). */
+bool
+allocation_call_sites_installed() noexcept;
+
+/// Return true if any ScopedAllocationStats is alive.
+bool
+allocation_stats_enabled() noexcept;
+
+/// Count the given event in the calling thread's counters.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+allocation_stats_record(const MemoryEvent & event) noexcept;
+
+/// Return the usable size of memory returned by malloc and friends, 0 if not available.
+size_t
+get_allocation_size(const void * memory) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__ALLOCATION_STATS_IMPL_HPP_
@@ -0,0 +1,346 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/allocator_latency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "./allocator_latency_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./memory_event.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./trace_file_format.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Operations which took this long or more are counted as stalls in the report.
+static constexpr uint64_t STALL_LATENCY_NS = 1 << 20;
+
+/// Latency counters of one operation and size class.
+struct LatencyCounters
+{
+  std::atomic<uint64_t> buckets[ALLOCATOR_LATENCY_BUCKET_COUNT];
+  std::atomic<uint64_t> total_ns;
+  std::atomic<uint64_t> max_ns;
+};
+
+/// Latency counters of one thread.
+/**
+ * Like the allocation stats counters, only the owning thread writes them,
+ * with relaxed loads and stores, and they are never freed so the histograms
+ * of threads which have exited are still reported.
+ */
+struct ThreadLatencyCounters
+{
+  uint32_t thread_index;
+  LatencyCounters counters[MEMORY_FUNCTION_TYPE_COUNT][ALLOCATOR_LATENCY_SIZE_CLASS_COUNT];
+  ThreadLatencyCounters * next;
+};
+
+static std::atomic<bool> g_allocator_latency_enabled(false);
+// Lock-free list of the counters of every thread which ever recorded anything.
+static std::atomic<ThreadLatencyCounters *> g_thread_latency_counters_list(nullptr);
+static thread_local ThreadLatencyCounters * g_tls_thread_latency_counters = nullptr;
+
+bool
+allocator_latency_recording_enabled() noexcept
+{
+  return g_allocator_latency_enabled.load(std::memory_order_relaxed);
+}
+
+/// Return the counters of the calling thread, creating them if needed, or nullptr if that failed.
+static
+ThreadLatencyCounters *
+get_thread_latency_counters() noexcept
+{
+  if (nullptr != g_tls_thread_latency_counters) {
+    return g_tls_thread_latency_counters;
+  }
+  // value-initialized, so all counters start at 0
+  auto counters = new (std::nothrow) ThreadLatencyCounters();
+  if (nullptr == counters) {
+    return nullptr;
+  }
+  counters->thread_index = get_thread_index();
+  counters->next = g_thread_latency_counters_list.load();
+  while (!g_thread_latency_counters_list.compare_exchange_weak(counters->next, counters)) {}
+  g_tls_thread_latency_counters = counters;
+  return counters;
+}
+
+static inline
+void
+add(std::atomic<uint64_t> & counter, uint64_t value) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void
+allocator_latency_record(
+  MemoryFunctionType memory_function_type,
+  uint64_t size,
+  uint64_t latency_ns) noexcept
+{
+  ThreadLatencyCounters * thread_counters = get_thread_latency_counters();
+  if (nullptr == thread_counters) {
+    return;
+  }
+  LatencyCounters & counters = thread_counters->counters
+    [static_cast<size_t>(memory_function_type)][get_allocator_latency_size_class(size)];
+  add(counters.buckets[get_allocator_latency_bucket(latency_ns)], 1);
+  add(counters.total_ns, latency_ns);
+  if (latency_ns > counters.max_ns.load(std::memory_order_relaxed)) {
+    counters.max_ns.store(latency_ns, std::memory_order_relaxed);
+  }
+}
+
+void
+enable_allocator_latency_histograms()
+{
+  if (!g_allocator_latency_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be timed
+    arm_interposition();
+  }
+}
+
+void
+disable_allocator_latency_histograms()
+{
+  if (g_allocator_latency_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+allocator_latency_histograms_enabled()
+{
+  return allocator_latency_recording_enabled();
+}
+
+void
+reset_allocator_latency_histograms()
+{
+  // operations timed concurrently by other threads may survive the reset
+  for (
+    ThreadLatencyCounters * thread_counters = g_thread_latency_counters_list.load();
+    nullptr != thread_counters;
+    thread_counters = thread_counters->next)
+  {
+    for (auto & type_counters : thread_counters->counters) {
+      for (auto & counters : type_counters) {
+        for (auto & bucket : counters.buckets) {
+          bucket.store(0, std::memory_order_relaxed);
+        }
+        counters.total_ns.store(0, std::memory_order_relaxed);
+        counters.max_ns.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+/// Add the given counters to a histogram.
+static
+void
+accumulate(AllocatorLatencyHistogram & histogram, const LatencyCounters & counters)
+{
+  for (size_t bucket = 0; bucket < ALLOCATOR_LATENCY_BUCKET_COUNT; ++bucket) {
+    histogram.buckets[bucket] += counters.buckets[bucket].load(std::memory_order_relaxed);
+  }
+  histogram.total_ns += counters.total_ns.load(std::memory_order_relaxed);
+  histogram.max_ns = std::max(histogram.max_ns, counters.max_ns.load(std::memory_order_relaxed));
+}
+
+/// Return an empty histogram.
+static
+AllocatorLatencyHistogram
+make_histogram(uint32_t thread_index, size_t memory_function_type, size_t size_class)
+{
+  // value-initialized, so all buckets start at 0
+  AllocatorLatencyHistogram histogram = AllocatorLatencyHistogram();
+  histogram.thread_index = thread_index;
+  histogram.memory_function_type = static_cast<MemoryFunctionType>(memory_function_type);
+  histogram.size_class = size_class;
+  return histogram;
+}
+
+std::vector<AllocatorLatencyHistogram>
+get_allocator_latency_histograms()
+{
+  std::vector<AllocatorLatencyHistogram> result;
+  for (
+    const ThreadLatencyCounters * thread_counters = g_thread_latency_counters_list.load();
+    nullptr != thread_counters;
+    thread_counters = thread_counters->next)
+  {
+    for (size_t type = 0; type < MEMORY_FUNCTION_TYPE_COUNT; ++type) {
+      for (size_t size_class = 0; size_class < ALLOCATOR_LATENCY_SIZE_CLASS_COUNT; ++size_class) {
+        auto histogram = make_histogram(thread_counters->thread_index, type, size_class);
+        accumulate(histogram, thread_counters->counters[type][size_class]);
+        if (0 != histogram.count()) {
+          result.push_back(histogram);
+        }
+      }
+    }
+  }
+  // the list is newest thread first
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const AllocatorLatencyHistogram & lhs, const AllocatorLatencyHistogram & rhs) {
+      return lhs.thread_index < rhs.thread_index;
+    });
+  return result;
+}
+
+std::vector<AllocatorLatencyHistogram>
+get_merged_allocator_latency_histograms()
+{
+  std::vector<AllocatorLatencyHistogram> result;
+  for (size_t type = 0; type < MEMORY_FUNCTION_TYPE_COUNT; ++type) {
+    for (size_t size_class = 0; size_class < ALLOCATOR_LATENCY_SIZE_CLASS_COUNT; ++size_class) {
+      auto histogram = make_histogram(0, type, size_class);
+      for (
+        const ThreadLatencyCounters * thread_counters = g_thread_latency_counters_list.load();
+        nullptr != thread_counters;
+        thread_counters = thread_counters->next)
+      {
+        accumulate(histogram, thread_counters->counters[type][size_class]);
+      }
+      if (0 != histogram.count()) {
+        result.push_back(histogram);
+      }
+    }
+  }
+  return result;
+}
+
+static
+const char *
+get_size_class_str(size_t size_class)
+{
+  static const char * const names[ALLOCATOR_LATENCY_SIZE_CLASS_COUNT] = {
+    "<=256B", "<=4KiB", "<=128KiB", ">128KiB"};
+  return names[size_class];
+}
+
+/// Write one row of the report, the columns after the label.
+static
+void
+format_histogram_row(std::ostringstream & out, const AllocatorLatencyHistogram & histogram)
+{
+  const uint64_t count = histogram.count();
+  out << std::setw(10) << count <<
+    std::setw(10) << (0 == count ? 0 : histogram.total_ns / count) <<
+    std::setw(10) << histogram.get_percentile_ns(50.0) <<
+    std::setw(10) << histogram.get_percentile_ns(99.0) <<
+    std::setw(10) << histogram.get_percentile_ns(99.9) <<
+    std::setw(12) << histogram.max_ns << "\n";
+}
+
+std::string
+format_allocator_latency_histograms(size_t max_threads)
+{
+  // nothing allocated from here on is timed
+  ScopedRecursionGuard recursion_guard;
+  const auto merged = get_merged_allocator_latency_histograms();
+  // every histogram of a thread merged in one, to find the threads which stalled
+  std::vector<AllocatorLatencyHistogram> threads;
+  for (const auto & histogram : get_allocator_latency_histograms()) {
+    if (threads.empty() || threads.back().thread_index != histogram.thread_index) {
+      threads.push_back(make_histogram(histogram.thread_index, 0, 0));
+    }
+    AllocatorLatencyHistogram & thread = threads.back();
+    for (size_t bucket = 0; bucket < ALLOCATOR_LATENCY_BUCKET_COUNT; ++bucket) {
+      thread.buckets[bucket] += histogram.buckets[bucket];
+    }
+    thread.total_ns += histogram.total_ns;
+    thread.max_ns = std::max(thread.max_ns, histogram.max_ns);
+  }
+  std::stable_sort(
+    threads.begin(), threads.end(),
+    [](const AllocatorLatencyHistogram & lhs, const AllocatorLatencyHistogram & rhs) {
+      return lhs.max_ns > rhs.max_ns;
+    });
+  uint64_t total_count = 0;
+  uint64_t stall_count = 0;
+  for (const auto & histogram : merged) {
+    total_count += histogram.count();
+    stall_count += histogram.count_at_least(STALL_LATENCY_NS);
+  }
+  std::ostringstream out;
+  out << total_count << " operation(s) timed in " << threads.size() << " thread(s), " <<
+    stall_count << " took about 1 ms or more\n";
+  out << std::left << std::setw(16) << "operation" << std::setw(10) << "size" << std::right <<
+    std::setw(10) << "count" << std::setw(10) << "mean ns" << std::setw(10) << "p50 ns" <<
+    std::setw(10) << "p99 ns" << std::setw(10) << "p99.9 ns" << std::setw(12) << "max ns" << "\n";
+  for (const auto & histogram : merged) {
+    out << std::left <<
+      std::setw(16) << trace_file_memory_function_type_str(
+      static_cast<uint16_t>(histogram.memory_function_type)) <<
+      std::setw(10) << get_size_class_str(histogram.size_class) << std::right;
+    format_histogram_row(out, histogram);
+  }
+  if (!threads.empty()) {
+    out << "slowest thread(s), all operations:\n";
+  }
+  for (size_t i = 0; i < threads.size() && i < max_threads; ++i) {
+    out << std::left << std::setw(26) << ("thread " + std::to_string(threads[i].thread_index)) <<
+      std::right;
+    format_histogram_row(out, threads[i]);
+  }
+  if (threads.size() > max_threads) {
+    out << (threads.size() - max_threads) << " more thread(s)\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_allocator_latency_at_exit()
+{
+  disable_allocator_latency_histograms();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_allocator_latency_histograms();
+  SAFE_FWRITE(stderr, "[memory_tools][INFO] allocator latency: ");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the allocator latency histograms, if requested, when the library is loaded.
+static struct AllocatorLatencyInitializer
+{
+  AllocatorLatencyInitializer()
+  {
+    if (environment_variable_is_enabled("MEMORY_TOOLS_ALLOCATOR_LATENCY")) {
+      enable_allocator_latency_histograms();
+      std::atexit(report_allocator_latency_at_exit);
+    }
+  }
+} g_allocator_latency_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
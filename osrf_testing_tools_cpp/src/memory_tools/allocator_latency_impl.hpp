@@ -0,0 +1,45 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__ALLOCATOR_LATENCY_IMPL_HPP_
+#define MEMORY_TOOLS__ALLOCATOR_LATENCY_IMPL_HPP_
+
+#include <cstdint>
+
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if the original functions are timed, see enable_allocator_latency_histograms().
+bool
+allocator_latency_recording_enabled() noexcept;
+
+/// Called by the custom memory functions with the time spent in the original function.
+/**
+ * size is the requested size, or the usable size of the block for frees.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+void
+allocator_latency_record(
+  MemoryFunctionType memory_function_type,
+  uint64_t size,
+  uint64_t latency_ns) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__ALLOCATOR_LATENCY_IMPL_HPP_
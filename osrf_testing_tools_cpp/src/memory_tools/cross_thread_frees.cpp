@@ -0,0 +1,313 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/cross_thread_frees.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "./cross_thread_frees_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./live_allocation_table.hpp"
+#include "./memory_event.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Must be a power of two, a pair which does not fit is dropped.
+static constexpr size_t CROSS_THREAD_FREE_TABLE_CAPACITY = 1 << 12;
+
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+static constexpr uint32_t SLOT_EMPTY = 0;
+static constexpr uint32_t SLOT_CLAIMED = 1;
+static constexpr uint32_t SLOT_PUBLISHED = 2;
+
+/// A pair of call stacks and threads, keys are written once before the slot is published.
+struct CrossThreadFreeSlot
+{
+  std::atomic<uint32_t> state;
+  /// Allocation stack id in the high half, free stack id in the low half.
+  uint64_t stacks;
+  /// Allocating thread in the high half, freeing thread in the low half.
+  uint64_t threads;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> bytes;
+};
+
+static std::atomic<bool> g_cross_thread_frees_enabled(false);
+static CrossThreadFreeSlot g_cross_thread_free_slots[CROSS_THREAD_FREE_TABLE_CAPACITY];
+static std::atomic<uint64_t> g_free_count(0);
+static std::atomic<uint64_t> g_cross_thread_free_count(0);
+static std::atomic<uint64_t> g_cross_thread_bytes(0);
+static std::atomic<uint64_t> g_cross_thread_dropped_count(0);
+
+bool
+cross_thread_frees_recording_enabled() noexcept
+{
+  return g_cross_thread_frees_enabled.load(std::memory_order_relaxed);
+}
+
+static inline
+uint64_t
+pack(uint32_t high, uint32_t low) noexcept
+{
+  return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+/// Return the slot of the given pair, claiming and publishing it if new, or nullptr if full.
+static
+CrossThreadFreeSlot *
+get_or_create_cross_thread_free_slot(uint64_t stacks, uint64_t threads) noexcept
+{
+  uint64_t hash = (stacks ^ (threads * 0x9e3779b97f4a7c15ULL)) * 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  for (size_t probe = 0; probe < CROSS_THREAD_FREE_TABLE_CAPACITY; ++probe) {
+    CrossThreadFreeSlot & slot =
+      g_cross_thread_free_slots[(hash + probe) & (CROSS_THREAD_FREE_TABLE_CAPACITY - 1)];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    if (SLOT_EMPTY == state) {
+      if (slot.state.compare_exchange_strong(state, SLOT_CLAIMED, std::memory_order_acq_rel)) {
+        slot.stacks = stacks;
+        slot.threads = threads;
+        slot.state.store(SLOT_PUBLISHED, std::memory_order_release);
+        return &slot;
+      }
+      // lost the race for this slot, state now holds the winner's state
+    }
+    // wait for a concurrent insertion to be published, it may be the same pair
+    while (SLOT_CLAIMED == state) {
+      std::this_thread::yield();
+      state = slot.state.load(std::memory_order_acquire);
+    }
+    if (slot.stacks == stacks && slot.threads == threads) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void
+cross_thread_frees_record(
+  uint32_t allocation_stack_id,
+  uint32_t allocating_thread,
+  uint64_t size,
+  uint32_t free_stack_id) noexcept
+{
+  g_free_count.fetch_add(1, std::memory_order_relaxed);
+  const uint32_t freeing_thread = get_thread_index();
+  if (freeing_thread == allocating_thread) {
+    return;
+  }
+  g_cross_thread_free_count.fetch_add(1, std::memory_order_relaxed);
+  g_cross_thread_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (0 == free_stack_id) {
+    free_stack_id = capture_stack_id();
+  }
+  CrossThreadFreeSlot * slot = get_or_create_cross_thread_free_slot(
+    pack(allocation_stack_id, free_stack_id), pack(allocating_thread, freeing_thread));
+  if (nullptr == slot) {
+    g_cross_thread_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  slot->count.fetch_add(1, std::memory_order_relaxed);
+  slot->bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+bool
+enable_cross_thread_free_analysis()
+{
+  if (!create_live_allocation_table()) {
+    return false;
+  }
+  if (!g_cross_thread_frees_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+  return true;
+}
+
+void
+disable_cross_thread_free_analysis()
+{
+  if (g_cross_thread_frees_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+cross_thread_free_analysis_enabled()
+{
+  return cross_thread_frees_recording_enabled();
+}
+
+void
+reset_cross_thread_frees()
+{
+  // the pairs are kept, only their counters go back to zero
+  for (auto & slot : g_cross_thread_free_slots) {
+    slot.count.store(0, std::memory_order_relaxed);
+    slot.bytes.store(0, std::memory_order_relaxed);
+  }
+  g_free_count.store(0);
+  g_cross_thread_free_count.store(0);
+  g_cross_thread_bytes.store(0);
+  g_cross_thread_dropped_count.store(0);
+}
+
+uint32_t
+get_current_thread_index()
+{
+  return get_thread_index();
+}
+
+CrossThreadFreeTotals
+get_cross_thread_free_totals()
+{
+  return {
+    g_free_count.load(), g_cross_thread_free_count.load(), g_cross_thread_bytes.load(),
+    g_cross_thread_dropped_count.load()};
+}
+
+/// A non-empty pair with its stack ids.
+struct CollectedCrossThreadFrees
+{
+  uint32_t allocation_stack_id;
+  uint32_t free_stack_id;
+  CrossThreadFrees frees;
+};
+
+static
+std::vector<void *>
+get_stack_frames(uint32_t stack_id)
+{
+  void * const * frames = nullptr;
+  const size_t depth = get_interned_stack(stack_id, &frames);
+  return std::vector<void *>(frames, frames + depth);
+}
+
+/// Return the non-empty pairs, most frees first.
+static
+std::vector<CollectedCrossThreadFrees>
+collect_cross_thread_frees()
+{
+  std::vector<CollectedCrossThreadFrees> result;
+  for (const auto & slot : g_cross_thread_free_slots) {
+    if (SLOT_PUBLISHED != slot.state.load(std::memory_order_acquire)) {
+      continue;
+    }
+    const uint64_t count = slot.count.load(std::memory_order_relaxed);
+    if (0 == count) {
+      continue;
+    }
+    CollectedCrossThreadFrees collected;
+    collected.allocation_stack_id = static_cast<uint32_t>(slot.stacks >> 32);
+    collected.free_stack_id = static_cast<uint32_t>(slot.stacks);
+    collected.frees.allocation_stack = get_stack_frames(collected.allocation_stack_id);
+    collected.frees.free_stack = get_stack_frames(collected.free_stack_id);
+    collected.frees.allocating_thread = static_cast<uint32_t>(slot.threads >> 32);
+    collected.frees.freeing_thread = static_cast<uint32_t>(slot.threads);
+    collected.frees.count = count;
+    collected.frees.bytes = slot.bytes.load(std::memory_order_relaxed);
+    result.push_back(std::move(collected));
+  }
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const CollectedCrossThreadFrees & lhs, const CollectedCrossThreadFrees & rhs) {
+      return lhs.frees.count > rhs.frees.count;
+    });
+  return result;
+}
+
+std::vector<CrossThreadFrees>
+get_cross_thread_frees()
+{
+  std::vector<CrossThreadFrees> result;
+  for (auto & collected : collect_cross_thread_frees()) {
+    result.push_back(std::move(collected.frees));
+  }
+  return result;
+}
+
+std::string
+format_cross_thread_frees(size_t max_pairs)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const CrossThreadFreeTotals totals = get_cross_thread_free_totals();
+  const auto pairs = collect_cross_thread_frees();
+  std::ostringstream out;
+  out << totals.cross_thread_free_count << " of " << totals.free_count <<
+    " free(s) made by another thread than the allocating one, " << totals.cross_thread_bytes <<
+    " bytes\n";
+  for (size_t i = 0; i < pairs.size() && i < max_pairs; ++i) {
+    const CrossThreadFrees & frees = pairs[i].frees;
+    out << frees.count << " free(s), " << frees.bytes << " bytes, allocated by thread " <<
+      frees.allocating_thread << " and freed by thread " << frees.freeing_thread <<
+      ", allocated from:\n" <<
+      format_interned_stack(pairs[i].allocation_stack_id, REPORTED_FRAMES_MAX, "  ") <<
+      "freed from:\n" <<
+      format_interned_stack(pairs[i].free_stack_id, REPORTED_FRAMES_MAX, "  ");
+  }
+  if (pairs.size() > max_pairs) {
+    out << (pairs.size() - max_pairs) << " more pair(s)\n";
+  }
+  if (0 != totals.dropped_count) {
+    out << totals.dropped_count << " cross-thread free(s) did not fit in the table of pairs\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_cross_thread_frees_at_exit()
+{
+  disable_cross_thread_free_analysis();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_cross_thread_frees();
+  SAFE_FWRITE(stderr, "[memory_tools][INFO] cross-thread frees: ");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the cross-thread free analysis, if requested, when the library is loaded.
+static struct CrossThreadFreesInitializer
+{
+  CrossThreadFreesInitializer()
+  {
+    if (
+      environment_variable_is_enabled("MEMORY_TOOLS_CROSS_THREAD_FREES") &&
+      enable_cross_thread_free_analysis())
+    {
+      std::atexit(report_cross_thread_frees_at_exit);
+    }
+  }
+} g_cross_thread_frees_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,45 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__CROSS_THREAD_FREES_IMPL_HPP_
+#define MEMORY_TOOLS__CROSS_THREAD_FREES_IMPL_HPP_
+
+#include <cstdint>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if cross-thread frees are being counted, see enable_cross_thread_free_analysis().
+bool
+cross_thread_frees_recording_enabled() noexcept;
+
+/// Called by the live allocation table when this thread frees a known allocation.
+/**
+ * free_stack_id is the stack of the free if it was already captured, else 0
+ * and it is captured here when needed.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+void
+cross_thread_frees_record(
+  uint32_t allocation_stack_id,
+  uint32_t allocating_thread,
+  uint64_t size,
+  uint32_t free_stack_id) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__CROSS_THREAD_FREES_IMPL_HPP_
@@ -13,8 +13,8 @@
 // limitations under the License.
 
 #include <atomic>
-#include <cinttypes>
 #include <cstdlib>
+#include <stdexcept>
 
 #include "osrf_testing_tools_cpp/memory_tools/initialize.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/monitoring.hpp"
@@ -23,21 +23,182 @@
 #include "osrf_testing_tools_cpp/memory_tools/testing_helpers.hpp"
 #include "osrf_testing_tools_cpp/scope_exit.hpp"
 
-#include "./count_function_occurrences_in_backtrace.hpp"
+#include "./allocator_latency_impl.hpp"
 #include "./custom_memory_functions.hpp"
+#include "./event_log_impl.hpp"
 #include "./implementation_monitoring_override.hpp"
+#include "./live_allocation_table.hpp"
+#include "./memory_event.hpp"
+#include "./allocation_stats_impl.hpp"
 #include "./memory_tools_service_factory.hpp"
 #include "./print_backtrace.hpp"
+#include "./recursion_guard.hpp"
 
 namespace osrf_testing_tools_cpp
 {
 namespace memory_tools
 {
 
+// The recorded_* functions call the original and pass the operation to any enabled recorders.
+
+/// Return the time to start timing the original function from, or 0 if it is not timed.
+static inline
+uint64_t
+start_allocator_latency() noexcept
+{
+  return allocator_latency_recording_enabled() ? get_timestamp_ns() : 0;
+}
+
+/// Record the time spent in the original function since start_ns, if it was timed.
+static inline
+void
+stop_allocator_latency(
+  uint64_t start_ns,
+  MemoryFunctionType memory_function_type,
+  uint64_t size) noexcept
+{
+  if (0 != start_ns) {
+    allocator_latency_record(memory_function_type, size, get_timestamp_ns() - start_ns);
+  }
+}
+
+static inline
+void *
+recorded_malloc(size_t size, void * (*original_malloc)(size_t))
+{
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_malloc(size);
+  stop_allocator_latency(start_ns, MemoryFunctionType::Malloc, size);
+  if (memory_event_recording_enabled()) {
+    record_memory_event({MemoryFunctionType::Malloc, nullptr, 1, size, memory});
+  }
+  return memory;
+}
+
+static inline
+void *
+recorded_realloc(void * memory_in, size_t size, void * (*original_realloc)(void *, size_t))
+{
+  const bool recording = memory_event_recording_enabled();
+  // the usable size of memory_in can only be taken before it may be given back
+  const uint64_t memory_in_size = recording ? get_allocation_size(memory_in) : 0;
+  // and its live allocation entry removed, before another thread may get the same address
+  ErasedLiveAllocation realloc_claim {};
+  const bool claimed = recording && claim_live_allocation_for_realloc(memory_in, &realloc_claim);
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_realloc(memory_in, size);
+  stop_allocator_latency(start_ns, MemoryFunctionType::Realloc, size);
+  if (recording) {
+    record_memory_event(
+      {MemoryFunctionType::Realloc, memory_in, 1, size, memory, memory_in_size, 0,
+        claimed ? &realloc_claim : nullptr});
+  }
+  return memory;
+}
+
+static inline
+void *
+recorded_calloc(size_t count, size_t size, void * (*original_calloc)(size_t, size_t))
+{
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_calloc(count, size);
+  stop_allocator_latency(start_ns, MemoryFunctionType::Calloc, count * size);
+  if (memory_event_recording_enabled()) {
+    record_memory_event({MemoryFunctionType::Calloc, nullptr, count, size, memory});
+  }
+  return memory;
+}
+
+static inline
+void
+recorded_free(void * memory, void (*original_free)(void *))
+{
+  const bool recording = memory_event_recording_enabled();
+  // the usable size is only known before the block is given back, frees are classed by it
+  const uint64_t usable_size =
+    (recording || allocator_latency_recording_enabled()) ? get_allocation_size(memory) : 0;
+  // recorded first, once freed the address may be reused by another thread
+  if (recording) {
+    record_memory_event({MemoryFunctionType::Free, memory, 0, 0, nullptr, usable_size});
+  }
+  const uint64_t start_ns = start_allocator_latency();
+  original_free(memory);
+  stop_allocator_latency(start_ns, MemoryFunctionType::Free, usable_size);
+}
+
+static inline
+void *
+recorded_aligned_alloc(
+  size_t alignment,
+  size_t size,
+  void * (*original_aligned_alloc)(size_t, size_t))
+{
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_aligned_alloc(alignment, size);
+  stop_allocator_latency(start_ns, MemoryFunctionType::AlignedAlloc, size);
+  if (memory_event_recording_enabled()) {
+    record_memory_event({MemoryFunctionType::AlignedAlloc, nullptr, 1, size, memory});
+  }
+  return memory;
+}
+
+static inline
+void *
+recorded_operator_new(
+  size_t size,
+  size_t alignment,
+  void * (*original_aligned_alloc)(size_t, size_t))
+{
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_aligned_alloc(alignment, size);
+  stop_allocator_latency(start_ns, MemoryFunctionType::OperatorNew, size);
+  if (memory_event_recording_enabled()) {
+    record_memory_event({MemoryFunctionType::OperatorNew, nullptr, 1, size, memory});
+  }
+  return memory;
+}
+
+static inline
+void
+recorded_operator_delete(void * memory, size_t size, void (*original_free)(void *))
+{
+  const bool recording = memory_event_recording_enabled();
+  // the usable size is only known before the block is given back, frees are classed by it
+  const uint64_t usable_size =
+    (recording || allocator_latency_recording_enabled()) ? get_allocation_size(memory) : 0;
+  // recorded first, once freed the address may be reused by another thread
+  if (recording) {
+    record_memory_event(
+      {MemoryFunctionType::OperatorDelete, memory, 1, size, nullptr, usable_size});
+  }
+  const uint64_t start_ns = start_allocator_latency();
+  original_free(memory);
+  stop_allocator_latency(start_ns, MemoryFunctionType::OperatorDelete, usable_size);
+}
+
+static inline
+void *
+recorded_mapping_operation(
+  MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void * (*original_operation)(void *),
+  void * original_arguments)
+{
+  const uint64_t start_ns = start_allocator_latency();
+  void * memory = original_operation(original_arguments);
+  stop_allocator_latency(start_ns, memory_function_type, size);
+  if (memory_event_recording_enabled()) {
+    record_memory_event({memory_function_type, memory_in, 1, size, memory, memory_in_size});
+  }
+  return memory;
+}
+
 void *
 custom_malloc(size_t size) noexcept
 {
-  return custom_malloc_with_original(size, std::malloc, "malloc", true);
+  return custom_malloc_with_original(size, std::malloc, "malloc");
 }
 
 static inline
@@ -45,38 +206,38 @@ void *
 custom_malloc_with_original_except(
   size_t size,
   void * (*original_malloc)(size_t),
-  const char * replacement_malloc_function_name,
-  bool check_recursion)
+  const char * replacement_malloc_function_name)
 {
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_malloc(size);
+  }
   if (
-    // First check that we're initialized to avoid memory fucntions called in count function
     !osrf_testing_tools_cpp::memory_tools::initialized() ||
-    // we've recursed, use original directly to avoid infinite loop
-    (
-      check_recursion &&
-      count_function_occurrences_in_backtrace(custom_malloc_with_original_except) > 1
-    ) ||
     // monitoring not enabled, use original
     !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
   {
-    return original_malloc(size);
+    return recorded_malloc(size, original_malloc);
   }
 
   // prevent dynamic memory calls from within this function from being considered
   ScopedImplementationSection section;
 
   using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
-  MemoryToolsServiceFactory factory(MemoryFunctionType::Malloc, replacement_malloc_function_name);
+  MemoryToolsServiceFactory factory(
+    MemoryFunctionType::Malloc,
+    replacement_malloc_function_name,
+    size);
   osrf_testing_tools_cpp::memory_tools::dispatch_malloc(factory.get_memory_tools_service());
 
-  void * memory = original_malloc(size);
+  void * memory = recorded_malloc(size, original_malloc);
   if (!factory.should_ignore()) {
     using osrf_testing_tools_cpp::memory_tools::malloc_expected;
-    uint64_t fw_size = size;
-    MALLOC_PRINTF(
-      " malloc  (%s) %" PRIu64 " -> %p\n",
-      malloc_expected() ? "    expected" : "not expected", fw_size, memory);
+    log_memory_event({MemoryFunctionType::Malloc, malloc_expected(), nullptr, 1, size, memory});
     if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
       print_backtrace();
     }
   }
@@ -87,15 +248,13 @@ void *
 custom_malloc_with_original(
   size_t size,
   void * (*original_malloc)(size_t),
-  const char * replacement_malloc_function_name,
-  bool check_recursion) noexcept
+  const char * replacement_malloc_function_name) noexcept
 {
   try {
     return custom_malloc_with_original_except(
       size,
       original_malloc,
-      replacement_malloc_function_name,
-      check_recursion);
+      replacement_malloc_function_name);
   } catch (...) {
     fprintf(stderr, "unexpected error in custom malloc\n");
     return nullptr;
@@ -105,7 +264,7 @@ custom_malloc_with_original(
 void *
 custom_realloc(void * memory_in, size_t size) noexcept
 {
-  return custom_realloc_with_original(memory_in, size, std::realloc, "realloc", true);
+  return custom_realloc_with_original(memory_in, size, std::realloc, "realloc");
 }
 
 static inline
@@ -114,21 +273,20 @@ custom_realloc_with_original_except(
   void * memory_in,
   size_t size,
   void * (*original_realloc)(void *, size_t),
-  const char * replacement_realloc_function_name,
-  bool check_recursion)
+  const char * replacement_realloc_function_name)
 {
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_realloc(memory_in, size);
+  }
   if (
-    // First check that we're initialized to avoid memory fucntions called in count function
     !osrf_testing_tools_cpp::memory_tools::initialized() ||
-    // we've recursed, use original directly to avoid infinite loop
-    (
-      check_recursion &&
-      count_function_occurrences_in_backtrace(custom_realloc_with_original_except) > 1
-    ) ||
     // monitoring not enabled, use original
     !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
   {
-    return original_realloc(memory_in, size);
+    return recorded_realloc(memory_in, size, original_realloc);
   }
 
   // prevent dynamic memory calls from within this function from being considered
@@ -137,17 +295,17 @@ custom_realloc_with_original_except(
   using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
   MemoryToolsServiceFactory factory(
     MemoryFunctionType::Realloc,
-    replacement_realloc_function_name);
+    replacement_realloc_function_name,
+    size);
   osrf_testing_tools_cpp::memory_tools::dispatch_realloc(factory.get_memory_tools_service());
 
-  void * memory = original_realloc(memory_in, size);
+  void * memory = recorded_realloc(memory_in, size, original_realloc);
   if (!factory.should_ignore()) {
     using osrf_testing_tools_cpp::memory_tools::realloc_expected;
-    uint64_t fw_size = size;
-    MALLOC_PRINTF(
-      " realloc (%s) %p %" PRIu64 " -> %p\n",
-      realloc_expected() ? "    expected" : "not expected", memory_in, fw_size, memory);
+    log_memory_event(
+      {MemoryFunctionType::Realloc, realloc_expected(), memory_in, 1, size, memory});
     if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
       print_backtrace();
     }
   }
@@ -159,16 +317,14 @@ custom_realloc_with_original(
   void * memory_in,
   size_t size,
   void * (*original_realloc)(void *, size_t),
-  const char * replacement_realloc_function_name,
-  bool check_recursion) noexcept
+  const char * replacement_realloc_function_name) noexcept
 {
   try {
     return custom_realloc_with_original_except(
       memory_in,
       size,
       original_realloc,
-      replacement_realloc_function_name,
-      check_recursion);
+      replacement_realloc_function_name);
   } catch (...) {
     fprintf(stderr, "unexpected error in custom realloc\n");
     return nullptr;
@@ -178,7 +334,7 @@ custom_realloc_with_original(
 void *
 custom_calloc(size_t count, size_t size) noexcept
 {
-  return custom_calloc_with_original(count, size, std::calloc, "calloc", true);
+  return custom_calloc_with_original(count, size, std::calloc, "calloc");
 }
 
 static inline
@@ -187,40 +343,39 @@ custom_calloc_with_original_except(
   size_t count,
   size_t size,
   void * (*original_calloc)(size_t, size_t),
-  const char * replacement_calloc_function_name,
-  bool check_recursion)
+  const char * replacement_calloc_function_name)
 {
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_calloc(count, size);
+  }
   if (
-    // First check that we're initialized to avoid memory fucntions called in count function
     !osrf_testing_tools_cpp::memory_tools::initialized() ||
-    // we've recursed, use original directly to avoid infinite loop
-    (
-      check_recursion &&
-      count_function_occurrences_in_backtrace(custom_calloc_with_original_except) > 1
-    ) ||
     // monitoring not enabled, use original
     !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
   {
-    return original_calloc(count, size);
+    return recorded_calloc(count, size, original_calloc);
   }
 
   // prevent dynamic memory calls from within this function from being considered
   ScopedImplementationSection section;
 
   using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
-  MemoryToolsServiceFactory factory(MemoryFunctionType::Calloc, replacement_calloc_function_name);
+  MemoryToolsServiceFactory factory(
+    MemoryFunctionType::Calloc,
+    replacement_calloc_function_name,
+    count * size);
   osrf_testing_tools_cpp::memory_tools::dispatch_calloc(factory.get_memory_tools_service());
 
-  void * memory = original_calloc(count, size);
+  void * memory = recorded_calloc(count, size, original_calloc);
   if (!factory.should_ignore()) {
     using osrf_testing_tools_cpp::memory_tools::calloc_expected;
-    uint64_t fw_count = count;
-    uint64_t fw_size = size;
-    uint64_t fw_total = count * size;
-    MALLOC_PRINTF(
-      " calloc  (%s) %" PRIu64 " (%" PRIu64 " * %" PRIu64 ") -> %p\n",
-      calloc_expected() ? "    expected" : "not expected", fw_total, fw_count, fw_size, memory);
+    log_memory_event(
+      {MemoryFunctionType::Calloc, calloc_expected(), nullptr, count, size, memory});
     if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
       print_backtrace();
     }
   }
@@ -232,16 +387,14 @@ custom_calloc_with_original(
   size_t count,
   size_t size,
   void * (*original_calloc)(size_t, size_t),
-  const char * replacement_calloc_function_name,
-  bool check_recursion) noexcept
+  const char * replacement_calloc_function_name) noexcept
 {
   try {
     return custom_calloc_with_original_except(
       count,
       size,
       original_calloc,
-      replacement_calloc_function_name,
-      check_recursion);
+      replacement_calloc_function_name);
   } catch (...) {
     fprintf(stderr, "unexpected error in custom calloc\n");
     return nullptr;
@@ -251,7 +404,7 @@ custom_calloc_with_original(
 void
 custom_free(void * memory) noexcept
 {
-  custom_free_with_original(memory, std::free, "free", true);
+  custom_free_with_original(memory, std::free, "free");
 }
 
 static inline
@@ -259,21 +412,21 @@ void
 custom_free_with_original_except(
   void * memory,
   void (*original_free)(void *),
-  const char * replacement_free_function_name,
-  bool check_recursion)
+  const char * replacement_free_function_name)
 {
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    original_free(memory);
+    return;
+  }
   if (
-    // First check that we're initialized to avoid memory fucntions called in count function
     !osrf_testing_tools_cpp::memory_tools::initialized() ||
-    // we've recursed, use original directly to avoid infinite loop
-    (
-      check_recursion &&
-      count_function_occurrences_in_backtrace(custom_free_with_original_except) > 1
-    ) ||
     // monitoring not enabled, use original
     !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
   {
-    original_free(memory);
+    recorded_free(memory, original_free);
     return;
   }
 
@@ -284,35 +437,348 @@ custom_free_with_original_except(
   MemoryToolsServiceFactory factory(MemoryFunctionType::Free, replacement_free_function_name);
   osrf_testing_tools_cpp::memory_tools::dispatch_free(factory.get_memory_tools_service());
 
-  original_free(memory);
+  recorded_free(memory, original_free);
   if (!factory.should_ignore()) {
     using osrf_testing_tools_cpp::memory_tools::free_expected;
-    MALLOC_PRINTF(
-      " free    (%s) %p\n",
-      free_expected() ? "    expected" : "not expected", memory);
-  }
+    log_memory_event({MemoryFunctionType::Free, free_expected(), memory, 0, 0, nullptr});
     if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
       print_backtrace();
     }
+  }
 }
 
 void
 custom_free_with_original(
   void * memory,
   void (*original_free)(void *),
-  const char * replacement_free_function_name,
-  bool check_recursion) noexcept
+  const char * replacement_free_function_name) noexcept
 {
   try {
     custom_free_with_original_except(
       memory,
       original_free,
-      replacement_free_function_name,
-      check_recursion);
+      replacement_free_function_name);
   } catch (...) {
     fprintf(stderr, "unexpected error in custom free\n");
   }
 }
 
+static inline
+void *
+custom_aligned_alloc_with_original_except(
+  size_t alignment,
+  size_t size,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_aligned_alloc_function_name)
+{
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_aligned_alloc(alignment, size);
+  }
+  if (
+    !osrf_testing_tools_cpp::memory_tools::initialized() ||
+    // monitoring not enabled, use original
+    !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
+  {
+    return recorded_aligned_alloc(alignment, size, original_aligned_alloc);
+  }
+
+  // prevent dynamic memory calls from within this function from being considered
+  ScopedImplementationSection section;
+
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
+  MemoryToolsServiceFactory factory(
+    MemoryFunctionType::AlignedAlloc,
+    replacement_aligned_alloc_function_name,
+    size,
+    alignment);
+  osrf_testing_tools_cpp::memory_tools::dispatch_aligned_alloc(factory.get_memory_tools_service());
+
+  void * memory = recorded_aligned_alloc(alignment, size, original_aligned_alloc);
+  if (!factory.should_ignore()) {
+    using osrf_testing_tools_cpp::memory_tools::aligned_alloc_expected;
+    log_memory_event(
+      {MemoryFunctionType::AlignedAlloc, aligned_alloc_expected(), nullptr, 1, size, memory,
+        alignment});
+    if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
+      print_backtrace();
+    }
+  }
+  return memory;
+}
+
+void *
+custom_aligned_alloc_with_original(
+  size_t alignment,
+  size_t size,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_aligned_alloc_function_name) noexcept
+{
+  try {
+    return custom_aligned_alloc_with_original_except(
+      alignment,
+      size,
+      original_aligned_alloc,
+      replacement_aligned_alloc_function_name);
+  } catch (...) {
+    fprintf(stderr, "unexpected error in custom aligned alloc\n");
+    return nullptr;
+  }
+}
+
+static inline
+void *
+custom_operator_new_with_original_except(
+  size_t size,
+  size_t alignment,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_operator_new_function_name)
+{
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_aligned_alloc(alignment, size);
+  }
+  if (
+    !osrf_testing_tools_cpp::memory_tools::initialized() ||
+    // monitoring not enabled, use original
+    !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
+  {
+    return recorded_operator_new(size, alignment, original_aligned_alloc);
+  }
+
+  // prevent dynamic memory calls from within this function from being considered
+  ScopedImplementationSection section;
+
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
+  MemoryToolsServiceFactory factory(
+    MemoryFunctionType::OperatorNew,
+    replacement_operator_new_function_name,
+    size,
+    alignment);
+  osrf_testing_tools_cpp::memory_tools::dispatch_operator_new(factory.get_memory_tools_service());
+
+  void * memory = recorded_operator_new(size, alignment, original_aligned_alloc);
+  if (!factory.should_ignore()) {
+    // also unexpected if malloc is, see dispatch_operator_new()
+    const bool expected = operator_new_expected() && malloc_expected();
+    log_memory_event(
+      {MemoryFunctionType::OperatorNew, expected, nullptr, 1, size, memory, alignment});
+    if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
+      print_backtrace();
+    }
+  }
+  return memory;
+}
+
+void *
+custom_operator_new_with_original(
+  size_t size,
+  size_t alignment,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_operator_new_function_name) noexcept
+{
+  try {
+    return custom_operator_new_with_original_except(
+      size,
+      alignment,
+      original_aligned_alloc,
+      replacement_operator_new_function_name);
+  } catch (...) {
+    fprintf(stderr, "unexpected error in custom operator new\n");
+    return nullptr;
+  }
+}
+
+static inline
+void
+custom_operator_delete_with_original_except(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  void (*original_free)(void *),
+  const char * replacement_operator_delete_function_name)
+{
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    original_free(memory);
+    return;
+  }
+  if (
+    !osrf_testing_tools_cpp::memory_tools::initialized() ||
+    // monitoring not enabled, use original
+    !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
+  {
+    recorded_operator_delete(memory, size, original_free);
+    return;
+  }
+
+  // prevent dynamic memory calls from within this function from being considered
+  ScopedImplementationSection section;
+
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
+  MemoryToolsServiceFactory factory(
+    MemoryFunctionType::OperatorDelete,
+    replacement_operator_delete_function_name,
+    size,
+    alignment);
+  osrf_testing_tools_cpp::memory_tools::dispatch_operator_delete(
+    factory.get_memory_tools_service());
+
+  recorded_operator_delete(memory, size, original_free);
+  if (!factory.should_ignore()) {
+    // also unexpected if free is, see dispatch_operator_delete()
+    const bool expected = operator_delete_expected() && free_expected();
+    log_memory_event(
+      {MemoryFunctionType::OperatorDelete, expected, memory, 1, size, nullptr, alignment});
+    if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
+      print_backtrace();
+    }
+  }
+}
+
+void
+custom_operator_delete_with_original(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  void (*original_free)(void *),
+  const char * replacement_operator_delete_function_name) noexcept
+{
+  try {
+    custom_operator_delete_with_original_except(
+      memory,
+      size,
+      alignment,
+      original_free,
+      replacement_operator_delete_function_name);
+  } catch (...) {
+    fprintf(stderr, "unexpected error in custom operator delete\n");
+  }
+}
+
+static
+void
+dispatch_mapping_operation(MemoryToolsService & service)
+{
+  switch (service.get_memory_function_type()) {
+    case MemoryFunctionType::Mmap:
+      dispatch_mmap(service);
+      break;
+    case MemoryFunctionType::Mremap:
+      dispatch_mremap(service);
+      break;
+    case MemoryFunctionType::Munmap:
+      dispatch_munmap(service);
+      break;
+    case MemoryFunctionType::Brk:
+      dispatch_brk(service);
+      break;
+    default:
+      throw std::logic_error("unexpected memory function type for a mapping operation");
+  }
+}
+
+static
+bool
+mapping_operation_expected(MemoryFunctionType memory_function_type)
+{
+  switch (memory_function_type) {
+    case MemoryFunctionType::Mmap:
+      return mmap_expected();
+    case MemoryFunctionType::Mremap:
+      return mremap_expected();
+    case MemoryFunctionType::Munmap:
+      return munmap_expected();
+    case MemoryFunctionType::Brk:
+      return brk_expected();
+    default:
+      throw std::logic_error("unexpected memory function type for a mapping operation");
+  }
+}
+
+static inline
+void *
+custom_mapping_operation_with_original_except(
+  MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void * (*original_operation)(void *),
+  void * original_arguments,
+  const char * replacement_function_name)
+{
+  // any memory function called from here on in this thread goes to the original
+  ScopedRecursionGuard recursion_guard;
+  if (recursion_guard.recursed()) {
+    // we've recursed, use original directly to avoid infinite loop
+    return original_operation(original_arguments);
+  }
+  if (
+    !osrf_testing_tools_cpp::memory_tools::initialized() ||
+    // monitoring not enabled, use original
+    !osrf_testing_tools_cpp::memory_tools::monitoring_enabled())
+  {
+    return recorded_mapping_operation(
+      memory_function_type, memory_in, memory_in_size, size, original_operation,
+      original_arguments);
+  }
+
+  // prevent dynamic memory calls from within this function from being considered
+  ScopedImplementationSection section;
+
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsServiceFactory;
+  MemoryToolsServiceFactory factory(memory_function_type, replacement_function_name, size);
+  dispatch_mapping_operation(factory.get_memory_tools_service());
+
+  void * memory = recorded_mapping_operation(
+    memory_function_type, memory_in, memory_in_size, size, original_operation,
+    original_arguments);
+  if (!factory.should_ignore()) {
+    log_memory_event(
+      {memory_function_type, mapping_operation_expected(memory_function_type), memory_in, 1,
+        size, memory});
+    if (factory.should_print_backtrace()) {
+      flush_thread_event_log();
+      print_backtrace();
+    }
+  }
+  return memory;
+}
+
+void *
+custom_mapping_operation_with_original(
+  MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void * (*original_operation)(void *),
+  void * original_arguments,
+  const char * replacement_function_name) noexcept
+{
+  try {
+    return custom_mapping_operation_with_original_except(
+      memory_function_type,
+      memory_in,
+      memory_in_size,
+      size,
+      original_operation,
+      original_arguments,
+      replacement_function_name);
+  } catch (...) {
+    fprintf(stderr, "unexpected error in custom %s\n", replacement_function_name);
+    return nullptr;
+  }
+}
+
 }  // namespace memory_tools
 }  // namespace osrf_testing_tools_cpp
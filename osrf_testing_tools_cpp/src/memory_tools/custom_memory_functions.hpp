@@ -19,13 +19,7 @@
 #include <cstring>
 
 #include "./safe_fwrite.hpp"
-
-#if defined(__APPLE__)
-#include <malloc/malloc.h>
-#define MALLOC_PRINTF malloc_printf
-#else  // defined(__APPLE__)
-#define MALLOC_PRINTF printf
-#endif  // defined(__APPLE__)
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
 
 namespace osrf_testing_tools_cpp
 {
@@ -39,8 +33,7 @@ void *
 custom_malloc_with_original(
   size_t size,
   void * (*original_malloc)(size_t),
-  const char * replacement_malloc_function_name,
-  bool check_recursion) noexcept;
+  const char * replacement_malloc_function_name) noexcept;
 
 void *
 custom_realloc(void * memory_in, size_t size) noexcept;
@@ -50,8 +43,7 @@ custom_realloc_with_original(
   void * memory_in,
   size_t size,
   void * (*original_realloc)(void *, size_t),
-  const char * replacement_realloc_function_name,
-  bool check_recursion) noexcept;
+  const char * replacement_realloc_function_name) noexcept;
 
 void *
 custom_calloc(size_t count, size_t size) noexcept;
@@ -61,8 +53,7 @@ custom_calloc_with_original(
   size_t count,
   size_t size,
   void * (*original_calloc)(size_t, size_t),
-  const char * replacement_calloc_function_name,
-  bool check_recursion) noexcept;
+  const char * replacement_calloc_function_name) noexcept;
 
 void
 custom_free(void * memory) noexcept;
@@ -71,8 +62,62 @@ void
 custom_free_with_original(
   void * memory,
   void (*original_free)(void *),
-  const char * replacement_free_function_name,
-  bool check_recursion) noexcept;
+  const char * replacement_free_function_name) noexcept;
+
+/// Aligned allocation, with original_aligned_alloc taking the alignment and then the size.
+/**
+ * Used for all of the aligned allocation functions, posix_memalign(),
+ * aligned_alloc(), memalign(), valloc() and pvalloc(), whose originals are
+ * adapted to this signature by the caller.
+ */
+void *
+custom_aligned_alloc_with_original(
+  size_t alignment,
+  size_t size,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_aligned_alloc_function_name) noexcept;
+
+/// Allocation for operator new, alignment is 0 unless a std::align_val_t was given.
+/**
+ * Only the allocation itself, the caller is responsible for the new handler
+ * and for throwing std::bad_alloc.
+ */
+void *
+custom_operator_new_with_original(
+  size_t size,
+  size_t alignment,
+  void * (*original_aligned_alloc)(size_t, size_t),
+  const char * replacement_operator_new_function_name) noexcept;
+
+/// Deallocation for operator delete, size and alignment are 0 unless given to the overload.
+void
+custom_operator_delete_with_original(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  void (*original_free)(void *),
+  const char * replacement_operator_delete_function_name) noexcept;
+
+/// Change of the memory mappings or of the program break, e.g. MemoryFunctionType::Mmap.
+/**
+ * The signatures of mmap(), munmap() and so on have little in common, so the
+ * caller packs the arguments and the result of the original in a structure of
+ * its own, and original_operation does the operation on it, returning the
+ * memory it mapped or nullptr.
+ *
+ * \param memory_in the memory unmapped or remapped, otherwise nullptr
+ * \param memory_in_size the number of bytes unmapped, remapped from or given back by brk
+ * \param size the number of bytes mapped, unmapped or remapped to
+ */
+void *
+custom_mapping_operation_with_original(
+  MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void * (*original_operation)(void *),
+  void * original_arguments,
+  const char * replacement_function_name) noexcept;
 
 }  // namespace memory_tools
 }  // namespace osrf_testing_tools_cpp
@@ -24,6 +24,11 @@ namespace osrf_testing_tools_cpp
 namespace memory_tools
 {
 
+/// Call the given callback, if it is set.
+/**
+ * The caller keeps the callback alive, hooks registered with on_malloc() and
+ * friends are only deleted once no dispatch can still be using them.
+ */
 inline
 void
 dispatch_callback(
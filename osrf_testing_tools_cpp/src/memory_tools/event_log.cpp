@@ -0,0 +1,388 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "./event_log_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./implementation_monitoring_override.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/event_log.hpp"
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define MALLOC_PRINTF malloc_printf
+#else  // defined(__APPLE__)
+#define MALLOC_PRINTF printf
+#endif  // defined(__APPLE__)
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Must be a power of two.
+static constexpr uint64_t EVENT_LOG_BUFFER_CAPACITY = 2048;
+
+/// Single producer, single consumer ring buffer of events for one thread.
+/**
+ * Only the owning thread writes records and advances head, and only whoever
+ * holds the draining flag reads records and advances tail.
+ * Buffers are never freed, when their thread exits they are released and
+ * may be claimed by a new thread.
+ */
+struct EventLogBuffer
+{
+  EventLogRecord records[EVENT_LOG_BUFFER_CAPACITY];
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  // only written by the owning thread, so it does not need to be a read-modify-write
+  std::atomic<uint64_t> dropped{0};
+  std::atomic_flag draining = ATOMIC_FLAG_INIT;
+  std::atomic<bool> owned{true};
+  EventLogBuffer * next = nullptr;
+};
+
+static
+EventLogOverflowPolicy
+get_event_log_overflow_policy_from_env()
+{
+  char value[16];
+  if (!get_environment_variable("MEMORY_TOOLS_EVENT_LOG_POLICY", value, sizeof(value))) {
+    return EventLogOverflowPolicy::drop;
+  }
+  if (0 == std::strncmp("drop", value, 4) || 0 == std::strncmp("DROP", value, 4)) {
+    return EventLogOverflowPolicy::drop;
+  }
+  if (0 == std::strncmp("block", value, 5) || 0 == std::strncmp("BLOCK", value, 5)) {
+    return EventLogOverflowPolicy::block;
+  }
+  SAFE_FWRITE(stderr, "[memory_tools][WARN] Given MEMORY_TOOLS_EVENT_LOG_POLICY=");
+  SAFE_FWRITE(stderr, value);
+  SAFE_FWRITE(stderr, " but that is not one of {drop, block}, using drop.\n");
+  return EventLogOverflowPolicy::drop;
+}
+
+static
+bool
+get_event_log_drain_thread_enabled_from_env()
+{
+  char value[16];
+  if (!get_environment_variable("MEMORY_TOOLS_EVENT_LOG_DRAIN", value, sizeof(value))) {
+    return true;
+  }
+  if (0 == std::strncmp("thread", value, 6) || 0 == std::strncmp("THREAD", value, 6)) {
+    return true;
+  }
+  if (0 == std::strncmp("exit", value, 4) || 0 == std::strncmp("EXIT", value, 4)) {
+    return false;
+  }
+  SAFE_FWRITE(stderr, "[memory_tools][WARN] Given MEMORY_TOOLS_EVENT_LOG_DRAIN=");
+  SAFE_FWRITE(stderr, value);
+  SAFE_FWRITE(stderr, " but that is not one of {thread, exit}, using thread.\n");
+  return true;
+}
+
+static std::atomic<EventLogOverflowPolicy> g_overflow_policy(
+  get_event_log_overflow_policy_from_env());
+static std::atomic<EventLogBuffer *> g_buffers(nullptr);
+// events from threads which could not get a buffer, e.g. while exiting
+static std::atomic<uint64_t> g_dropped_without_buffer(0);
+
+static thread_local EventLogBuffer * g_tls_buffer = nullptr;
+static thread_local bool g_tls_buffer_released = false;
+
+/// Releases the calling thread's buffer on thread exit, see get_thread_buffer().
+struct ThreadEventLogBufferReleaser
+{
+  ~ThreadEventLogBufferReleaser()
+  {
+    if (nullptr != g_tls_buffer) {
+      g_tls_buffer->owned.store(false, std::memory_order_release);
+    }
+    g_tls_buffer = nullptr;
+    g_tls_buffer_released = true;
+  }
+};
+
+static
+EventLogBuffer *
+get_thread_buffer() noexcept
+{
+  if (nullptr != g_tls_buffer) {
+    return g_tls_buffer;
+  }
+  if (g_tls_buffer_released) {
+    // this thread is exiting, do not claim another buffer which would never be released
+    return nullptr;
+  }
+  // reuse a buffer released by an exited thread if possible
+  for (EventLogBuffer * buffer = g_buffers.load(); nullptr != buffer; buffer = buffer->next) {
+    bool owned = false;
+    if (buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+      g_tls_buffer = buffer;
+      break;
+    }
+  }
+  if (nullptr == g_tls_buffer) {
+    EventLogBuffer * buffer = new (std::nothrow) EventLogBuffer;
+    if (nullptr == buffer) {
+      return nullptr;
+    }
+    buffer->next = g_buffers.load();
+    while (!g_buffers.compare_exchange_weak(buffer->next, buffer)) {}
+    g_tls_buffer = buffer;
+  }
+  // registers the releaser for this thread on first use
+  static thread_local ThreadEventLogBufferReleaser releaser;
+  (void)&releaser;
+  return g_tls_buffer;
+}
+
+static
+void
+print_record(const EventLogRecord & record)
+{
+  const char * expected = record.expected ? "    expected" : "not expected";
+  switch (record.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+      MALLOC_PRINTF(
+        " malloc  (%s) %" PRIu64 " -> %p\n",
+        expected, record.size, record.memory_out);
+      break;
+    case MemoryFunctionType::Realloc:
+      MALLOC_PRINTF(
+        " realloc (%s) %p %" PRIu64 " -> %p\n",
+        expected, record.memory_in, record.size, record.memory_out);
+      break;
+    case MemoryFunctionType::Calloc:
+      MALLOC_PRINTF(
+        " calloc  (%s) %" PRIu64 " (%" PRIu64 " * %" PRIu64 ") -> %p\n",
+        expected, record.count * record.size, record.count, record.size, record.memory_out);
+      break;
+    case MemoryFunctionType::Free:
+      MALLOC_PRINTF(
+        " free    (%s) %p\n",
+        expected, record.memory_in);
+      break;
+    case MemoryFunctionType::AlignedAlloc:
+      MALLOC_PRINTF(
+        " aligned (%s) %" PRIu64 " (align %" PRIu64 ") -> %p\n",
+        expected, record.size, record.alignment, record.memory_out);
+      break;
+    case MemoryFunctionType::OperatorNew:
+      MALLOC_PRINTF(
+        " new     (%s) %" PRIu64 " (align %" PRIu64 ") -> %p\n",
+        expected, record.size, record.alignment, record.memory_out);
+      break;
+    case MemoryFunctionType::OperatorDelete:
+      MALLOC_PRINTF(
+        " delete  (%s) %p %" PRIu64 " (align %" PRIu64 ")\n",
+        expected, record.memory_in, record.size, record.alignment);
+      break;
+    case MemoryFunctionType::Mmap:
+      MALLOC_PRINTF(
+        " mmap    (%s) %" PRIu64 " -> %p\n",
+        expected, record.size, record.memory_out);
+      break;
+    case MemoryFunctionType::Mremap:
+      MALLOC_PRINTF(
+        " mremap  (%s) %p %" PRIu64 " -> %p\n",
+        expected, record.memory_in, record.size, record.memory_out);
+      break;
+    case MemoryFunctionType::Munmap:
+      MALLOC_PRINTF(
+        " munmap  (%s) %p %" PRIu64 "\n",
+        expected, record.memory_in, record.size);
+      break;
+    case MemoryFunctionType::Brk:
+      MALLOC_PRINTF(
+        " brk     (%s) %p %" PRIu64 " -> %p\n",
+        expected, record.memory_in, record.size, record.memory_out);
+      break;
+    default:
+      MALLOC_PRINTF(" unknown memory event\n");
+      break;
+  }
+}
+
+static
+bool
+try_drain_buffer(EventLogBuffer * buffer) noexcept
+{
+  if (buffer->draining.test_and_set(std::memory_order_acquire)) {
+    return false;
+  }
+  uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+  const uint64_t head = buffer->head.load(std::memory_order_acquire);
+  for (; tail != head; ++tail) {
+    print_record(buffer->records[tail & (EVENT_LOG_BUFFER_CAPACITY - 1)]);
+  }
+  buffer->tail.store(tail, std::memory_order_release);
+  buffer->draining.clear(std::memory_order_release);
+  return true;
+}
+
+static
+void
+drain_buffer(EventLogBuffer * buffer) noexcept
+{
+  while (!try_drain_buffer(buffer)) {
+    std::this_thread::yield();
+  }
+}
+
+/// Drain all buffers, the caller must hold a ScopedRecursionGuard.
+static
+void
+drain_all_buffers() noexcept
+{
+  for (EventLogBuffer * buffer = g_buffers.load(); nullptr != buffer; buffer = buffer->next) {
+    drain_buffer(buffer);
+  }
+  fflush(stdout);
+}
+
+void
+log_memory_event(const EventLogRecord & record) noexcept
+{
+  EventLogBuffer * buffer = get_thread_buffer();
+  if (nullptr == buffer) {
+    g_dropped_without_buffer++;
+    return;
+  }
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  while (head - buffer->tail.load(std::memory_order_acquire) >= EVENT_LOG_BUFFER_CAPACITY) {
+    if (EventLogOverflowPolicy::drop == g_overflow_policy.load(std::memory_order_relaxed)) {
+      buffer->dropped.store(
+        buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return;
+    }
+    // block, but make progress even without a drain thread by draining it here
+    if (!try_drain_buffer(buffer)) {
+      std::this_thread::yield();
+    }
+  }
+  buffer->records[head & (EVENT_LOG_BUFFER_CAPACITY - 1)] = record;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void
+flush_thread_event_log() noexcept
+{
+  if (nullptr != g_tls_buffer) {
+    drain_buffer(g_tls_buffer);
+    fflush(stdout);
+  }
+}
+
+static std::mutex g_drain_thread_mutex;
+static std::thread * g_drain_thread = nullptr;
+static std::atomic<bool> g_drain_thread_should_stop(false);
+
+static
+void
+drain_thread_main()
+{
+  // nothing this thread does should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  while (!g_drain_thread_should_stop.load()) {
+    drain_all_buffers();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+static
+void
+stop_event_log_drain_at_exit()
+{
+  stop_event_log_drain();
+}
+
+void
+start_event_log_drain()
+{
+  static const bool drain_thread_enabled = get_event_log_drain_thread_enabled_from_env();
+  // prevents the thread creation from triggering existing hooks
+  ScopedImplementationSection implementation_section;
+  std::lock_guard<std::mutex> lock(g_drain_thread_mutex);
+  static bool registered_at_exit = false;
+  if (!registered_at_exit) {
+    // flushes even if the drain thread is not used
+    std::atexit(stop_event_log_drain_at_exit);
+    registered_at_exit = true;
+  }
+  if (!drain_thread_enabled || nullptr != g_drain_thread) {
+    return;
+  }
+  g_drain_thread_should_stop.store(false);
+  g_drain_thread = new std::thread(drain_thread_main);
+}
+
+void
+stop_event_log_drain()
+{
+  ScopedImplementationSection implementation_section;
+  {
+    std::lock_guard<std::mutex> lock(g_drain_thread_mutex);
+    if (nullptr != g_drain_thread) {
+      g_drain_thread_should_stop.store(true);
+      g_drain_thread->join();
+      delete g_drain_thread;
+      g_drain_thread = nullptr;
+    }
+  }
+  flush_event_log();
+}
+
+EventLogOverflowPolicy
+get_event_log_overflow_policy()
+{
+  return g_overflow_policy.load();
+}
+
+EventLogOverflowPolicy
+set_event_log_overflow_policy(EventLogOverflowPolicy policy)
+{
+  return g_overflow_policy.exchange(policy);
+}
+
+void
+flush_event_log()
+{
+  ScopedRecursionGuard recursion_guard;
+  drain_all_buffers();
+}
+
+uint64_t
+get_dropped_event_count()
+{
+  uint64_t dropped = g_dropped_without_buffer.load();
+  for (EventLogBuffer * buffer = g_buffers.load(); nullptr != buffer; buffer = buffer->next) {
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,64 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__EVENT_LOG_IMPL_HPP_
+#define MEMORY_TOOLS__EVENT_LOG_IMPL_HPP_
+
+#include <cstdint>
+
+#include "osrf_testing_tools_cpp/memory_tools/event_log.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Fixed size record of a memory operation, formatted only when drained.
+struct EventLogRecord
+{
+  MemoryFunctionType memory_function_type;
+  bool expected;
+  void * memory_in;
+  uint64_t count;
+  uint64_t size;
+  void * memory_out;
+  uint64_t alignment = 0;
+};
+
+/// Record an event in the calling thread's buffer, never blocks under the drop policy.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+log_memory_event(const EventLogRecord & record) noexcept;
+
+/// Write out the events logged by the calling thread so far.
+/**
+ * Used before printing a backtrace synchronously, so that the backtrace
+ * follows the log line of the event it belongs to.
+ */
+void
+flush_thread_event_log() noexcept;
+
+/// Start the background drain thread, if configured and not already running.
+void
+start_event_log_drain();
+
+/// Stop the background drain thread, if running, and flush all buffers.
+void
+stop_event_log_drain();
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__EVENT_LOG_IMPL_HPP_
@@ -0,0 +1,69 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__GET_ENVIRONMENT_VARIABLE_HPP_
+#define MEMORY_TOOLS__GET_ENVIRONMENT_VARIABLE_HPP_
+
+#include <cstdlib>
+#include <cstring>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Copy the value of an environment variable into buffer, return false if unset or empty.
+/**
+ * The value is truncated to fit buffer, which is always null terminated.
+ * Does not allocate, so it can be used during static initialization, before
+ * the original memory functions are known.
+ */
+inline
+bool
+get_environment_variable(const char * name, char * buffer, size_t buffer_size)
+{
+  if (0 == buffer_size) {
+    return false;
+  }
+  buffer[0] = '\0';
+#if !defined(_WIN32)
+  const char * value = std::getenv(name);
+  if (!value) {
+    return false;
+  }
+  strncpy(buffer, value, buffer_size - 1);
+  buffer[buffer_size - 1] = '\0';
+#else
+  size_t size_of_value = 0;
+  errno_t my_errno = getenv_s(&size_of_value, buffer, buffer_size, name);
+  if (0 != my_errno && ERANGE != my_errno) {
+    return false;
+  }
+#endif
+  return '\0' != buffer[0];
+}
+
+/// Return true if the environment variable is set to 1, which enables a feature at load time.
+inline
+bool
+environment_variable_is_enabled(const char * name)
+{
+  char value[8];
+  return get_environment_variable(name, value, sizeof(value)) && 0 == std::strcmp("1", value);
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__GET_ENVIRONMENT_VARIABLE_HPP_
@@ -0,0 +1,518 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./heap_profile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "osrf_testing_tools_cpp/memory_tools/heap_profile.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+#include "./symbol_cache_impl.hpp"
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static std::atomic<bool> g_heap_profile_enabled(false);
+
+static std::atomic<uint64_t> g_heap_profile_sample_rate(0);
+
+// Counts are kept in fractions of an allocation, since each sample stands for a fraction more.
+static constexpr uint64_t HEAP_PROFILE_COUNT_UNIT = 1 << 16;
+
+// Indexed by stack id, 0 being the unknown stack, the sampled allocations scaled up when recorded.
+static std::atomic<uint64_t> g_heap_profile_counts[STACK_TABLE_CAPACITY + 1];
+static std::atomic<uint64_t> g_heap_profile_bytes[STACK_TABLE_CAPACITY + 1];
+
+bool
+heap_profile_enabled() noexcept
+{
+  return g_heap_profile_enabled.load(std::memory_order_relaxed);
+}
+
+bool
+heap_profile_records_every_allocation() noexcept
+{
+  return heap_profile_enabled() && 0 == g_heap_profile_sample_rate.load(std::memory_order_relaxed);
+}
+
+/// Bytes this thread may still allocate before the next sample, see should_sample().
+static thread_local int64_t g_tls_bytes_until_sample = 0;
+static thread_local uint64_t g_tls_sampler_state = 0;
+
+/// Draw the number of bytes until the next sample, exponentially distributed around rate.
+static
+int64_t
+next_sample_distance(uint64_t rate) noexcept
+{
+  if (0 == g_tls_sampler_state) {
+    // every thread samples differently, the state must never be 0 again
+    g_tls_sampler_state =
+      (get_timestamp_ns() ^ (static_cast<uint64_t>(get_thread_index()) << 32)) | 1;
+  }
+  // xorshift64*, the top 53 bits make a uniform double in (0, 1]
+  g_tls_sampler_state ^= g_tls_sampler_state >> 12;
+  g_tls_sampler_state ^= g_tls_sampler_state << 25;
+  g_tls_sampler_state ^= g_tls_sampler_state >> 27;
+  const uint64_t random = (g_tls_sampler_state * 0x2545F4914F6CDD1DULL) >> 11;
+  const double uniform = static_cast<double>(random + 1) / static_cast<double>(1ULL << 53);
+  return static_cast<int64_t>(-std::log(uniform) * static_cast<double>(rate)) + 1;
+}
+
+/// Return true if an allocation of the given size is sampled.
+static
+bool
+should_sample(uint64_t size) noexcept
+{
+  const uint64_t rate = g_heap_profile_sample_rate.load(std::memory_order_relaxed);
+  if (0 == rate) {
+    return true;
+  }
+  if (0 == g_tls_sampler_state) {
+    // the first allocation of a thread is not more likely to be sampled than the others
+    g_tls_bytes_until_sample = next_sample_distance(rate);
+  }
+  g_tls_bytes_until_sample -= static_cast<int64_t>(size);
+  if (g_tls_bytes_until_sample > 0) {
+    return false;
+  }
+  g_tls_bytes_until_sample = next_sample_distance(rate);
+  return true;
+}
+
+/// Return the number of allocations of the given size a sample of it stands for.
+/**
+ * An allocation of size bytes is sampled with probability 1 - exp(-size / rate),
+ * so scaling each sample by the inverse, as pprof does, gives unbiased totals
+ * even for call stacks which allocate very different sizes.
+ */
+static
+double
+get_sample_weight(uint64_t size) noexcept
+{
+  const uint64_t rate = g_heap_profile_sample_rate.load(std::memory_order_relaxed);
+  if (0 == rate) {
+    return 1.0;
+  }
+  return 1.0 / (1.0 - std::exp(-static_cast<double>(size) / static_cast<double>(rate)));
+}
+
+void
+heap_profile_record(const MemoryEvent & event) noexcept
+{
+  switch (event.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+    case MemoryFunctionType::Realloc:
+    case MemoryFunctionType::Calloc:
+    case MemoryFunctionType::AlignedAlloc:
+    case MemoryFunctionType::OperatorNew:
+      break;
+    default:
+      return;
+  }
+  // a failed allocation, or realloc(memory_in, 0) freeing memory_in, allocated nothing
+  if (nullptr == event.memory_out || 0 == event.size) {
+    return;
+  }
+  const uint64_t size = event.count * event.size;
+  if (!should_sample(size)) {
+    return;
+  }
+  // only the sampled allocations are unwound, unless another recorder needed the stack
+  const uint32_t stack_id = event.stack_id_captured ? event.stack_id : capture_stack_id();
+  const double weight = get_sample_weight(size);
+  g_heap_profile_counts[stack_id].fetch_add(
+    static_cast<uint64_t>(std::llround(weight * HEAP_PROFILE_COUNT_UNIT)),
+    std::memory_order_relaxed);
+  g_heap_profile_bytes[stack_id].fetch_add(
+    static_cast<uint64_t>(std::llround(weight * static_cast<double>(size))),
+    std::memory_order_relaxed);
+}
+
+void
+enable_heap_profiling()
+{
+  if (!g_heap_profile_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+}
+
+void
+disable_heap_profiling()
+{
+  if (g_heap_profile_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+heap_profiling_enabled()
+{
+  return heap_profile_enabled();
+}
+
+void
+reset_heap_profile()
+{
+  for (size_t stack_id = 0; stack_id <= STACK_TABLE_CAPACITY; ++stack_id) {
+    g_heap_profile_counts[stack_id].store(0, std::memory_order_relaxed);
+    g_heap_profile_bytes[stack_id].store(0, std::memory_order_relaxed);
+  }
+}
+
+void
+set_heap_profile_sample_rate(uint64_t bytes)
+{
+  g_heap_profile_sample_rate.store(bytes);
+}
+
+uint64_t
+get_heap_profile_sample_rate()
+{
+  return g_heap_profile_sample_rate.load();
+}
+
+namespace
+{
+
+/// A symbolized frame, as given in both formats.
+struct HeapProfileFrame
+{
+  void * address;
+  std::string function;
+  std::string filename;
+  uint64_t line;
+};
+
+/// The counters of a call stack which allocated, with its frames innermost first.
+struct HeapProfileSample
+{
+  uint64_t count;
+  uint64_t bytes;
+  std::vector<HeapProfileFrame> frames;
+};
+
+/// Minimal protobuf encoder, enough for the messages of profile.proto.
+class ProtobufWriter
+{
+public:
+  void
+  write_varint(uint64_t value)
+  {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(value));
+  }
+
+  void
+  write_uint64(uint32_t field, uint64_t value)
+  {
+    write_varint(static_cast<uint64_t>(field) << 3);
+    write_varint(value);
+  }
+
+  void
+  write_bytes(uint32_t field, const std::string & value)
+  {
+    write_varint((static_cast<uint64_t>(field) << 3) | 2);
+    write_varint(value.size());
+    buffer_ += value;
+  }
+
+  void
+  write_message(uint32_t field, const ProtobufWriter & message)
+  {
+    write_bytes(field, message.buffer_);
+  }
+
+  void
+  write_packed(uint32_t field, const std::vector<uint64_t> & values)
+  {
+    ProtobufWriter packed;
+    for (uint64_t value : values) {
+      packed.write_varint(value);
+    }
+    write_message(field, packed);
+  }
+
+  const std::string &
+  str() const
+  {
+    return buffer_;
+  }
+
+private:
+  std::string buffer_;
+};
+
+}  // namespace
+
+bool
+get_heap_profile_totals(uint32_t stack_id, uint64_t * count, uint64_t * bytes) noexcept
+{
+  // the samples were already scaled up when recorded
+  const uint64_t count_units = g_heap_profile_counts[stack_id].load(std::memory_order_relaxed);
+  if (0 == count_units) {
+    return false;
+  }
+  *count = (count_units + HEAP_PROFILE_COUNT_UNIT / 2) / HEAP_PROFILE_COUNT_UNIT;
+  *bytes = g_heap_profile_bytes[stack_id].load(std::memory_order_relaxed);
+  return true;
+}
+
+static
+std::vector<HeapProfileSample>
+collect_heap_profile_samples()
+{
+  std::vector<HeapProfileSample> samples;
+  for (uint32_t stack_id = 0; stack_id <= STACK_TABLE_CAPACITY; ++stack_id) {
+    HeapProfileSample sample {0, 0, {}};
+    if (!get_heap_profile_totals(stack_id, &sample.count, &sample.bytes)) {
+      continue;
+    }
+    void * const * frames = nullptr;
+    const size_t depth = get_interned_stack(stack_id, &frames);
+    if (0 == depth) {
+      sample.frames.push_back({nullptr, "<unknown stack>", "", 0});
+      samples.push_back(std::move(sample));
+      continue;
+    }
+#if !defined(_WIN32) && !defined(__ANDROID__)
+    for (const auto & resolved : resolve_frames(frames, depth)) {
+      HeapProfileFrame frame {resolved.addr, resolved.source.function, resolved.source.filename,
+        resolved.source.line};
+      if (frame.function.empty()) {
+        frame.function = resolved.object_function;
+        frame.filename = resolved.object_filename;
+      }
+      sample.frames.push_back(std::move(frame));
+    }
+#else
+    for (size_t i = 0; i < depth; ++i) {
+      sample.frames.push_back({frames[i], "", "", 0});
+    }
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+    for (auto & frame : sample.frames) {
+      // unsymbolized frames are told apart by their address
+      if (frame.function.empty()) {
+        std::ostringstream address;
+        address << frame.address;
+        frame.function = address.str();
+      }
+    }
+    samples.push_back(std::move(sample));
+  }
+  // the biggest call stacks first, which is also how pprof lists them
+  std::sort(
+    samples.begin(), samples.end(),
+    [](const HeapProfileSample & lhs, const HeapProfileSample & rhs) {
+      return lhs.bytes > rhs.bytes;
+    });
+  return samples;
+}
+
+static
+std::string
+format_heap_profile_collapsed(const std::vector<HeapProfileSample> & samples)
+{
+  std::ostringstream out;
+  for (const auto & sample : samples) {
+    for (auto frame = sample.frames.rbegin(); frame != sample.frames.rend(); ++frame) {
+      if (frame != sample.frames.rbegin()) {
+        out << ';';
+      }
+      // frames are separated by ;, so it must not appear in a name
+      std::string function = frame->function;
+      std::replace(function.begin(), function.end(), ';', ':');
+      out << function;
+    }
+    out << ' ' << sample.bytes << '\n';
+  }
+  return out.str();
+}
+
+static
+std::string
+format_heap_profile_pprof(const std::vector<HeapProfileSample> & samples)
+{
+  // field numbers of profile.proto
+  enum : uint32_t
+  {
+    PROFILE_SAMPLE_TYPE = 1, PROFILE_SAMPLE = 2, PROFILE_LOCATION = 4, PROFILE_FUNCTION = 5,
+    PROFILE_STRING_TABLE = 6, PROFILE_TIME_NANOS = 9, PROFILE_PERIOD_TYPE = 11,
+    PROFILE_PERIOD = 12, PROFILE_DEFAULT_SAMPLE_TYPE = 14,
+    VALUE_TYPE_TYPE = 1, VALUE_TYPE_UNIT = 2,
+    SAMPLE_LOCATION_ID = 1, SAMPLE_VALUE = 2,
+    LOCATION_ID = 1, LOCATION_ADDRESS = 3, LOCATION_LINE = 4,
+    LINE_FUNCTION_ID = 1, LINE_LINE = 2,
+    FUNCTION_ID = 1, FUNCTION_NAME = 2, FUNCTION_SYSTEM_NAME = 3, FUNCTION_FILENAME = 4,
+  };
+
+  std::vector<std::string> strings;
+  std::map<std::string, uint64_t> string_ids;
+  auto intern_string = [&strings, &string_ids](const std::string & value) {
+      auto inserted = string_ids.emplace(value, strings.size());
+      if (inserted.second) {
+        strings.push_back(value);
+      }
+      return inserted.first->second;
+    };
+  // the first string must be the empty string
+  intern_string("");
+
+  ProtobufWriter profile;
+  auto write_value_type = [&profile, &intern_string](
+    uint32_t field, const char * type, const char * unit) {
+      ProtobufWriter value_type;
+      value_type.write_uint64(VALUE_TYPE_TYPE, intern_string(type));
+      value_type.write_uint64(VALUE_TYPE_UNIT, intern_string(unit));
+      profile.write_message(field, value_type);
+    };
+  write_value_type(PROFILE_SAMPLE_TYPE, "alloc_objects", "count");
+  write_value_type(PROFILE_SAMPLE_TYPE, "alloc_space", "bytes");
+
+  // a location per frame address and a function per name, both shared between samples
+  std::map<std::pair<std::string, std::string>, uint64_t> function_ids;
+  std::map<std::pair<void *, std::string>, uint64_t> location_ids;
+  for (const auto & sample : samples) {
+    std::vector<uint64_t> sample_location_ids;
+    for (const auto & frame : sample.frames) {
+      auto function = function_ids.emplace(
+        std::make_pair(frame.function, frame.filename), function_ids.size() + 1);
+      if (function.second) {
+        ProtobufWriter function_message;
+        function_message.write_uint64(FUNCTION_ID, function.first->second);
+        function_message.write_uint64(FUNCTION_NAME, intern_string(frame.function));
+        function_message.write_uint64(FUNCTION_SYSTEM_NAME, intern_string(frame.function));
+        function_message.write_uint64(FUNCTION_FILENAME, intern_string(frame.filename));
+        profile.write_message(PROFILE_FUNCTION, function_message);
+      }
+      auto location = location_ids.emplace(
+        std::make_pair(frame.address, frame.function), location_ids.size() + 1);
+      if (location.second) {
+        ProtobufWriter line;
+        line.write_uint64(LINE_FUNCTION_ID, function.first->second);
+        line.write_uint64(LINE_LINE, frame.line);
+        ProtobufWriter location_message;
+        location_message.write_uint64(LOCATION_ID, location.first->second);
+        location_message.write_uint64(
+          LOCATION_ADDRESS, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(frame.address)));
+        location_message.write_message(LOCATION_LINE, line);
+        profile.write_message(PROFILE_LOCATION, location_message);
+      }
+      sample_location_ids.push_back(location.first->second);
+    }
+    ProtobufWriter sample_message;
+    sample_message.write_packed(SAMPLE_LOCATION_ID, sample_location_ids);
+    sample_message.write_packed(SAMPLE_VALUE, {sample.count, sample.bytes});
+    profile.write_message(PROFILE_SAMPLE, sample_message);
+  }
+
+  profile.write_uint64(
+    PROFILE_TIME_NANOS, static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+  write_value_type(PROFILE_PERIOD_TYPE, "space", "bytes");
+  profile.write_uint64(PROFILE_PERIOD, std::max<uint64_t>(1, get_heap_profile_sample_rate()));
+  profile.write_uint64(PROFILE_DEFAULT_SAMPLE_TYPE, intern_string("alloc_space"));
+  // written last, every string is interned by now
+  for (const auto & value : strings) {
+    profile.write_bytes(PROFILE_STRING_TABLE, value);
+  }
+  return profile.str();
+}
+
+bool
+write_heap_profile(const std::string & path, HeapProfileFormat format)
+{
+  // symbolizing the stacks allocates, which should not be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::vector<HeapProfileSample> samples = collect_heap_profile_samples();
+  const std::string content = (HeapProfileFormat::pprof == format) ?
+    format_heap_profile_pprof(samples) :
+    format_heap_profile_collapsed(samples);
+  FILE * out = fopen(path.c_str(), (HeapProfileFormat::pprof == format) ? "wb" : "w");
+  if (nullptr == out) {
+    return false;
+  }
+  const bool written = content.size() == fwrite(content.data(), 1, content.size(), out);
+  return 0 == fclose(out) && written;
+}
+
+static char g_heap_profile_path_prefix[4096];
+
+static
+void
+write_heap_profile_at_exit()
+{
+  disable_heap_profiling();
+  const std::string prefix(g_heap_profile_path_prefix);
+  if (
+    !write_heap_profile(prefix + ".pb", HeapProfileFormat::pprof) ||
+    !write_heap_profile(prefix + ".collapsed", HeapProfileFormat::collapsed))
+  {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to write MEMORY_TOOLS_HEAP_PROFILE=");
+    SAFE_FWRITE(stderr, g_heap_profile_path_prefix);
+    SAFE_FWRITE(stderr, "\n");
+  }
+}
+
+/// Enables heap profiling, if requested, when the library is loaded.
+static struct HeapProfileInitializer
+{
+  HeapProfileInitializer()
+  {
+    char sample_rate[32];
+    if (
+      get_environment_variable(
+        "MEMORY_TOOLS_HEAP_PROFILE_SAMPLE_RATE", sample_rate, sizeof(sample_rate)))
+    {
+      set_heap_profile_sample_rate(std::strtoull(sample_rate, nullptr, 10));
+    }
+    if (
+      get_environment_variable(
+        "MEMORY_TOOLS_HEAP_PROFILE", g_heap_profile_path_prefix,
+        sizeof(g_heap_profile_path_prefix)) &&
+      '\0' != g_heap_profile_path_prefix[0])
+    {
+      enable_heap_profiling();
+      std::atexit(write_heap_profile_at_exit);
+    }
+  }
+} g_heap_profile_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,48 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__HEAP_PROFILE_HPP_
+#define MEMORY_TOOLS__HEAP_PROFILE_HPP_
+
+#include <cstdint>
+
+#include "./memory_event.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if heap allocations are being counted, see enable_heap_profiling().
+bool
+heap_profile_enabled() noexcept;
+
+/// Return true if every heap allocation is counted, not sampled, so each one needs its stack.
+bool
+heap_profile_records_every_allocation() noexcept;
+
+/// Add the given event to the counters of its call stack, if it is a heap allocation.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+heap_profile_record(const MemoryEvent & event) noexcept;
+
+/// Get the allocations counted for a call stack, scaled up if they were sampled.
+/** Returns false, with count and bytes unset, if none were counted. */
+bool
+get_heap_profile_totals(uint32_t stack_id, uint64_t * count, uint64_t * bytes) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__HEAP_PROFILE_HPP_
@@ -15,9 +15,13 @@
 #if defined(__APPLE__)
 
 #include <cstdlib>
+#include <unistd.h>
 
+#include "../interposition_armed.hpp"
 #include "./unix_common.hpp"
 
+using osrf_testing_tools_cpp::memory_tools::interposition_armed;
+
 // Pulled from:
 //  https://github.com/emeryberger/Heap-Layers/blob/
 //    076e9e7ef53b66380b159e40473b930f25cc353b/wrappers/macinterpose.h
@@ -45,31 +49,83 @@ extern "C"
 void *
 apple_replacement_malloc(size_t size)
 {
+  if (!interposition_armed()) {
+    return malloc(size);
+  }
   return unix_replacement_malloc(size, malloc);
 }
 
 void *
 apple_replacement_realloc(void * memory_in, size_t size)
 {
+  if (!interposition_armed()) {
+    return realloc(memory_in, size);
+  }
   return unix_replacement_realloc(memory_in, size, realloc);
 }
 
 void *
 apple_replacement_calloc(size_t count, size_t size)
 {
+  if (!interposition_armed()) {
+    return calloc(count, size);
+  }
   return unix_replacement_calloc(count, size, calloc);
 }
 
 void
 apple_replacement_free(void * memory)
 {
+  if (!interposition_armed()) {
+    return free(memory);
+  }
   return unix_replacement_free(memory, free);
 }
 
+// adapt valloc to the signature of the other aligned allocation functions
+static
+void *
+call_original_valloc(size_t alignment, size_t size)
+{
+  (void)alignment;
+  return valloc(size);
+}
+
+int
+apple_replacement_posix_memalign(void ** memory_out, size_t alignment, size_t size)
+{
+  if (!interposition_armed()) {
+    return posix_memalign(memory_out, alignment, size);
+  }
+  return unix_replacement_posix_memalign(memory_out, alignment, size, posix_memalign);
+}
+
+void *
+apple_replacement_aligned_alloc(size_t alignment, size_t size)
+{
+  if (!interposition_armed()) {
+    return aligned_alloc(alignment, size);
+  }
+  return unix_replacement_aligned_alloc(alignment, size, aligned_alloc, "aligned_alloc");
+}
+
+void *
+apple_replacement_valloc(size_t size)
+{
+  if (!interposition_armed()) {
+    return valloc(size);
+  }
+  return unix_replacement_aligned_alloc(
+    static_cast<size_t>(getpagesize()), size, call_original_valloc, "valloc");
+}
+
 OSX_INTERPOSE(apple_replacement_malloc, malloc);
 OSX_INTERPOSE(apple_replacement_realloc, realloc);
 OSX_INTERPOSE(apple_replacement_calloc, calloc);
 OSX_INTERPOSE(apple_replacement_free, free);
+OSX_INTERPOSE(apple_replacement_posix_memalign, posix_memalign);
+OSX_INTERPOSE(apple_replacement_aligned_alloc, aligned_alloc);
+OSX_INTERPOSE(apple_replacement_valloc, valloc);
 
 }  // extern "C"
 
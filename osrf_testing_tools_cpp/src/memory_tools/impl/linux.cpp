@@ -14,13 +14,28 @@
 
 #if defined(__linux__)
 
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <dlfcn.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <new>
+
+#include "../get_environment_variable.hpp"
+#include "../interposition_armed.hpp"
 #include "./static_allocator.hpp"
 #include "./unix_common.hpp"
 
+using osrf_testing_tools_cpp::memory_tools::interposition_armed;
+using osrf_testing_tools_cpp::memory_tools::MemoryFunctionType;
+
 template<typename FunctionPointerT>
 FunctionPointerT
 find_original_function(const char * name)
@@ -70,6 +85,71 @@ static CallocSignature g_original_calloc = nullptr;
 using FreeSignature = void (*)(void *);
 static FreeSignature g_original_free = nullptr;
 
+// storage for the original aligned allocation functions
+using PosixMemalignSignature = int (*)(void **, size_t, size_t);
+static PosixMemalignSignature g_original_posix_memalign = nullptr;
+using AlignedAllocSignature = void * (*)(size_t, size_t);
+static AlignedAllocSignature g_original_aligned_alloc = nullptr;
+static AlignedAllocSignature g_original_memalign = nullptr;
+using VallocSignature = void * (*)(size_t);
+static VallocSignature g_original_valloc = nullptr;
+static VallocSignature g_original_pvalloc = nullptr;
+
+// adapt valloc and pvalloc to the signature of the other aligned allocation functions,
+// the alignment they are given is always the page size
+
+static void *
+call_original_valloc(size_t alignment, size_t size)
+{
+  (void)alignment;
+  return g_original_valloc(size);
+}
+
+static void *
+call_original_pvalloc(size_t alignment, size_t size)
+{
+  (void)alignment;
+  return g_original_pvalloc(size);
+}
+
+static size_t
+get_page_size()
+{
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// storage for the original memory mapping functions, which are found by the constructor, or on
+// first use if that comes first, because unlike malloc they cannot be served by the static
+// allocator until then, atomic as the first use may be in several threads at once
+using MmapSignature = void * (*)(void *, size_t, int, int, int, off_t);
+static std::atomic<MmapSignature> g_original_mmap(nullptr);
+using Mmap64Signature = void * (*)(void *, size_t, int, int, int, off64_t);
+static std::atomic<Mmap64Signature> g_original_mmap64(nullptr);
+using MremapSignature = void * (*)(void *, size_t, size_t, int, ...);
+static std::atomic<MremapSignature> g_original_mremap(nullptr);
+using MunmapSignature = int (*)(void *, size_t);
+static std::atomic<MunmapSignature> g_original_munmap(nullptr);
+using BrkSignature = int (*)(void *);
+static std::atomic<BrkSignature> g_original_brk(nullptr);
+using SbrkSignature = void * (*)(intptr_t);
+static std::atomic<SbrkSignature> g_original_sbrk(nullptr);
+
+// the memory mapping functions are only reported if MEMORY_TOOLS_TRACK_MMAP is set
+static bool g_track_mmap = false;
+
+template<typename FunctionPointerT>
+static FunctionPointerT
+get_original_function(std::atomic<FunctionPointerT> & original_function, const char * name)
+{
+  FunctionPointerT function = original_function.load(std::memory_order_acquire);
+  if (nullptr == function) {
+    // threads racing here all find the same function, so any of them may store it
+    function = find_original_function<FunctionPointerT>(name);
+    original_function.store(function, std::memory_order_release);
+  }
+  return function;
+}
+
 // on shared library load, find and store the original memory function locations
 static __attribute__((constructor)) void __linux_memory_tools_init(void)
 {
@@ -77,6 +157,23 @@ static __attribute__((constructor)) void __linux_memory_tools_init(void)
   g_original_realloc = find_original_function<ReallocSignature>("realloc");
   g_original_calloc = find_original_function<CallocSignature>("calloc");
   g_original_free = find_original_function<FreeSignature>("free");
+  g_original_posix_memalign = find_original_function<PosixMemalignSignature>("posix_memalign");
+  g_original_aligned_alloc = find_original_function<AlignedAllocSignature>("aligned_alloc");
+  g_original_memalign = find_original_function<AlignedAllocSignature>("memalign");
+  g_original_valloc = find_original_function<VallocSignature>("valloc");
+  g_original_pvalloc = find_original_function<VallocSignature>("pvalloc");
+  get_original_function(g_original_mmap, "mmap");
+  get_original_function(g_original_mmap64, "mmap64");
+  get_original_function(g_original_mremap, "mremap");
+  get_original_function(g_original_munmap, "munmap");
+  get_original_function(g_original_brk, "brk");
+  get_original_function(g_original_sbrk, "sbrk");
+
+  char track_mmap[8];
+  g_track_mmap =
+    osrf_testing_tools_cpp::memory_tools::get_environment_variable(
+    "MEMORY_TOOLS_TRACK_MMAP", track_mmap, sizeof(track_mmap)) &&
+    0 != strcmp("0", track_mmap);
 
   complete_static_initialization();
 }
@@ -90,6 +187,10 @@ malloc(size_t size) noexcept
   if (!get_static_initialization_complete()) {
     return get_static_allocator()->allocate(size);
   }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_malloc(size);
+  }
   return unix_replacement_malloc(size, g_original_malloc);
 }
 
@@ -99,6 +200,10 @@ realloc(void * pointer, size_t size) noexcept
   if (!get_static_initialization_complete()) {
     return get_static_allocator()->reallocate(pointer, size);
   }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_realloc(pointer, size);
+  }
   return unix_replacement_realloc(pointer, size, g_original_realloc);
 }
 
@@ -108,6 +213,10 @@ calloc(size_t count, size_t size) noexcept
   if (!get_static_initialization_complete()) {
     return get_static_allocator()->zero_allocate(count, size);
   }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_calloc(count, size);
+  }
   return unix_replacement_calloc(count, size, g_original_calloc);
 }
 
@@ -119,9 +228,532 @@ free(void * pointer) noexcept
     // memory was originally allocated by static allocator, no need to pass to "real" free
     return;
   }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_free(pointer);
+  }
   unix_replacement_free(pointer, g_original_free);
 }
 
+int
+posix_memalign(void ** memory_out, size_t alignment, size_t size) noexcept
+{
+  if (!get_static_initialization_complete()) {
+    void * memory = get_static_allocator()->aligned_allocate(alignment, size);
+    if (nullptr == memory) {
+      return ENOMEM;
+    }
+    *memory_out = memory;
+    return 0;
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_posix_memalign(memory_out, alignment, size);
+  }
+  return unix_replacement_posix_memalign(memory_out, alignment, size, g_original_posix_memalign);
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size) noexcept
+{
+  if (!get_static_initialization_complete()) {
+    return get_static_allocator()->aligned_allocate(alignment, size);
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_aligned_alloc(alignment, size);
+  }
+  return unix_replacement_aligned_alloc(
+    alignment, size, g_original_aligned_alloc, "aligned_alloc");
+}
+
+void *
+memalign(size_t alignment, size_t size) noexcept
+{
+  if (!get_static_initialization_complete()) {
+    return get_static_allocator()->aligned_allocate(alignment, size);
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_memalign(alignment, size);
+  }
+  return unix_replacement_aligned_alloc(alignment, size, g_original_memalign, "memalign");
+}
+
+void *
+valloc(size_t size) noexcept
+{
+  if (!get_static_initialization_complete()) {
+    return get_static_allocator()->aligned_allocate(get_page_size(), size);
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_valloc(size);
+  }
+  return unix_replacement_aligned_alloc(get_page_size(), size, call_original_valloc, "valloc");
+}
+
+void *
+pvalloc(size_t size) noexcept
+{
+  const size_t page_size = get_page_size();
+  if (!get_static_initialization_complete()) {
+    // pvalloc rounds the size up to a multiple of the page size
+    return get_static_allocator()->aligned_allocate(
+      page_size, osrf_testing_tools_cpp::memory_tools::impl::align_up(size, page_size));
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_pvalloc(size);
+  }
+  return unix_replacement_aligned_alloc(page_size, size, call_original_pvalloc, "pvalloc");
+}
+
 }  // extern "C"
 
+// The memory mapping functions are reported through unix_replacement_mapping_operation(), which
+// takes their arguments packed in one of these structures, along with a function which calls
+// the original on them.
+// The original's errno is kept in the structure and restored last, as reporting may change it.
+
+struct MmapArguments
+{
+  void * address;
+  size_t length;
+  int protection;
+  int flags;
+  int file_descriptor;
+  off64_t offset;
+  bool is_mmap64;
+  void * result;
+  int error;
+};
+
+static void *
+call_original_mmap(void * arguments_in)
+{
+  auto arguments = static_cast<MmapArguments *>(arguments_in);
+  if (arguments->is_mmap64) {
+    arguments->result = get_original_function(g_original_mmap64, "mmap64")(
+      arguments->address, arguments->length, arguments->protection, arguments->flags,
+      arguments->file_descriptor, arguments->offset);
+  } else {
+    arguments->result = get_original_function(g_original_mmap, "mmap")(
+      arguments->address, arguments->length, arguments->protection, arguments->flags,
+      arguments->file_descriptor, static_cast<off_t>(arguments->offset));
+  }
+  arguments->error = errno;
+  return (MAP_FAILED == arguments->result) ? nullptr : arguments->result;
+}
+
+struct MremapArguments
+{
+  void * old_address;
+  size_t old_size;
+  size_t new_size;
+  int flags;
+  void * new_address;
+  void * result;
+  int error;
+};
+
+static void *
+call_original_mremap(void * arguments_in)
+{
+  auto arguments = static_cast<MremapArguments *>(arguments_in);
+  arguments->result = get_original_function(g_original_mremap, "mremap")(
+    arguments->old_address, arguments->old_size, arguments->new_size, arguments->flags,
+    arguments->new_address);
+  arguments->error = errno;
+  return (MAP_FAILED == arguments->result) ? nullptr : arguments->result;
+}
+
+struct MunmapArguments
+{
+  void * address;
+  size_t length;
+  int result;
+  int error;
+};
+
+static void *
+call_original_munmap(void * arguments_in)
+{
+  auto arguments = static_cast<MunmapArguments *>(arguments_in);
+  arguments->result = get_original_function(g_original_munmap, "munmap")(
+    arguments->address, arguments->length);
+  arguments->error = errno;
+  return nullptr;
+}
+
+struct BrkArguments
+{
+  void * address;
+  int result;
+  int error;
+};
+
+static void *
+call_original_brk(void * arguments_in)
+{
+  auto arguments = static_cast<BrkArguments *>(arguments_in);
+  arguments->result = get_original_function(g_original_brk, "brk")(arguments->address);
+  arguments->error = errno;
+  return (0 == arguments->result) ? arguments->address : nullptr;
+}
+
+struct SbrkArguments
+{
+  intptr_t increment;
+  void * result;
+  int error;
+};
+
+static void *
+call_original_sbrk(void * arguments_in)
+{
+  auto arguments = static_cast<SbrkArguments *>(arguments_in);
+  arguments->result = get_original_function(g_original_sbrk, "sbrk")(arguments->increment);
+  arguments->error = errno;
+  if (reinterpret_cast<void *>(-1) == arguments->result) {
+    return nullptr;
+  }
+  // the new program break
+  return static_cast<uint8_t *>(arguments->result) + arguments->increment;
+}
+
+template<typename ArgumentsT>
+static void
+perform_mapping_operation(
+  MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void *(*call_original)(void *),
+  ArgumentsT & arguments,
+  const char * function_name)
+{
+  if (!g_track_mmap || !interposition_armed()) {
+    // nothing to do, go straight to the original
+    call_original(&arguments);
+  } else {
+    unix_replacement_mapping_operation(
+      memory_function_type, memory_in, memory_in_size, size, call_original, &arguments,
+      function_name);
+  }
+  errno = arguments.error;
+}
+
+// Return the program break before brk() or sbrk() changes it, only needed if they are reported.
+static void *
+get_program_break_if_tracked()
+{
+  return g_track_mmap ? get_original_function(g_original_sbrk, "sbrk")(0) : nullptr;
+}
+
+static size_t
+get_program_break_growth(void * old_program_break, void * new_program_break)
+{
+  const uintptr_t old_address = reinterpret_cast<uintptr_t>(old_program_break);
+  const uintptr_t new_address = reinterpret_cast<uintptr_t>(new_program_break);
+  return (new_address > old_address) ? new_address - old_address : 0;
+}
+
+extern "C"
+{
+
+#if !defined(__USE_FILE_OFFSET64)
+// otherwise mmap is an alias of mmap64
+
+void *
+mmap(
+  void * address,
+  size_t length,
+  int protection,
+  int flags,
+  int file_descriptor,
+  off_t offset) noexcept
+{
+  MmapArguments arguments {
+    address, length, protection, flags, file_descriptor, offset, false, MAP_FAILED, ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Mmap, nullptr, 0, length, call_original_mmap, arguments, "mmap");
+  return arguments.result;
+}
+
+#endif  // !defined(__USE_FILE_OFFSET64)
+
+void *
+mmap64(
+  void * address,
+  size_t length,
+  int protection,
+  int flags,
+  int file_descriptor,
+  off64_t offset) noexcept
+{
+  MmapArguments arguments {
+    address, length, protection, flags, file_descriptor, offset, true, MAP_FAILED, ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Mmap, nullptr, 0, length, call_original_mmap, arguments, "mmap64");
+  return arguments.result;
+}
+
+void *
+mremap(void * old_address, size_t old_size, size_t new_size, int flags, ...) noexcept
+{
+  void * new_address = nullptr;
+  if (0 != (flags & MREMAP_FIXED)) {
+    va_list variadic_arguments;
+    va_start(variadic_arguments, flags);
+    new_address = va_arg(variadic_arguments, void *);
+    va_end(variadic_arguments);
+  }
+  MremapArguments arguments {
+    old_address, old_size, new_size, flags, new_address, MAP_FAILED, ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Mremap, old_address, old_size, new_size, call_original_mremap, arguments,
+    "mremap");
+  return arguments.result;
+}
+
+int
+munmap(void * address, size_t length) noexcept
+{
+  MunmapArguments arguments {address, length, -1, ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Munmap, address, length, length, call_original_munmap, arguments,
+    "munmap");
+  return arguments.result;
+}
+
+int
+brk(void * address) noexcept
+{
+  void * program_break = get_program_break_if_tracked();
+  BrkArguments arguments {address, -1, ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Brk, program_break, get_program_break_growth(address, program_break),
+    get_program_break_growth(program_break, address), call_original_brk, arguments, "brk");
+  return arguments.result;
+}
+
+void *
+sbrk(intptr_t increment) noexcept
+{
+  void * program_break = get_program_break_if_tracked();
+  SbrkArguments arguments {increment, reinterpret_cast<void *>(-1), ENOMEM};
+  perform_mapping_operation(
+    MemoryFunctionType::Brk, program_break,
+    (increment < 0) ? static_cast<size_t>(-increment) : 0,
+    (increment > 0) ? static_cast<size_t>(increment) : 0,
+    call_original_sbrk, arguments, "sbrk");
+  return arguments.result;
+}
+
+}  // extern "C"
+
+// Every global operator new and operator delete is replaced too, so that C++ allocations are
+// reported as such, rather than as the malloc they may or may not end up in.
+
+static void *
+call_original_malloc_with_alignment(size_t alignment, size_t size)
+{
+  if (alignment <= osrf_testing_tools_cpp::memory_tools::impl::MAX_ALIGN) {
+    return g_original_malloc(size);
+  }
+  void * memory = nullptr;
+  if (0 != g_original_posix_memalign(&memory, alignment, size)) {
+    return nullptr;
+  }
+  return memory;
+}
+
+static void *
+operator_new_allocate(size_t size, size_t alignment, const char * function_name)
+{
+  if (!get_static_initialization_complete()) {
+    if (0 == alignment) {
+      return get_static_allocator()->allocate(size);
+    }
+    return get_static_allocator()->aligned_allocate(alignment, size);
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return call_original_malloc_with_alignment(alignment, size);
+  }
+  return unix_replacement_operator_new(
+    size, alignment, call_original_malloc_with_alignment, function_name);
+}
+
+static void *
+operator_new_impl(size_t size, size_t alignment, const char * function_name)
+{
+  // like the default operator new, a size of 0 still gets a unique pointer
+  if (0 == size) {
+    size = 1;
+  }
+  while (true) {
+    void * memory = operator_new_allocate(size, alignment, function_name);
+    if (nullptr != memory) {
+      return memory;
+    }
+    std::new_handler new_handler = std::get_new_handler();
+    if (nullptr == new_handler) {
+      throw std::bad_alloc();
+    }
+    new_handler();
+  }
+}
+
+static void *
+operator_new_nothrow_impl(size_t size, size_t alignment, const char * function_name) noexcept
+{
+  try {
+    return operator_new_impl(size, alignment, function_name);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+static void
+operator_delete_impl(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  const char * function_name) noexcept
+{
+  if (nullptr == memory || get_static_allocator()->deallocate(memory)) {
+    // delete of nullptr or,
+    // memory was originally allocated by static allocator, no need to pass to "real" free
+    return;
+  }
+  if (!interposition_armed()) {
+    // nothing to do, go straight to the original
+    return g_original_free(memory);
+  }
+  // the size given to sized delete is passed along, rather than looked up
+  unix_replacement_operator_delete(memory, size, alignment, g_original_free, function_name);
+}
+
+void *
+operator new(size_t size)
+{
+  return operator_new_impl(size, 0, "operator new");
+}
+
+void *
+operator new[](size_t size)
+{
+  return operator_new_impl(size, 0, "operator new[]");
+}
+
+void *
+operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return operator_new_nothrow_impl(size, 0, "operator new");
+}
+
+void *
+operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return operator_new_nothrow_impl(size, 0, "operator new[]");
+}
+
+void *
+operator new(size_t size, std::align_val_t alignment)
+{
+  return operator_new_impl(size, static_cast<size_t>(alignment), "operator new");
+}
+
+void *
+operator new[](size_t size, std::align_val_t alignment)
+{
+  return operator_new_impl(size, static_cast<size_t>(alignment), "operator new[]");
+}
+
+void *
+operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return operator_new_nothrow_impl(size, static_cast<size_t>(alignment), "operator new");
+}
+
+void *
+operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return operator_new_nothrow_impl(size, static_cast<size_t>(alignment), "operator new[]");
+}
+
+void
+operator delete(void * memory) noexcept
+{
+  operator_delete_impl(memory, 0, 0, "operator delete");
+}
+
+void
+operator delete[](void * memory) noexcept
+{
+  operator_delete_impl(memory, 0, 0, "operator delete[]");
+}
+
+void
+operator delete(void * memory, const std::nothrow_t &) noexcept
+{
+  operator_delete_impl(memory, 0, 0, "operator delete");
+}
+
+void
+operator delete[](void * memory, const std::nothrow_t &) noexcept
+{
+  operator_delete_impl(memory, 0, 0, "operator delete[]");
+}
+
+void
+operator delete(void * memory, size_t size) noexcept
+{
+  operator_delete_impl(memory, size, 0, "operator delete");
+}
+
+void
+operator delete[](void * memory, size_t size) noexcept
+{
+  operator_delete_impl(memory, size, 0, "operator delete[]");
+}
+
+void
+operator delete(void * memory, std::align_val_t alignment) noexcept
+{
+  operator_delete_impl(memory, 0, static_cast<size_t>(alignment), "operator delete");
+}
+
+void
+operator delete[](void * memory, std::align_val_t alignment) noexcept
+{
+  operator_delete_impl(memory, 0, static_cast<size_t>(alignment), "operator delete[]");
+}
+
+void
+operator delete(void * memory, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  operator_delete_impl(memory, 0, static_cast<size_t>(alignment), "operator delete");
+}
+
+void
+operator delete[](void * memory, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  operator_delete_impl(memory, 0, static_cast<size_t>(alignment), "operator delete[]");
+}
+
+void
+operator delete(void * memory, size_t size, std::align_val_t alignment) noexcept
+{
+  operator_delete_impl(memory, size, static_cast<size_t>(alignment), "operator delete");
+}
+
+void
+operator delete[](void * memory, size_t size, std::align_val_t alignment) noexcept
+{
+  operator_delete_impl(memory, size, static_cast<size_t>(alignment), "operator delete[]");
+}
+
 #endif  // defined(__linux__)
@@ -69,6 +69,30 @@ public:
     return nullptr;
   }
 
+  /// Allocate with an alignment which is a power of two, possibly bigger than MAX_ALIGN.
+  void *
+  aligned_allocate(size_t alignment, size_t size)
+  {
+    if (0 == alignment || 0 != (alignment & (alignment - 1))) {
+      SAFE_FWRITE(stderr, "StackAllocator.aligned_allocate() -> nullptr, bad alignment\n");
+      return nullptr;
+    }
+    if (alignment < MAX_ALIGN) {
+      alignment = MAX_ALIGN;
+    }
+    // the padding needed to align the stack pointer is wasted, like any freed memory
+    const uintptr_t address = reinterpret_cast<uintptr_t>(stack_pointer_);
+    const size_t padding = align_up(address, alignment) - address;
+    const size_t aligned_size = padding + align_up(size, MAX_ALIGN);
+    if (aligned_size <= static_cast<size_t>(std::distance(stack_pointer_, end_))) {
+      uint8_t * result = stack_pointer_ + padding;
+      stack_pointer_ += aligned_size;
+      return result;
+    }
+    SAFE_FWRITE(stderr, "StackAllocator.aligned_allocate() -> nullptr\n");
+    return nullptr;
+  }
+
   void *
   reallocate(void * memory_in, size_t size)
   {
@@ -14,20 +14,17 @@
 
 #include "./unix_common.hpp"
 
+#include <cerrno>
 #include <cstddef>
-#include <mutex>
 
 #include "../custom_memory_functions.hpp"
-#include "osrf_testing_tools_cpp/scope_exit.hpp"
+#include "../recursion_guard.hpp"
 
 static bool g_static_initialization_complete = false;
 
-static std::recursive_mutex* g_memory_function_recursive_mutex;
-
 void
 complete_static_initialization()
 {
-  g_memory_function_recursive_mutex = new std::recursive_mutex;
   g_static_initialization_complete = true;
 }
 
@@ -37,7 +34,21 @@ get_static_initialization_complete()
   return g_static_initialization_complete;
 }
 
-static size_t g_inside_custom_memory_function = 0;
+using osrf_testing_tools_cpp::memory_tools::recursion_guard_active;
+
+// posix_memalign() returns an error code rather than the memory, so its original is adapted
+// to the signature of the other aligned allocation functions through these
+static thread_local int (*g_tls_original_posix_memalign)(void **, size_t, size_t) = nullptr;
+static thread_local int g_tls_posix_memalign_result = 0;
+
+static
+void *
+call_original_posix_memalign(size_t alignment, size_t size)
+{
+  void * memory = nullptr;
+  g_tls_posix_memalign_result = g_tls_original_posix_memalign(&memory, alignment, size);
+  return memory;
+}
 
 extern "C"
 {
@@ -45,52 +56,40 @@ extern "C"
 void *
 unix_replacement_malloc(size_t size, void *(*original_malloc)(size_t))
 {
-  // Short-circuit to original function during self-recursion, if static initialization is done.
-  if (!g_static_initialization_complete || 0 != g_inside_custom_memory_function) {
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
     return original_malloc(size);
   }
-  std::lock_guard<std::recursive_mutex> lock(*g_memory_function_recursive_mutex);
-  g_inside_custom_memory_function++;
-  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
-    g_inside_custom_memory_function--;
-  });
 
   using osrf_testing_tools_cpp::memory_tools::custom_malloc_with_original;
-  return custom_malloc_with_original(size, original_malloc, __func__, false);
+  return custom_malloc_with_original(size, original_malloc, __func__);
 }
 
 void *
 unix_replacement_realloc(void * memory_in, size_t size, void *(*original_realloc)(void *, size_t))
 {
-  // Short-circuit to original function during self-recursion, if static initialization is done.
-  if (!g_static_initialization_complete || 0 != g_inside_custom_memory_function) {
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
     return original_realloc(memory_in, size);
   }
-  std::lock_guard<std::recursive_mutex> lock(*g_memory_function_recursive_mutex);
-  g_inside_custom_memory_function++;
-  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
-    g_inside_custom_memory_function--;
-  });
 
   using osrf_testing_tools_cpp::memory_tools::custom_realloc_with_original;
-  return custom_realloc_with_original(memory_in, size, original_realloc, __func__, false);
+  return custom_realloc_with_original(memory_in, size, original_realloc, __func__);
 }
 
 void *
 unix_replacement_calloc(size_t count, size_t size, void *(*original_calloc)(size_t, size_t))
 {
-  // Short-circuit to original function during self-recursion, if static initialization is done.
-  if (!g_static_initialization_complete || 0 != g_inside_custom_memory_function) {
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
     return original_calloc(count, size);
   }
-  std::lock_guard<std::recursive_mutex> lock(*g_memory_function_recursive_mutex);
-  g_inside_custom_memory_function++;
-  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
-    g_inside_custom_memory_function--;
-  });
 
   using osrf_testing_tools_cpp::memory_tools::custom_calloc_with_original;
-  return custom_calloc_with_original(count, size, original_calloc, __func__, false);
+  return custom_calloc_with_original(count, size, original_calloc, __func__);
 }
 
 void
@@ -99,18 +98,115 @@ unix_replacement_free(void * memory, void (*original_free)(void *))
   if (nullptr == memory) {
     return;
   }
-  // Short-circuit to original function during self-recursion, if static initialization is done.
-  if (!g_static_initialization_complete || 0 != g_inside_custom_memory_function) {
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
     return original_free(memory);
   }
-  std::lock_guard<std::recursive_mutex> lock(*g_memory_function_recursive_mutex);
-  g_inside_custom_memory_function++;
-  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
-    g_inside_custom_memory_function--;
-  });
 
   using osrf_testing_tools_cpp::memory_tools::custom_free_with_original;
-  custom_free_with_original(memory, original_free, __func__, false);
+  custom_free_with_original(memory, original_free, __func__);
+}
+
+void *
+unix_replacement_aligned_alloc(
+  size_t alignment,
+  size_t size,
+  void *(*original_aligned_alloc)(size_t, size_t),
+  const char * function_name)
+{
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
+    return original_aligned_alloc(alignment, size);
+  }
+
+  using osrf_testing_tools_cpp::memory_tools::custom_aligned_alloc_with_original;
+  return custom_aligned_alloc_with_original(
+    alignment, size, original_aligned_alloc, function_name);
+}
+
+int
+unix_replacement_posix_memalign(
+  void ** memory_out,
+  size_t alignment,
+  size_t size,
+  int (*original_posix_memalign)(void **, size_t, size_t))
+{
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
+    return original_posix_memalign(memory_out, alignment, size);
+  }
+
+  g_tls_original_posix_memalign = original_posix_memalign;
+  // stays set if the custom memory function fails before calling the original
+  g_tls_posix_memalign_result = ENOMEM;
+  using osrf_testing_tools_cpp::memory_tools::custom_aligned_alloc_with_original;
+  void * memory = custom_aligned_alloc_with_original(
+    alignment, size, call_original_posix_memalign, "posix_memalign");
+  if (0 == g_tls_posix_memalign_result) {
+    // like the original, memory_out is left untouched on failure
+    *memory_out = memory;
+  }
+  return g_tls_posix_memalign_result;
+}
+
+void *
+unix_replacement_operator_new(
+  size_t size,
+  size_t alignment,
+  void *(*original_aligned_alloc)(size_t, size_t),
+  const char * function_name)
+{
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
+    return original_aligned_alloc(alignment, size);
+  }
+
+  using osrf_testing_tools_cpp::memory_tools::custom_operator_new_with_original;
+  return custom_operator_new_with_original(size, alignment, original_aligned_alloc, function_name);
+}
+
+void
+unix_replacement_operator_delete(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  void (*original_free)(void *),
+  const char * function_name)
+{
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
+    return original_free(memory);
+  }
+
+  using osrf_testing_tools_cpp::memory_tools::custom_operator_delete_with_original;
+  custom_operator_delete_with_original(memory, size, alignment, original_free, function_name);
+}
+
+void *
+unix_replacement_mapping_operation(
+  osrf_testing_tools_cpp::memory_tools::MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void *(*original_operation)(void *),
+  void * original_arguments,
+  const char * function_name)
+{
+  // Short-circuit to original function during self-recursion, or if static initialization is
+  // not done yet, the recursion guard itself is maintained by the custom memory function.
+  if (!g_static_initialization_complete || recursion_guard_active()) {
+    return original_operation(original_arguments);
+  }
+
+  using osrf_testing_tools_cpp::memory_tools::custom_mapping_operation_with_original;
+  return custom_mapping_operation_with_original(
+    memory_function_type, memory_in, memory_in_size, size, original_operation,
+    original_arguments, function_name);
 }
 
 }  // extern "C"
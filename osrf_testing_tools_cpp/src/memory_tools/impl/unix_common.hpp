@@ -17,6 +17,8 @@
 
 #include <cstddef>
 
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+
 void
 complete_static_initialization();
 
@@ -38,6 +40,45 @@ unix_replacement_calloc(size_t count, size_t size, void *(*original_calloc)(size
 void
 unix_replacement_free(void * memory, void (*original_free)(void *));
 
+void *
+unix_replacement_aligned_alloc(
+  size_t alignment,
+  size_t size,
+  void *(*original_aligned_alloc)(size_t, size_t),
+  const char * function_name);
+
+int
+unix_replacement_posix_memalign(
+  void ** memory_out,
+  size_t alignment,
+  size_t size,
+  int (*original_posix_memalign)(void **, size_t, size_t));
+
+void *
+unix_replacement_operator_new(
+  size_t size,
+  size_t alignment,
+  void *(*original_aligned_alloc)(size_t, size_t),
+  const char * function_name);
+
+void
+unix_replacement_operator_delete(
+  void * memory,
+  size_t size,
+  size_t alignment,
+  void (*original_free)(void *),
+  const char * function_name);
+
+void *
+unix_replacement_mapping_operation(
+  osrf_testing_tools_cpp::memory_tools::MemoryFunctionType memory_function_type,
+  void * memory_in,
+  size_t memory_in_size,
+  size_t size,
+  void *(*original_operation)(void *),
+  void * original_arguments,
+  const char * function_name);
+
 }  // extern "C"
 
 #endif  // MEMORY_TOOLS__IMPL__UNIX_COMMON_HPP_
@@ -14,29 +14,34 @@
 
 #include "./implementation_monitoring_override.hpp"
 
+#include <cstddef>
+
 namespace osrf_testing_tools_cpp
 {
 namespace memory_tools
 {
 
-static bool g_inside_implementation = false;
+// Depth rather than a flag so that nested implementation sections work as expected.
+static thread_local size_t g_tls_implementation_section_depth = 0;
 
 bool
 inside_implementation()
 {
-  return g_inside_implementation;
+  return 0 != g_tls_implementation_section_depth;
 }
 
 void
 begin_implementation_section()
 {
-  g_inside_implementation = true;
+  g_tls_implementation_section_depth++;
 }
 
 void
 end_implementation_section()
 {
-  g_inside_implementation = false;
+  if (0 != g_tls_implementation_section_depth) {
+    g_tls_implementation_section_depth--;
+  }
 }
 
 ScopedImplementationSection::ScopedImplementationSection()
@@ -16,6 +16,8 @@
 #include <cstring>
 
 #include "./custom_memory_functions.hpp"
+#include "./event_log_impl.hpp"
+#include "./live_allocation_table.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/initialize.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/monitoring.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/register_hooks.hpp"
@@ -44,6 +46,8 @@ initialize()
     }
   };
   conditional_print("initializing memory tools...\n");
+  start_event_log_drain();
+  mark_live_allocations_at_initialize();
   g_initialized.store(true);
 }
 
@@ -57,10 +61,26 @@ uninitialize()
   on_realloc(nullptr);
   on_calloc(nullptr);
   on_free(nullptr);
+  on_aligned_alloc(nullptr);
+  on_operator_new(nullptr);
+  on_operator_delete(nullptr);
+  on_mmap(nullptr);
+  on_mremap(nullptr);
+  on_munmap(nullptr);
+  on_brk(nullptr);
   expect_no_malloc_end();
   expect_no_realloc_end();
   expect_no_calloc_end();
   expect_no_free_end();
+  expect_no_aligned_alloc_end();
+  expect_no_operator_new_end();
+  expect_no_operator_delete_end();
+  expect_no_mmap_end();
+  expect_no_mremap_end();
+  expect_no_munmap_end();
+  expect_no_brk_end();
+  stop_event_log_drain();
+  report_live_allocations_at_uninitialize();
   return g_initialized.exchange(true);
 }
 
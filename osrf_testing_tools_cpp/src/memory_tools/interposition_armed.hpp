@@ -0,0 +1,51 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__INTERPOSITION_ARMED_HPP_
+#define MEMORY_TOOLS__INTERPOSITION_ARMED_HPP_
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if the replacement memory functions need to do more than call the original.
+/**
+ * This is checked at the very top of the replacement memory functions, so it
+ * is only a relaxed atomic load in the common case where nothing is enabled.
+ *
+ * It returns false when monitoring cannot be enabled for the calling thread,
+ * i.e. neither `enable_monitoring()` for this thread nor
+ * `enable_monitoring_in_all_threads()` without a thread-specific
+ * `disable_monitoring()`, and nothing else has called arm_interposition().
+ *
+ * A true result does not mean the hooks will be called, the slow path still
+ * checks `initialized()`, `monitoring_enabled()` and so on.
+ */
+bool
+interposition_armed() noexcept;
+
+/// Force the replacement memory functions onto the slow path in all threads.
+/** Calls nest, each must be matched by a call to disarm_interposition(). */
+void
+arm_interposition() noexcept;
+
+/// Undo one previous call to arm_interposition().
+void
+disarm_interposition() noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__INTERPOSITION_ARMED_HPP_
@@ -0,0 +1,640 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./live_allocation_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif  // !defined(_WIN32)
+
+#include "osrf_testing_tools_cpp/memory_tools/live_allocations.hpp"
+#include "./allocation_lifetimes_impl.hpp"
+#include "./allocation_report_impl.hpp"
+#include "./cross_thread_frees_impl.hpp"
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./realloc_chains_impl.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Values of LiveAllocationSlot::address which are not addresses.
+static constexpr uintptr_t SLOT_EMPTY = 0;
+static constexpr uintptr_t SLOT_TOMBSTONE = 1;
+static constexpr uintptr_t SLOT_BUSY = 2;
+
+// The table is split in shards by the hash of the address, each probed linearly.
+static constexpr size_t LIVE_ALLOCATION_TABLE_SHARD_COUNT = 64;
+// Bounds the cost of each operation, an allocation is not tracked if no slot is free within it.
+static constexpr size_t LIVE_ALLOCATION_TABLE_PROBE_LIMIT = 32;
+static constexpr size_t LIVE_ALLOCATION_TABLE_DEFAULT_CAPACITY = 1 << 20;
+
+// Keep reports readable, the stacks with the most live bytes come first.
+static constexpr size_t REPORTED_STACKS_MAX = 10;
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+/// An entry of the table, the other fields are only valid while address is an address.
+/**
+ * A free slot is claimed by setting address to SLOT_BUSY, and published by
+ * setting it to the address once the other fields are written.
+ * Removing an entry sets address to SLOT_TOMBSTONE, which can be claimed again.
+ */
+struct LiveAllocationSlot
+{
+  std::atomic<uintptr_t> address;
+  std::atomic<uint64_t> size;
+  /// Value of g_live_allocation_epoch when the memory was allocated.
+  std::atomic<uint64_t> epoch;
+  /// Time of the allocation, only set while the allocation lifetimes are recorded, else 0.
+  std::atomic<uint64_t> timestamp_ns;
+  std::atomic<uint32_t> stack_id;
+  std::atomic<uint32_t> thread_index;
+  /// Number of reallocs which led to this block, only counted while realloc chains are recorded.
+  std::atomic<uint32_t> realloc_chain_length;
+  /// Stack of the allocation which started the realloc chain, if realloc_chain_length is not 0.
+  std::atomic<uint32_t> realloc_chain_stack_id;
+};
+
+static std::atomic<LiveAllocationSlot *> g_live_allocation_slots(nullptr);
+// Slots per shard, a power of two, set before g_live_allocation_slots is published.
+static size_t g_live_allocation_shard_capacity = 0;
+static std::atomic<bool> g_live_allocation_table_creating(false);
+static std::atomic<uint64_t> g_live_allocation_untracked_count(0);
+
+// Set by enable_live_allocation_tracking(), for the rest of the process.
+static std::atomic<bool> g_live_allocation_tracking_enabled(false);
+// Number of alive ScopedLeakCheck.
+static std::atomic<size_t> g_leak_check_count(0);
+// Incremented to tell apart the allocations made from some point on.
+static std::atomic<uint64_t> g_live_allocation_epoch(1);
+static std::atomic<uint64_t> g_live_allocation_initialize_epoch(1);
+
+bool
+live_allocation_table_enabled() noexcept
+{
+  return
+    g_live_allocation_tracking_enabled.load(std::memory_order_relaxed) ||
+    0 != g_leak_check_count.load(std::memory_order_relaxed) ||
+    allocation_lifetimes_recording_enabled() ||
+    realloc_chains_recording_enabled() ||
+    cross_thread_frees_recording_enabled() ||
+    allocation_report_recording_enabled();
+}
+
+bool
+live_allocation_tracking_enabled()
+{
+  return g_live_allocation_tracking_enabled.load();
+}
+
+static
+size_t
+get_live_allocation_table_capacity_from_env()
+{
+  char value[32];
+  if (!get_environment_variable("MEMORY_TOOLS_LIVE_ALLOCATIONS_CAPACITY", value, sizeof(value))) {
+    return LIVE_ALLOCATION_TABLE_DEFAULT_CAPACITY;
+  }
+  char * end = nullptr;
+  unsigned long long capacity = std::strtoull(value, &end, 10);  // NOLINT(runtime/int)
+  if ('\0' != *end || capacity < LIVE_ALLOCATION_TABLE_SHARD_COUNT || capacity > (1ULL << 32)) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] Given MEMORY_TOOLS_LIVE_ALLOCATIONS_CAPACITY=");
+    SAFE_FWRITE(stderr, value);
+    SAFE_FWRITE(stderr, " but that is not a number in [64, 2^32], using 1048576.\n");
+    return LIVE_ALLOCATION_TABLE_DEFAULT_CAPACITY;
+  }
+  size_t rounded_capacity = LIVE_ALLOCATION_TABLE_SHARD_COUNT;
+  while (rounded_capacity < capacity) {
+    rounded_capacity *= 2;
+  }
+  return rounded_capacity;
+}
+
+/// Return the table, creating it the first time, or nullptr if it is not available.
+static
+LiveAllocationSlot *
+get_or_create_live_allocation_table() noexcept
+{
+  LiveAllocationSlot * slots = g_live_allocation_slots.load(std::memory_order_acquire);
+#if !defined(_WIN32)
+  if (nullptr != slots) {
+    return slots;
+  }
+  while (g_live_allocation_table_creating.exchange(true, std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+  slots = g_live_allocation_slots.load(std::memory_order_acquire);
+  if (nullptr == slots) {
+    // neither the mapping nor reading the environment should be seen by memory tools
+    ScopedRecursionGuard recursion_guard;
+    const size_t capacity = get_live_allocation_table_capacity_from_env();
+    // only the pages which are used get committed
+    void * mapping = mmap(
+      nullptr, capacity * sizeof(LiveAllocationSlot), PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (MAP_FAILED == mapping) {
+      SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to map the live allocation table\n");
+    } else {
+      g_live_allocation_shard_capacity = capacity / LIVE_ALLOCATION_TABLE_SHARD_COUNT;
+      slots = static_cast<LiveAllocationSlot *>(mapping);
+      g_live_allocation_slots.store(slots, std::memory_order_release);
+    }
+  }
+  g_live_allocation_table_creating.store(false, std::memory_order_release);
+#endif  // !defined(_WIN32)
+  return slots;
+}
+
+/// Return the shard of the given address, and the index in it to probe first.
+static inline
+LiveAllocationSlot *
+get_shard(LiveAllocationSlot * slots, uintptr_t address, size_t * first_index) noexcept
+{
+  uint64_t hash = static_cast<uint64_t>(address >> 4) * 0x9e3779b97f4a7c15ULL;
+  hash ^= hash >> 32;
+  const size_t shard = hash % LIVE_ALLOCATION_TABLE_SHARD_COUNT;
+  *first_index =
+    (hash / LIVE_ALLOCATION_TABLE_SHARD_COUNT) & (g_live_allocation_shard_capacity - 1);
+  return slots + shard * g_live_allocation_shard_capacity;
+}
+
+/// Claim the slot for the given address, returning nullptr if none is free within the probe limit.
+/** The slot's address is SLOT_BUSY, it has to be published once its other fields are written. */
+static
+LiveAllocationSlot *
+claim_live_allocation_slot(LiveAllocationSlot * slots, uintptr_t address) noexcept
+{
+  size_t first_index = 0;
+  LiveAllocationSlot * shard = get_shard(slots, address, &first_index);
+  const size_t mask = g_live_allocation_shard_capacity - 1;
+  LiveAllocationSlot * slot = nullptr;
+  for (size_t retry = 0; retry < 4 && nullptr == slot; ++retry) {
+    LiveAllocationSlot * free_slot = nullptr;
+    uintptr_t free_slot_address = SLOT_EMPTY;
+    for (size_t i = 0; i < LIVE_ALLOCATION_TABLE_PROBE_LIMIT; ++i) {
+      LiveAllocationSlot & candidate = shard[(first_index + i) & mask];
+      const uintptr_t current = candidate.address.load(std::memory_order_acquire);
+      if (current == address) {
+        // left over from memory freed while the table was not kept, reuse it
+        slot = &candidate;
+        break;
+      }
+      if ((SLOT_EMPTY == current || SLOT_TOMBSTONE == current) && nullptr == free_slot) {
+        free_slot = &candidate;
+        free_slot_address = current;
+      }
+      if (SLOT_EMPTY == current) {
+        break;
+      }
+    }
+    if (nullptr != slot) {
+      uintptr_t expected = address;
+      if (!slot->address.compare_exchange_strong(expected, SLOT_BUSY)) {
+        slot = nullptr;
+      }
+    } else if (nullptr == free_slot) {
+      break;
+    } else if (free_slot->address.compare_exchange_strong(free_slot_address, SLOT_BUSY)) {
+      slot = free_slot;
+    }
+  }
+  if (nullptr == slot) {
+    g_live_allocation_untracked_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  return slot;
+}
+
+/// Write the fields of a claimed slot and publish it under the given address.
+static
+void
+publish_live_allocation(
+  LiveAllocationSlot * slot,
+  uintptr_t address,
+  const ErasedLiveAllocation & fields) noexcept
+{
+  slot->size.store(fields.size, std::memory_order_relaxed);
+  slot->epoch.store(fields.epoch, std::memory_order_relaxed);
+  slot->timestamp_ns.store(fields.timestamp_ns, std::memory_order_relaxed);
+  slot->stack_id.store(fields.stack_id, std::memory_order_relaxed);
+  slot->thread_index.store(fields.thread_index, std::memory_order_relaxed);
+  slot->realloc_chain_length.store(fields.realloc_chain_length, std::memory_order_relaxed);
+  slot->realloc_chain_stack_id.store(fields.realloc_chain_stack_id, std::memory_order_relaxed);
+  slot->address.store(address, std::memory_order_release);
+}
+
+static
+void
+insert_live_allocation(
+  LiveAllocationSlot * slots,
+  uintptr_t address,
+  uint64_t size,
+  uint32_t stack_id,
+  uint32_t realloc_chain_length,
+  uint32_t realloc_chain_stack_id) noexcept
+{
+  LiveAllocationSlot * slot = claim_live_allocation_slot(slots, address);
+  if (nullptr == slot) {
+    return;
+  }
+  publish_live_allocation(
+    slot, address, {
+      size,
+      g_live_allocation_epoch.load(std::memory_order_relaxed),
+      allocation_lifetimes_recording_enabled() ? get_timestamp_ns() : 0,
+      stack_id,
+      get_thread_index(),
+      realloc_chain_length,
+      realloc_chain_stack_id,
+    });
+}
+
+/// Remove the entry of the given address, returning false if it was not in the table.
+static
+bool
+erase_live_allocation(
+  LiveAllocationSlot * slots,
+  uintptr_t address,
+  ErasedLiveAllocation * erased) noexcept
+{
+  size_t first_index = 0;
+  LiveAllocationSlot * shard = get_shard(slots, address, &first_index);
+  const size_t mask = g_live_allocation_shard_capacity - 1;
+  for (size_t i = 0; i < LIVE_ALLOCATION_TABLE_PROBE_LIMIT; ++i) {
+    LiveAllocationSlot & candidate = shard[(first_index + i) & mask];
+    uintptr_t current = candidate.address.load(std::memory_order_acquire);
+    if (current == address) {
+      // read before the slot can be claimed again
+      erased->size = candidate.size.load(std::memory_order_relaxed);
+      erased->epoch = candidate.epoch.load(std::memory_order_relaxed);
+      erased->timestamp_ns = candidate.timestamp_ns.load(std::memory_order_relaxed);
+      erased->stack_id = candidate.stack_id.load(std::memory_order_relaxed);
+      erased->thread_index = candidate.thread_index.load(std::memory_order_relaxed);
+      erased->realloc_chain_length =
+        candidate.realloc_chain_length.load(std::memory_order_relaxed);
+      erased->realloc_chain_stack_id =
+        candidate.realloc_chain_stack_id.load(std::memory_order_relaxed);
+      return candidate.address.compare_exchange_strong(current, SLOT_TOMBSTONE);
+    }
+    if (SLOT_EMPTY == current) {
+      // allocated while the table was not kept, or not tracked
+      return false;
+    }
+  }
+  return false;
+}
+
+/// Give an entry removed from the table to the analyses which count frees.
+/** free_stack_id is the stack of the event if it was captured, else 0. */
+static
+void
+record_freed_live_allocation(const ErasedLiveAllocation & erased, uint32_t free_stack_id) noexcept
+{
+  if (0 != erased.timestamp_ns && allocation_lifetimes_recording_enabled()) {
+    const uint64_t now_ns = get_timestamp_ns();
+    allocation_lifetimes_record_free(
+      erased.stack_id, erased.size,
+      (now_ns > erased.timestamp_ns) ? now_ns - erased.timestamp_ns : 0,
+      get_thread_index() == erased.thread_index);
+  }
+  if (cross_thread_frees_recording_enabled()) {
+    cross_thread_frees_record(erased.stack_id, erased.thread_index, erased.size, free_stack_id);
+  }
+}
+
+bool
+claim_live_allocation_for_realloc(void * memory_in, ErasedLiveAllocation * claimed) noexcept
+{
+  LiveAllocationSlot * slots = g_live_allocation_slots.load(std::memory_order_acquire);
+  if (nullptr == slots || nullptr == memory_in || !live_allocation_table_enabled()) {
+    return false;
+  }
+  return erase_live_allocation(slots, reinterpret_cast<uintptr_t>(memory_in), claimed);
+}
+
+void
+live_allocation_table_record(const MemoryEvent & event) noexcept
+{
+  LiveAllocationSlot * slots = g_live_allocation_slots.load(std::memory_order_acquire);
+  if (nullptr == slots) {
+    return;
+  }
+  const uintptr_t memory_in = reinterpret_cast<uintptr_t>(event.memory_in);
+  const uintptr_t memory_out = reinterpret_cast<uintptr_t>(event.memory_out);
+  bool allocated = false;
+  ErasedLiveAllocation erased {};
+  uint32_t realloc_chain_length = 0;
+  uint32_t realloc_chain_stack_id = 0;
+  switch (event.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+    case MemoryFunctionType::Calloc:
+    case MemoryFunctionType::AlignedAlloc:
+    case MemoryFunctionType::OperatorNew:
+      allocated = 0 != memory_out;
+      break;
+    case MemoryFunctionType::Realloc:
+      allocated = 0 != memory_out;
+      if (nullptr == event.realloc_claim) {
+        // memory_in was not in the table
+        break;
+      }
+      if (!allocated && 0 != event.size) {
+        // realloc failed and memory_in is kept, so its entry goes back
+        LiveAllocationSlot * slot = claim_live_allocation_slot(slots, memory_in);
+        if (nullptr != slot) {
+          publish_live_allocation(slot, memory_in, *event.realloc_claim);
+        }
+        break;
+      }
+      // memory_in was given back, by realloc(memory_in, 0) if nothing was allocated
+      record_freed_live_allocation(*event.realloc_claim, event.stack_id);
+      if (allocated && realloc_chains_recording_enabled()) {
+        // the new block continues the chain of the old one, attributed to where it started
+        const ErasedLiveAllocation & claimed = *event.realloc_claim;
+        realloc_chain_length = claimed.realloc_chain_length + 1;
+        realloc_chain_stack_id =
+          (0 == claimed.realloc_chain_length) ? claimed.stack_id : claimed.realloc_chain_stack_id;
+        realloc_chains_record(
+          realloc_chain_stack_id, realloc_chain_length, claimed.size, event.size,
+          memory_in != memory_out);
+      }
+      break;
+    case MemoryFunctionType::Free:
+    case MemoryFunctionType::OperatorDelete:
+      if (erase_live_allocation(slots, memory_in, &erased)) {
+        record_freed_live_allocation(erased, event.stack_id);
+      }
+      break;
+    default:
+      // memory mappings are not heap allocations
+      break;
+  }
+  if (allocated) {
+    insert_live_allocation(
+      slots, memory_out, event.count * event.size, event.stack_id, realloc_chain_length,
+      realloc_chain_stack_id);
+    if (allocation_lifetimes_recording_enabled()) {
+      allocation_lifetimes_record_allocation(event.stack_id);
+    }
+  }
+}
+
+/// A live allocation read from the table.
+struct LiveAllocation
+{
+  uint32_t stack_id;
+  uint64_t size;
+};
+
+/// Return the live allocations made since the given epoch, by the given thread or by any if 0.
+static
+std::vector<LiveAllocation>
+collect_live_allocations(uint64_t since_epoch, uint32_t thread_index)
+{
+  std::vector<LiveAllocation> live_allocations;
+  LiveAllocationSlot * slots = g_live_allocation_slots.load(std::memory_order_acquire);
+  if (nullptr == slots) {
+    return live_allocations;
+  }
+  const size_t capacity = g_live_allocation_shard_capacity * LIVE_ALLOCATION_TABLE_SHARD_COUNT;
+  for (size_t i = 0; i < capacity; ++i) {
+    const LiveAllocationSlot & slot = slots[i];
+    if (slot.address.load(std::memory_order_acquire) <= SLOT_BUSY) {
+      continue;
+    }
+    if (
+      slot.epoch.load(std::memory_order_relaxed) < since_epoch ||
+      (0 != thread_index && slot.thread_index.load(std::memory_order_relaxed) != thread_index))
+    {
+      continue;
+    }
+    live_allocations.push_back(
+      {slot.stack_id.load(std::memory_order_relaxed), slot.size.load(std::memory_order_relaxed)});
+  }
+  return live_allocations;
+}
+
+/// Return the given live allocations grouped by stack, most bytes first.
+static
+std::vector<LiveAllocationGroup>
+group_live_allocations(std::vector<LiveAllocation> live_allocations)
+{
+  std::sort(
+    live_allocations.begin(), live_allocations.end(),
+    [](const LiveAllocation & lhs, const LiveAllocation & rhs) {
+      return lhs.stack_id < rhs.stack_id;
+    });
+  std::vector<LiveAllocationGroup> groups;
+  for (const auto & live_allocation : live_allocations) {
+    if (groups.empty() || groups.back().stack_id != live_allocation.stack_id) {
+      groups.push_back({live_allocation.stack_id, {0, 0}});
+    }
+    groups.back().totals.count++;
+    groups.back().totals.bytes += live_allocation.size;
+  }
+  std::sort(
+    groups.begin(), groups.end(),
+    [](const LiveAllocationGroup & lhs, const LiveAllocationGroup & rhs) {
+      return lhs.totals.bytes > rhs.totals.bytes;
+    });
+  return groups;
+}
+
+std::vector<LiveAllocationGroup>
+collect_live_allocation_groups()
+{
+  return group_live_allocations(collect_live_allocations(0, 0));
+}
+
+/// Return the given live allocations grouped by stack, most bytes first, with stacks symbolized.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+static
+std::string
+format_live_allocations(const char * title, std::vector<LiveAllocation> live_allocations)
+{
+  LiveAllocationTotals totals {0, 0};
+  for (const auto & live_allocation : live_allocations) {
+    totals.count++;
+    totals.bytes += live_allocation.size;
+  }
+  const std::vector<LiveAllocationGroup> groups =
+    group_live_allocations(std::move(live_allocations));
+
+  std::ostringstream out;
+  out << title << ": " << totals.count << " allocation(s), " << totals.bytes << " bytes\n";
+  LiveAllocationTotals other {0, 0};
+  for (size_t i = 0; i < groups.size(); ++i) {
+    if (i < REPORTED_STACKS_MAX) {
+      out << "  " << groups[i].totals.count << " allocation(s), " << groups[i].totals.bytes <<
+        " bytes, from:\n" <<
+        format_interned_stack(groups[i].stack_id, REPORTED_FRAMES_MAX, "    ");
+    } else {
+      other.count += groups[i].totals.count;
+      other.bytes += groups[i].totals.bytes;
+    }
+  }
+  if (0 != other.count) {
+    out << "  " << other.count << " allocation(s), " << other.bytes << " bytes, from " <<
+      (groups.size() - REPORTED_STACKS_MAX) << " other stack(s)\n";
+  }
+  const uint64_t untracked_count = g_live_allocation_untracked_count.load();
+  if (0 != untracked_count) {
+    out << "  " << untracked_count << " allocation(s) were not tracked, " <<
+      "increase MEMORY_TOOLS_LIVE_ALLOCATIONS_CAPACITY\n";
+  }
+  return out.str();
+}
+
+static
+void
+print_live_allocations(uint64_t since_epoch, const char * title)
+{
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  std::vector<LiveAllocation> live_allocations = collect_live_allocations(since_epoch, 0);
+  if (live_allocations.empty()) {
+    return;
+  }
+  const std::string report = format_live_allocations(title, std::move(live_allocations));
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+void
+mark_live_allocations_at_initialize() noexcept
+{
+  g_live_allocation_initialize_epoch.store(g_live_allocation_epoch.fetch_add(1) + 1);
+}
+
+void
+report_live_allocations_at_uninitialize() noexcept
+{
+  if (!g_live_allocation_tracking_enabled.load()) {
+    return;
+  }
+  try {
+    print_live_allocations(
+      g_live_allocation_initialize_epoch.load(),
+      "[memory_tools][WARN] allocations made since initialize() still live at uninitialize()");
+  } catch (...) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to report the live allocations\n");
+  }
+}
+
+static
+void
+report_live_allocations_at_exit()
+{
+  print_live_allocations(0, "[memory_tools][WARN] allocations still live at exit");
+}
+
+bool
+create_live_allocation_table() noexcept
+{
+  return nullptr != get_or_create_live_allocation_table();
+}
+
+bool
+enable_live_allocation_tracking()
+{
+  if (nullptr == get_or_create_live_allocation_table()) {
+    return false;
+  }
+  if (!g_live_allocation_tracking_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+  return true;
+}
+
+ScopedLeakCheck::ScopedLeakCheck()
+: table_available_(nullptr != get_or_create_live_allocation_table()),
+  thread_index_(get_thread_index()),
+  start_epoch_(0)
+{
+  ++g_leak_check_count;
+  arm_interposition();
+  start_epoch_ = g_live_allocation_epoch.fetch_add(1) + 1;
+}
+
+ScopedLeakCheck::~ScopedLeakCheck()
+{
+  disarm_interposition();
+  --g_leak_check_count;
+}
+
+LiveAllocationTotals
+ScopedLeakCheck::get_leaks() const
+{
+  LiveAllocationTotals totals {0, 0};
+  if (!table_available_) {
+    return totals;
+  }
+  ScopedRecursionGuard recursion_guard;
+  for (const auto & live_allocation : collect_live_allocations(start_epoch_, thread_index_)) {
+    totals.count++;
+    totals.bytes += live_allocation.size;
+  }
+  return totals;
+}
+
+bool
+ScopedLeakCheck::check(std::string * report) const
+{
+  if (!table_available_) {
+    return true;
+  }
+  // nothing allocated from here on is seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  std::vector<LiveAllocation> live_allocations =
+    collect_live_allocations(start_epoch_, thread_index_);
+  if (live_allocations.empty()) {
+    return true;
+  }
+  if (nullptr != report) {
+    *report = format_live_allocations("leaked", std::move(live_allocations));
+  }
+  return false;
+}
+
+/// Enables the table, if requested, when the library is loaded.
+static struct LiveAllocationTableInitializer
+{
+  LiveAllocationTableInitializer()
+  {
+    if (
+      environment_variable_is_enabled("MEMORY_TOOLS_LIVE_ALLOCATIONS") &&
+      enable_live_allocation_tracking())
+    {
+      std::atexit(report_live_allocations_at_exit);
+    }
+  }
+} g_live_allocation_table_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
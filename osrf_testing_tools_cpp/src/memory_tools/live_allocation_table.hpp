@@ -0,0 +1,96 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__LIVE_ALLOCATION_TABLE_HPP_
+#define MEMORY_TOOLS__LIVE_ALLOCATION_TABLE_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "osrf_testing_tools_cpp/memory_tools/live_allocations.hpp"
+#include "./memory_event.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if the live allocation table is being kept, see enable_live_allocation_tracking().
+/**
+ * Also kept while allocation lifetimes, realloc chains or cross-thread frees
+ * are recorded, see enable_allocation_lifetime_analysis(),
+ * enable_realloc_chain_analysis() and enable_cross_thread_free_analysis(),
+ * and for the allocation report, see enable_allocation_report().
+ */
+bool
+live_allocation_table_enabled() noexcept;
+
+/// Create the table if it does not exist yet, returning false if it is not available.
+bool
+create_live_allocation_table() noexcept;
+
+/// Fields of an entry removed from the table.
+struct ErasedLiveAllocation
+{
+  uint64_t size;
+  /// Epoch of the table when the memory was allocated.
+  uint64_t epoch;
+  uint64_t timestamp_ns;
+  uint32_t stack_id;
+  uint32_t thread_index;
+  uint32_t realloc_chain_length;
+  uint32_t realloc_chain_stack_id;
+};
+
+/// Take the entry of the memory about to be given to the original realloc out of the table.
+/**
+ * Once realloc gave it back, another thread may get the same address and
+ * insert it before the realloc is recorded, so the entry is removed first
+ * and passed to live_allocation_table_record() in MemoryEvent::realloc_claim,
+ * which puts it back if realloc failed.
+ *
+ * \returns false if the table is not kept or the memory is not in it
+ */
+bool
+claim_live_allocation_for_realloc(void * memory_in, ErasedLiveAllocation * claimed) noexcept;
+
+/// Add or remove the memory of the given event to or from the live allocation table.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+live_allocation_table_record(const MemoryEvent & event) noexcept;
+
+/// Live allocations of one call stack.
+struct LiveAllocationGroup
+{
+  uint32_t stack_id;
+  LiveAllocationTotals totals;
+};
+
+/// Return everything live in the table grouped by stack, most bytes first.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+std::vector<LiveAllocationGroup>
+collect_live_allocation_groups();
+
+/// Called by initialize(), allocations made from now on are reported by uninitialize().
+void
+mark_live_allocations_at_initialize() noexcept;
+
+/// Called by uninitialize(), prints the allocations made since initialize() still live.
+void
+report_live_allocations_at_uninitialize() noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__LIVE_ALLOCATION_TABLE_HPP_
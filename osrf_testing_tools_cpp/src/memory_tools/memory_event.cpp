@@ -0,0 +1,131 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./memory_event.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "./allocation_size_histograms_impl.hpp"
+#include "./allocation_stats_impl.hpp"
+#include "./heap_profile.hpp"
+#include "./live_allocation_table.hpp"
+#include "./stack_table.hpp"
+#include "./trace_file.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+bool
+memory_event_recording_enabled() noexcept
+{
+  return
+    trace_file_enabled() ||
+    allocation_stats_enabled() ||
+    live_allocation_table_enabled() ||
+    heap_profile_enabled() ||
+    allocation_size_histograms_recording_enabled();
+}
+
+// Number of recorders which need the stack id of every event.
+static std::atomic<size_t> g_memory_event_stacks_count(0);
+
+void
+enable_memory_event_stacks() noexcept
+{
+  g_memory_event_stacks_count.fetch_add(1);
+}
+
+void
+disable_memory_event_stacks() noexcept
+{
+  g_memory_event_stacks_count.fetch_sub(1);
+}
+
+bool
+memory_event_stacks_enabled() noexcept
+{
+  return 0 != g_memory_event_stacks_count.load(std::memory_order_relaxed);
+}
+
+/// Return true if a recorder which is not sampled needs the stack of the given event.
+static
+bool
+memory_event_stack_needed(const MemoryEvent & event) noexcept
+{
+  if (memory_event_stacks_enabled()) {
+    return true;
+  }
+  switch (event.memory_function_type) {
+    case MemoryFunctionType::Malloc:
+    case MemoryFunctionType::Realloc:
+    case MemoryFunctionType::Calloc:
+    case MemoryFunctionType::AlignedAlloc:
+    case MemoryFunctionType::OperatorNew:
+      break;
+    default:
+      return false;
+  }
+  // a failed allocation, or realloc(memory_in, 0) freeing memory_in, allocated nothing
+  if (nullptr == event.memory_out) {
+    return false;
+  }
+  return
+    live_allocation_table_enabled() ||
+    allocation_size_histograms_recording_enabled() ||
+    allocation_call_sites_installed() ||
+    heap_profile_records_every_allocation();
+}
+
+void
+record_memory_event(MemoryEvent event) noexcept
+{
+  if (memory_event_stack_needed(event)) {
+    event.stack_id = capture_stack_id();
+    event.stack_id_captured = true;
+  }
+  if (trace_file_enabled()) {
+    trace_file_record(event);
+  }
+  if (allocation_stats_enabled()) {
+    allocation_stats_record(event);
+  }
+  if (live_allocation_table_enabled()) {
+    live_allocation_table_record(event);
+  }
+  if (heap_profile_enabled()) {
+    heap_profile_record(event);
+  }
+  if (allocation_size_histograms_recording_enabled()) {
+    allocation_size_histograms_record(event);
+  }
+}
+
+static std::atomic<uint32_t> g_next_thread_index(1);
+static thread_local uint32_t g_tls_thread_index = 0;
+
+uint32_t
+get_thread_index() noexcept
+{
+  if (0 == g_tls_thread_index) {
+    g_tls_thread_index = g_next_thread_index++;
+  }
+  return g_tls_thread_index;
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
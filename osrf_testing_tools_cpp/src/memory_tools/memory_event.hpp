@@ -0,0 +1,109 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__MEMORY_EVENT_HPP_
+#define MEMORY_TOOLS__MEMORY_EVENT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+struct ErasedLiveAllocation;
+
+/// A memory operation as seen by the recorders, e.g. the binary trace file.
+/**
+ * Unlike the user callbacks, recorders see every memory operation which
+ * reaches the custom memory functions, whether or not monitoring is enabled.
+ * Frees are recorded just before the memory is given back, everything else
+ * just after the operation completed.
+ */
+struct MemoryEvent
+{
+  MemoryFunctionType memory_function_type;
+  /// Memory given to realloc or free, otherwise nullptr.
+  void * memory_in;
+  /// Number of elements for calloc, otherwise 1.
+  uint64_t count;
+  /// Requested size in bytes, per element for calloc.
+  uint64_t size;
+  /// Memory returned by the operation, nullptr for free.
+  void * memory_out;
+  /// Bytes given back from memory_in, 0 if none or unknown.
+  /**
+   * The usable size of the block for free, operator delete and realloc, the
+   * length unmapped for munmap, the old length for mremap and the bytes
+   * released by a shrinking brk or sbrk.
+   */
+  uint64_t memory_in_size = 0;
+  /// See intern_stack(), 0 unless stack_id_captured.
+  uint32_t stack_id = 0;
+  /// Entry of memory_in taken out of the live allocation table before realloc, else nullptr.
+  /** See claim_live_allocation_for_realloc(). */
+  const ErasedLiveAllocation * realloc_claim = nullptr;
+  /// True if record_memory_event() captured stack_id, which is then 0 if the stack is unknown.
+  /**
+   * It is captured once for every event if memory_event_stacks_enabled(), and
+   * for successful allocations if a recorder which is not sampled needs it,
+   * so that the recorders never unwind the same stack twice.
+   */
+  bool stack_id_captured = false;
+};
+
+/// Return true if any recorder is enabled, checked before building a MemoryEvent.
+bool
+memory_event_recording_enabled() noexcept;
+
+/// Pass an event to all enabled recorders, capturing its stack id first if any needs it.
+/** Must be called with a ScopedRecursionGuard alive in this thread. */
+void
+record_memory_event(MemoryEvent event) noexcept;
+
+/// Called by recorders which need the stack id of every event, until they call the disable.
+/** Calls are counted, stacks are captured until every enable is matched by a disable. */
+void
+enable_memory_event_stacks() noexcept;
+
+/// Undo one call to enable_memory_event_stacks().
+void
+disable_memory_event_stacks() noexcept;
+
+/// Return true if any recorder needs the stack id of every event.
+bool
+memory_event_stacks_enabled() noexcept;
+
+/// Return a small number which uniquely identifies the calling thread in this process.
+/** Numbers are given out in order of first use starting at 1, and are never reused. */
+uint32_t
+get_thread_index() noexcept;
+
+/// Return a monotonic timestamp in nanoseconds.
+inline
+uint64_t
+get_timestamp_ns() noexcept
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__MEMORY_EVENT_HPP_
@@ -17,37 +17,19 @@
 #include <thread>
 
 #include "./memory_tools_service_impl.hpp"
+#include "./stack_table.hpp"
 #include "./stack_trace_impl.hpp"
+#include "./unwinder.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
-#include "osrf_testing_tools_cpp/memory_tools/verbosity.hpp"
 
 namespace osrf_testing_tools_cpp
 {
 namespace memory_tools
 {
 
-MemoryToolsService::MemoryToolsService(
-  MemoryFunctionType memory_function_type,
-  const char * source_function_name)
-: impl_(new MemoryToolsServiceImpl(memory_function_type, source_function_name))
-{
-  switch(get_verbosity_level()) {
-    case VerbosityLevel::quiet:
-      impl_->ignored = true;
-      impl_->should_print_backtrace = false;
-      break;
-    case VerbosityLevel::debug:
-      impl_->ignored = false;
-      impl_->should_print_backtrace = false;
-      break;
-    case VerbosityLevel::trace:
-      impl_->ignored = false;
-      impl_->should_print_backtrace = true;
-      break;
-    default:
-      throw std::logic_error("unexpected case for VerbosityLevel");
-  }
-}
+MemoryToolsService::MemoryToolsService(MemoryToolsServiceImpl & impl)
+: impl_(&impl)
+{}
 
 MemoryToolsService::~MemoryToolsService()
 {}
@@ -70,6 +52,20 @@ MemoryToolsService::get_memory_function_type_str() const
       return "calloc";
     case MemoryFunctionType::Free:
       return "free";
+    case MemoryFunctionType::AlignedAlloc:
+      return "aligned_alloc";
+    case MemoryFunctionType::OperatorNew:
+      return "operator new";
+    case MemoryFunctionType::OperatorDelete:
+      return "operator delete";
+    case MemoryFunctionType::Mmap:
+      return "mmap";
+    case MemoryFunctionType::Mremap:
+      return "mremap";
+    case MemoryFunctionType::Munmap:
+      return "munmap";
+    case MemoryFunctionType::Brk:
+      return "brk";
     default:
       throw std::runtime_error("unexpected default case in switch statement");
   }
@@ -98,10 +94,10 @@ MemoryToolsService::get_stack_trace()
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
   if (nullptr == impl_->lazy_stack_trace) {
-    backward::StackTrace st;
-    st.load_here(256);
+    void * frames[STACK_CAPTURE_MAX_DEPTH];
+    const size_t depth = capture_stack(frames, get_max_stack_depth());
     impl_->lazy_stack_trace.reset(new StackTrace(std::unique_ptr<StackTraceImpl>(
-      new StackTraceImpl(st, std::this_thread::get_id())
+      new StackTraceImpl(frames, depth, std::this_thread::get_id())
     )));
   }
   return impl_->lazy_stack_trace.get();
@@ -110,6 +106,27 @@ MemoryToolsService::get_stack_trace()
 #endif  // !defined(_WIN32) && !defined(__ANDROID__)
 }
 
+uint32_t
+MemoryToolsService::get_stack_id()
+{
+  if (0 == impl_->lazy_stack_id) {
+    impl_->lazy_stack_id = capture_stack_id();
+  }
+  return impl_->lazy_stack_id;
+}
+
+size_t
+MemoryToolsService::get_size() const
+{
+  return impl_->size;
+}
+
+size_t
+MemoryToolsService::get_alignment() const
+{
+  return impl_->alignment;
+}
+
 const char *
 MemoryToolsService::get_source_function_name() const
 {
@@ -17,21 +17,32 @@
 
 #include "./memory_tools_service_impl.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/verbosity.hpp"
 
 namespace osrf_testing_tools_cpp
 {
 namespace memory_tools
 {
 
+/// Creates a MemoryToolsService and its implementation in place, without allocating.
+/**
+ * Meant to be created on the stack of the custom memory functions.
+ */
 class MemoryToolsServiceFactory
 {
 public:
   MemoryToolsServiceFactory(
     MemoryFunctionType memory_function_type,
-    const char * source_function_name)
-  : service_(memory_function_type, source_function_name)
+    const char * source_function_name,
+    size_t size = 0,
+    size_t alignment = 0)
+  : impl_(memory_function_type, source_function_name, get_verbosity_level(), size, alignment),
+    service_(impl_)
   {}
 
+  MemoryToolsServiceFactory(const MemoryToolsServiceFactory &) = delete;
+  MemoryToolsServiceFactory & operator=(const MemoryToolsServiceFactory &) = delete;
+
   MemoryToolsService &
   get_memory_tools_service()
   {
@@ -41,16 +52,18 @@ public:
   bool
   should_ignore()
   {
-    return !service_.impl_->should_print_backtrace && service_.impl_->ignored;
+    return !impl_.should_print_backtrace && impl_.ignored;
   }
 
   bool
   should_print_backtrace()
   {
-    return service_.impl_->should_print_backtrace;
+    return impl_.should_print_backtrace;
   }
 
 private:
+  // must be declared, and therefore constructed, before service_
+  MemoryToolsServiceImpl impl_;
   MemoryToolsService service_;
 };
 
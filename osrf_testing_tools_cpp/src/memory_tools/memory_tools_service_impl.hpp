@@ -15,9 +15,12 @@
 #ifndef MEMORY_TOOLS__MEMORY_TOOLS_SERVICE_IMPL_HPP_
 #define MEMORY_TOOLS__MEMORY_TOOLS_SERVICE_IMPL_HPP_
 
+#include <cstddef>
 #include <memory>
+#include <stdexcept>
 
 #include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/verbosity.hpp"
 
 namespace osrf_testing_tools_cpp
 {
@@ -29,18 +32,48 @@ class MemoryToolsServiceImpl
 public:
   MemoryToolsServiceImpl(
     MemoryFunctionType memory_function_type_in,
-    const char * source_function_name_in)
+    const char * source_function_name_in,
+    VerbosityLevel verbosity_level,
+    size_t size_in = 0,
+    size_t alignment_in = 0)
   : memory_function_type(memory_function_type_in),
     source_function_name(source_function_name_in),
-    lazy_stack_trace(nullptr)
-  {}
+    size(size_in),
+    alignment(alignment_in),
+    lazy_stack_trace(nullptr),
+    lazy_stack_id(0)
+  {
+    switch (verbosity_level) {
+      case VerbosityLevel::quiet:
+        ignored = true;
+        should_print_backtrace = false;
+        break;
+      case VerbosityLevel::debug:
+        ignored = false;
+        should_print_backtrace = false;
+        break;
+      case VerbosityLevel::trace:
+        ignored = false;
+        should_print_backtrace = true;
+        break;
+      default:
+        throw std::logic_error("unexpected case for VerbosityLevel");
+    }
+  }
 
   MemoryFunctionType memory_function_type;
   const char * source_function_name;
+  // 0 if unknown, e.g. for free
+  size_t size;
+  // 0 unless an alignment was requested
+  size_t alignment;
 
   bool ignored;
   bool should_print_backtrace;
+  // only allocated if the user asks for the stack trace
   std::unique_ptr<StackTrace> lazy_stack_trace;
+  // only captured if the user asks for the stack id, 0 until then
+  uint32_t lazy_stack_id;
 };
 
 }  // namespace memory_tools
@@ -15,8 +15,10 @@
 #include "osrf_testing_tools_cpp/memory_tools/monitoring.hpp"
 
 #include <atomic>
+#include <cstddef>
 
 #include "./implementation_monitoring_override.hpp"
+#include "./interposition_armed.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/initialize.hpp"
 #include "osrf_testing_tools_cpp/scope_exit.hpp"
 
@@ -29,6 +31,56 @@ static thread_local bool g_tls_thread_specific_enable_set = false;
 static thread_local bool g_tls_enabled = false;
 static std::atomic<bool> g_enabled(false);
 
+// Number of reasons monitoring might be enabled in some thread, i.e. one for
+// the global enable plus one per thread with a thread-specific enable.
+// A thread which exits while enabled leaves this elevated, which is harmless
+// because interposition_armed() still checks the thread-specific state.
+static std::atomic<size_t> g_monitoring_armed_count(0);
+// Number of outstanding calls to arm_interposition().
+static std::atomic<size_t> g_interposition_armed_count(0);
+
+bool
+interposition_armed() noexcept
+{
+  if (0 != g_interposition_armed_count.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  if (0 == g_monitoring_armed_count.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  if (g_tls_thread_specific_enable_set) {
+    return g_tls_enabled;
+  }
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+void
+arm_interposition() noexcept
+{
+  g_interposition_armed_count++;
+}
+
+void
+disarm_interposition() noexcept
+{
+  g_interposition_armed_count--;
+}
+
+static
+void
+set_thread_specific_monitoring_enable(bool is_set, bool enabled)
+{
+  bool was_enabled = g_tls_thread_specific_enable_set && g_tls_enabled;
+  bool is_enabled = is_set && enabled;
+  if (!was_enabled && is_enabled) {
+    g_monitoring_armed_count++;
+  } else if (was_enabled && !is_enabled) {
+    g_monitoring_armed_count--;
+  }
+  g_tls_enabled = enabled;
+  g_tls_thread_specific_enable_set = is_set;
+}
+
 bool
 monitoring_enabled()
 {
@@ -48,34 +100,39 @@ monitoring_enabled()
 void
 enable_monitoring()
 {
-  g_tls_enabled = true;
-  g_tls_thread_specific_enable_set = true;
+  set_thread_specific_monitoring_enable(true, true);
 }
 
 void
 disable_monitoring()
 {
-  g_tls_enabled = false;
-  g_tls_thread_specific_enable_set = true;
+  set_thread_specific_monitoring_enable(true, false);
 }
 
 void
 unset_thread_specific_monitoring_enable()
 {
-  g_tls_enabled = false;
-  g_tls_thread_specific_enable_set = false;
+  set_thread_specific_monitoring_enable(false, false);
 }
 
 bool
 enable_monitoring_in_all_threads()
 {
-  return g_enabled.exchange(true);
+  bool previous = g_enabled.exchange(true);
+  if (!previous) {
+    g_monitoring_armed_count++;
+  }
+  return previous;
 }
 
 bool
 disable_monitoring_in_all_threads()
 {
-  return g_enabled.exchange(false);
+  bool previous = g_enabled.exchange(false);
+  if (previous) {
+    g_monitoring_armed_count--;
+  }
+  return previous;
 }
 
 }  // namespace memory_tools
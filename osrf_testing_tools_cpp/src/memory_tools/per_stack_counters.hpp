@@ -0,0 +1,122 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__PER_STACK_COUNTERS_HPP_
+#define MEMORY_TOOLS__PER_STACK_COUNTERS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Counters of each interned stack, allocated the first time the stack is counted.
+/**
+ * Lock-free, and the counters of a stack are never freed once created, so
+ * they can be read at any time while other threads update them.
+ * Only meant for variables with static storage duration, which are zero
+ * initialized before any code runs, and so usable from the very first
+ * memory operation.
+ */
+template<typename CountersT>
+class PerStackCounters
+{
+public:
+  /// Return the counters of the given stack, or nullptr if they were never created.
+  CountersT *
+  get(uint32_t stack_id) const noexcept
+  {
+    return counters_[stack_id].load(std::memory_order_acquire);
+  }
+
+  /// Return the counters of the given stack, creating them if needed, nullptr if out of memory.
+  /** Must be called with a ScopedRecursionGuard alive in this thread. */
+  CountersT *
+  get_or_create(uint32_t stack_id) noexcept
+  {
+    std::atomic<CountersT *> & slot = counters_[stack_id];
+    CountersT * counters = slot.load(std::memory_order_acquire);
+    if (nullptr != counters) {
+      return counters;
+    }
+    // the recursion guard of the caller sends this allocation to the original functions
+    CountersT * created = new (std::nothrow) CountersT();
+    if (nullptr == created) {
+      return nullptr;
+    }
+    if (!slot.compare_exchange_strong(counters, created, std::memory_order_acq_rel)) {
+      // another thread created them first, counters now holds those
+      delete created;
+      return counters;
+    }
+    return created;
+  }
+
+  /// Call function(stack_id, counters) for every stack with counters, by increasing stack id.
+  template<typename FunctionT>
+  void
+  for_each(FunctionT && function) const
+  {
+    for (uint32_t stack_id = 0; stack_id <= STACK_TABLE_CAPACITY; ++stack_id) {
+      CountersT * counters = get(stack_id);
+      if (nullptr != counters) {
+        function(stack_id, *counters);
+      }
+    }
+  }
+
+private:
+  // Indexed by stack id, 0 being the unknown stack, never freed once set.
+  std::atomic<CountersT *> counters_[STACK_TABLE_CAPACITY + 1];
+};
+
+/// Return the power of two bucket of the given value, 0 for 0 and i for [2^(i-1), 2^i).
+inline
+size_t
+get_log2_bucket(uint64_t value) noexcept
+{
+  size_t bucket = 0;
+  while (0 != value) {
+    ++bucket;
+    value >>= 1;
+  }
+  return bucket;
+}
+
+/// Write the range of values of a get_log2_bucket() bucket, followed by unit.
+inline
+void
+write_log2_bucket_range(std::ostream & out, size_t bucket, const char * unit)
+{
+  if (0 == bucket) {
+    out << "0";
+  } else if (bucket < 64) {
+    out << "[" << (1ULL << (bucket - 1)) << ", " << (1ULL << bucket) << ")";
+  } else {
+    out << "[" << (1ULL << 63) << ", 18446744073709551616)";
+  }
+  out << unit;
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__PER_STACK_COUNTERS_HPP_
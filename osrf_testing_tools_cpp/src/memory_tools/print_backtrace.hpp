@@ -15,34 +15,25 @@
 #ifndef MEMORY_TOOLS__PRINT_BACKTRACE_HPP_
 #define MEMORY_TOOLS__PRINT_BACKTRACE_HPP_
 
-#if !defined(_WIN32) && !defined(__ANDROID__)
-
-# pragma GCC diagnostic push
-# ifdef __clang__
-#  pragma clang diagnostic ignored "-Wgnu-include-next"
-#  pragma clang diagnostic ignored "-Wunused-parameter"
-# endif
-
-#include "./vendor/bombela/backward-cpp/backward.hpp"
+#include <cstdio>
 
-# pragma GCC diagnostic pop
-
-#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+#include "./symbol_cache_impl.hpp"
+#include "./unwinder.hpp"
 
 namespace osrf_testing_tools_cpp
 {
 namespace memory_tools
 {
 
-template<int MaxStackDepth = 64>
+inline
 void
 print_backtrace(FILE * out = stderr)
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
-  backward::StackTrace st;
-  st.load_here(MaxStackDepth);
-  backward::Printer p;
-  p.print(st, out);
+  void * frames[STACK_CAPTURE_MAX_DEPTH];
+  const size_t depth = capture_stack(frames, get_max_stack_depth());
+  // symbolized through the cache, printing the same call site again is cheap
+  print_frames(frames, depth, get_backtrace_thread_id(), out);
 #else
   fprintf(out, "backtrace unavailable on Windows and Android\n");
 #endif  // !defined(_WIN32) && !defined(__ANDROID__)
@@ -0,0 +1,248 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "osrf_testing_tools_cpp/memory_tools/realloc_chains.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./live_allocation_table.hpp"
+#include "./per_stack_counters.hpp"
+#include "./realloc_chains_impl.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static constexpr size_t REPORTED_FRAMES_MAX = 8;
+
+/// Counters of a call stack, allocated the first time a block it allocated is reallocated.
+struct CallSiteReallocChains
+{
+  std::atomic<uint64_t> chain_count;
+  std::atomic<uint64_t> realloc_count;
+  std::atomic<uint64_t> growth_count;
+  std::atomic<uint64_t> geometric_growth_count;
+  std::atomic<uint64_t> bytes_copied;
+  std::atomic<uint64_t> max_chain_length;
+  std::atomic<uint64_t> max_size;
+};
+
+static std::atomic<bool> g_realloc_chains_enabled(false);
+
+static PerStackCounters<CallSiteReallocChains> g_call_site_realloc_chains;
+
+bool
+realloc_chains_recording_enabled() noexcept
+{
+  return g_realloc_chains_enabled.load(std::memory_order_relaxed);
+}
+
+static inline
+void
+update_maximum(std::atomic<uint64_t> & maximum, uint64_t value) noexcept
+{
+  uint64_t current = maximum.load(std::memory_order_relaxed);
+  while (value > current && !maximum.compare_exchange_weak(current, value)) {}
+}
+
+void
+realloc_chains_record(
+  uint32_t stack_id,
+  uint32_t chain_length,
+  uint64_t old_size,
+  uint64_t new_size,
+  bool moved) noexcept
+{
+  CallSiteReallocChains * chains = g_call_site_realloc_chains.get_or_create(stack_id);
+  if (nullptr == chains) {
+    return;
+  }
+  if (1 == chain_length) {
+    chains->chain_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  chains->realloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (new_size > old_size) {
+    chains->growth_count.fetch_add(1, std::memory_order_relaxed);
+    if (new_size >= old_size + old_size / 4) {
+      chains->geometric_growth_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (moved) {
+    chains->bytes_copied.fetch_add(std::min(old_size, new_size), std::memory_order_relaxed);
+  }
+  update_maximum(chains->max_chain_length, chain_length);
+  update_maximum(chains->max_size, new_size);
+}
+
+bool
+enable_realloc_chain_analysis()
+{
+  if (!create_live_allocation_table()) {
+    return false;
+  }
+  if (!g_realloc_chains_enabled.exchange(true)) {
+    // every memory operation has to reach the custom memory functions to be recorded
+    arm_interposition();
+  }
+  return true;
+}
+
+void
+disable_realloc_chain_analysis()
+{
+  if (g_realloc_chains_enabled.exchange(false)) {
+    disarm_interposition();
+  }
+}
+
+bool
+realloc_chain_analysis_enabled()
+{
+  return realloc_chains_recording_enabled();
+}
+
+void
+reset_realloc_chains()
+{
+  g_call_site_realloc_chains.for_each(
+    [](uint32_t, CallSiteReallocChains & chains) {
+      chains.chain_count.store(0, std::memory_order_relaxed);
+      chains.realloc_count.store(0, std::memory_order_relaxed);
+      chains.growth_count.store(0, std::memory_order_relaxed);
+      chains.geometric_growth_count.store(0, std::memory_order_relaxed);
+      chains.bytes_copied.store(0, std::memory_order_relaxed);
+      chains.max_chain_length.store(0, std::memory_order_relaxed);
+      chains.max_size.store(0, std::memory_order_relaxed);
+    });
+}
+
+/// Return the non-empty realloc chains with their stack id, most bytes copied first.
+static
+std::vector<std::pair<uint32_t, ReallocChains>>
+collect_realloc_chains()
+{
+  std::vector<std::pair<uint32_t, ReallocChains>> result;
+  g_call_site_realloc_chains.for_each(
+    [&result](uint32_t stack_id, const CallSiteReallocChains & counters) {
+      ReallocChains chains;
+      chains.chain_count = counters.chain_count.load(std::memory_order_relaxed);
+      chains.realloc_count = counters.realloc_count.load(std::memory_order_relaxed);
+      chains.growth_count = counters.growth_count.load(std::memory_order_relaxed);
+      chains.geometric_growth_count =
+        counters.geometric_growth_count.load(std::memory_order_relaxed);
+      chains.bytes_copied = counters.bytes_copied.load(std::memory_order_relaxed);
+      chains.max_chain_length = counters.max_chain_length.load(std::memory_order_relaxed);
+      chains.max_size = counters.max_size.load(std::memory_order_relaxed);
+      if (0 == chains.realloc_count) {
+        return;
+      }
+      void * const * frames = nullptr;
+      const size_t depth = get_interned_stack(stack_id, &frames);
+      chains.stack.assign(frames, frames + depth);
+      result.emplace_back(stack_id, std::move(chains));
+    });
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const auto & lhs, const auto & rhs) {
+      return lhs.second.bytes_copied > rhs.second.bytes_copied;
+    });
+  return result;
+}
+
+std::vector<ReallocChains>
+get_realloc_chains()
+{
+  std::vector<ReallocChains> result;
+  for (auto & chains : collect_realloc_chains()) {
+    result.push_back(std::move(chains.second));
+  }
+  return result;
+}
+
+std::string
+format_realloc_chains(size_t max_call_sites)
+{
+  // nothing allocated from here on is counted
+  ScopedRecursionGuard recursion_guard;
+  const auto call_sites = collect_realloc_chains();
+  size_t missing_reserve_call_sites = 0;
+  for (const auto & call_site : call_sites) {
+    missing_reserve_call_sites += call_site.second.is_missing_reserve() ? 1 : 0;
+  }
+  std::ostringstream out;
+  out << call_sites.size() << " call site(s) had blocks reallocated, " <<
+    missing_reserve_call_sites << " missing a reserve()\n";
+  out << std::fixed << std::setprecision(1);
+  for (size_t i = 0; i < call_sites.size() && i < max_call_sites; ++i) {
+    const ReallocChains & chains = call_sites[i].second;
+    out << chains.chain_count << " block(s) reallocated " << chains.realloc_count <<
+      " time(s), " << chains.average_chain_length() << " on average and at most " <<
+      chains.max_chain_length << ", " << chains.bytes_copied << " bytes copied, up to " <<
+      chains.max_size << " bytes, allocated from:\n" <<
+      format_interned_stack(call_sites[i].first, REPORTED_FRAMES_MAX, "  ");
+    if (chains.is_missing_reserve()) {
+      out << "  missing reserve: the blocks grow " <<
+        (chains.grows_geometrically() ? "geometrically" : "in small steps") <<
+        ", consider allocating " << chains.max_size << " bytes up front\n";
+    }
+  }
+  if (call_sites.size() > max_call_sites) {
+    out << (call_sites.size() - max_call_sites) << " more call site(s)\n";
+  }
+  return out.str();
+}
+
+static
+void
+report_realloc_chains_at_exit()
+{
+  disable_realloc_chain_analysis();
+  // nothing allocated to build the report should be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  const std::string report = format_realloc_chains();
+  SAFE_FWRITE(stderr, "[memory_tools][INFO] realloc chains by call site: ");
+  SAFE_FWRITE(stderr, report.c_str());
+}
+
+/// Enables the realloc chain analysis, if requested, when the library is loaded.
+static struct ReallocChainsInitializer
+{
+  ReallocChainsInitializer()
+  {
+    if (
+      environment_variable_is_enabled("MEMORY_TOOLS_REALLOC_CHAINS") &&
+      enable_realloc_chain_analysis())
+    {
+      std::atexit(report_realloc_chains_at_exit);
+    }
+  }
+} g_realloc_chains_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,46 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__REALLOC_CHAINS_IMPL_HPP_
+#define MEMORY_TOOLS__REALLOC_CHAINS_IMPL_HPP_
+
+#include <cstdint>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if realloc chains are being followed, see enable_realloc_chain_analysis().
+bool
+realloc_chains_recording_enabled() noexcept;
+
+/// Called by the live allocation table for each realloc of a known block.
+/**
+ * chain_length is the number of reallocs of the block including this one,
+ * and stack_id the stack of the allocation which started the chain.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+void
+realloc_chains_record(
+  uint32_t stack_id,
+  uint32_t chain_length,
+  uint64_t old_size,
+  uint64_t new_size,
+  bool moved) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__REALLOC_CHAINS_IMPL_HPP_
@@ -0,0 +1,42 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./recursion_guard.hpp"
+
+#include <cstddef>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static thread_local size_t g_tls_recursion_depth = 0;
+
+bool
+recursion_guard_active() noexcept
+{
+  return 0 != g_tls_recursion_depth;
+}
+
+ScopedRecursionGuard::ScopedRecursionGuard() noexcept
+: recursed_(0 != g_tls_recursion_depth++)
+{}
+
+ScopedRecursionGuard::~ScopedRecursionGuard()
+{
+  g_tls_recursion_depth--;
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
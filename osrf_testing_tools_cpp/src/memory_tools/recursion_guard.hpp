@@ -0,0 +1,62 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__RECURSION_GUARD_HPP_
+#define MEMORY_TOOLS__RECURSION_GUARD_HPP_
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if a ScopedRecursionGuard is alive in the current thread.
+bool
+recursion_guard_active() noexcept;
+
+/// Scoped guard against the memory functions recursing into themselves, thread-specific.
+/**
+ * Each custom memory function creates one of these before doing anything
+ * which might call a memory function again, e.g. calling user callbacks,
+ * printing or capturing a backtrace.
+ * If a guard was already alive in this thread when another is created, then
+ * the new one reports recursed() and the caller should use the original
+ * memory function directly.
+ *
+ * This replaces searching the backtrace for the custom memory function,
+ * costing a thread-local increment and decrement instead.
+ */
+class ScopedRecursionGuard
+{
+public:
+  ScopedRecursionGuard() noexcept;
+  ~ScopedRecursionGuard();
+
+  ScopedRecursionGuard(const ScopedRecursionGuard &) = delete;
+  ScopedRecursionGuard & operator=(const ScopedRecursionGuard &) = delete;
+
+  /// Return true if this guard was created while another was already alive.
+  bool
+  recursed() const noexcept
+  {
+    return recursed_;
+  }
+
+private:
+  bool recursed_;
+};
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__RECURSION_GUARD_HPP_
@@ -12,8 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "./dispatch_callback.hpp"
 #include "./implementation_monitoring_override.hpp"
+#include "./memory_event.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/register_hooks.hpp"
 
 namespace osrf_testing_tools_cpp
@@ -25,108 +32,379 @@ static std::atomic<AnyMemoryToolsCallback *> g_on_malloc_callback(nullptr);
 static std::atomic<AnyMemoryToolsCallback *> g_on_realloc_callback(nullptr);
 static std::atomic<AnyMemoryToolsCallback *> g_on_calloc_callback(nullptr);
 static std::atomic<AnyMemoryToolsCallback *> g_on_free_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_aligned_alloc_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_operator_new_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_operator_delete_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_mmap_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_mremap_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_munmap_callback(nullptr);
+static std::atomic<AnyMemoryToolsCallback *> g_on_brk_callback(nullptr);
+
+/// Return a copy of the given callback, or nullptr if it is not set.
+/** Unsetting a callback then leaves nothing allocated, which would look like a leak. */
+static
+AnyMemoryToolsCallback *
+copy_callback(const AnyMemoryToolsCallback & callback)
+{
+  if (std::holds_alternative<std::nullptr_t>(callback)) {
+    return nullptr;
+  }
+  return new AnyMemoryToolsCallback(callback);
+}
+
+/// Return the given callback, or the fallback if it is not set.
+static
+const AnyMemoryToolsCallback *
+callback_or_fallback(
+  const AnyMemoryToolsCallback * callback,
+  const AnyMemoryToolsCallback * fallback)
+{
+  if (nullptr == callback || std::holds_alternative<std::nullptr_t>(*callback)) {
+    return fallback;
+  }
+  return callback;
+}
+
+// A replaced callback may still be running in another thread, so it is only deleted once every
+// dispatch which could have loaded it has returned.
+// Dispatches count themselves in one of two reader counts, picked by the parity of the epoch.
+// Replacing a callback flips the epoch twice, each time waiting for the reader counts new
+// dispatches no longer use to drain, so neither a steady stream of dispatches nor one stalled
+// between reading the epoch and counting itself can make it delete a callback in use.
+// The reader counts are sharded by thread, each shard on its own cache line, so that threads
+// dispatching concurrently do not contend, and only replacing a callback reads all of them.
+static std::atomic<uint64_t> g_hook_epoch(0);
+
+// Number of reader count shards, threads beyond it share them.
+static constexpr size_t HOOK_READER_SHARD_COUNT = 64;
+
+/// Reader counts of the threads mapped to a shard, see get_thread_index().
+struct alignas(64) HookReaderShard
+{
+  std::atomic<size_t> readers[2];
+};
+
+static HookReaderShard g_hook_reader_shards[HOOK_READER_SHARD_COUNT];
+// Number of dispatches in progress in this thread.
+static thread_local size_t g_tls_hook_reads = 0;
+// Serializes the epoch flips, never taken from within a dispatch.
+static std::mutex g_hook_synchronize_mutex;
+// Callbacks replaced from within a dispatch, which cannot wait for itself.
+static std::mutex g_retired_callbacks_mutex;
+static std::vector<AnyMemoryToolsCallback *> g_retired_callbacks;
+
+/// Keeps the callbacks loaded while in scope from being deleted.
+class ScopedHookReader
+{
+public:
+  ScopedHookReader()
+  : readers_(
+      g_hook_reader_shards[get_thread_index() % HOOK_READER_SHARD_COUNT]
+      .readers[g_hook_epoch.load() & 1])
+  {
+    readers_.fetch_add(1);
+    ++g_tls_hook_reads;
+  }
+
+  ~ScopedHookReader()
+  {
+    --g_tls_hook_reads;
+    readers_.fetch_sub(1);
+  }
 
+private:
+  std::atomic<size_t> & readers_;
+};
+
+/// Wait until no dispatch which began before this call is still in progress.
+/** Must not be called from within a dispatch. */
+static
 void
-on_malloc(AnyMemoryToolsCallback callback)
+synchronize_hooks()
+{
+  std::lock_guard<std::mutex> lock(g_hook_synchronize_mutex);
+  for (int flip = 0; flip < 2; ++flip) {
+    const size_t parity = g_hook_epoch.fetch_add(1) & 1;
+    for (auto & shard : g_hook_reader_shards) {
+      while (0 != shard.readers[parity].load()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+}
+
+/// Replace the callback of the given hook, and delete the old one once no dispatch can use it.
+static
+void
+replace_callback(
+  std::atomic<AnyMemoryToolsCallback *> & hook,
+  const AnyMemoryToolsCallback & callback)
 {
   // prevents new from triggering existing hooks
   ScopedImplementationSection implementation_section;
-  // duplicate user callback and then delete the old one
-  auto old = g_on_malloc_callback.exchange(new AnyMemoryToolsCallback(callback));
-  if (nullptr != old) {
-    delete old;
+  AnyMemoryToolsCallback * old = hook.exchange(copy_callback(callback));
+  std::vector<AnyMemoryToolsCallback *> retired;
+  {
+    std::lock_guard<std::mutex> lock(g_retired_callbacks_mutex);
+    if (0 != g_tls_hook_reads) {
+      // called by a callback, possibly the old one, so a later replacement deletes it
+      if (nullptr != old) {
+        g_retired_callbacks.push_back(old);
+      }
+      return;
+    }
+    retired.swap(g_retired_callbacks);
+  }
+  if (nullptr == old && retired.empty()) {
+    return;
+  }
+  synchronize_hooks();
+  delete old;
+  for (AnyMemoryToolsCallback * retired_callback : retired) {
+    delete retired_callback;
   }
 }
 
+/// Return a copy of the callback of the given hook, or nullptr if it is not set.
+static
 AnyMemoryToolsCallback
-get_on_malloc()
+get_callback(const std::atomic<AnyMemoryToolsCallback *> & hook)
 {
-  auto current = g_on_malloc_callback.load();
+  ScopedHookReader reader;
+  auto current = hook.load();
   if (current) {
     return *current;
   }
   return nullptr;
 }
 
+/// Call the callback of the given hook, if it is set.
+static
+void
+dispatch_hook(const std::atomic<AnyMemoryToolsCallback *> & hook, MemoryToolsService & service)
+{
+  if (nullptr == hook.load(std::memory_order_relaxed)) {
+    // no callback to keep alive, which is the common case
+    return;
+  }
+  ScopedHookReader reader;
+  dispatch_callback(hook.load(), service);
+}
+
+/// Call the callback of the given hook, or of the fallback hook if it is not set.
+static
+void
+dispatch_hook_or_fallback(
+  const std::atomic<AnyMemoryToolsCallback *> & hook,
+  const std::atomic<AnyMemoryToolsCallback *> & fallback,
+  MemoryToolsService & service)
+{
+  if (
+    nullptr == hook.load(std::memory_order_relaxed) &&
+    nullptr == fallback.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  ScopedHookReader reader;
+  dispatch_callback(callback_or_fallback(hook.load(), fallback.load()), service);
+}
+
+void
+on_malloc(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_malloc_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_malloc()
+{
+  return get_callback(g_on_malloc_callback);
+}
+
 void
 dispatch_malloc(MemoryToolsService & service)
 {
-  dispatch_callback(g_on_malloc_callback.load(), service);
+  dispatch_hook(g_on_malloc_callback, service);
 }
 
 void
 on_realloc(AnyMemoryToolsCallback callback)
 {
-  // prevents new from triggering existing hooks
-  ScopedImplementationSection implementation_section;
-  // duplicate user callback and then delete the old one
-  delete g_on_realloc_callback.exchange(new AnyMemoryToolsCallback(callback));
+  replace_callback(g_on_realloc_callback, callback);
 }
 
 AnyMemoryToolsCallback
 get_on_realloc()
 {
-  auto current = g_on_realloc_callback.load();
-  if (current) {
-    return *current;
-  }
-  return nullptr;
+  return get_callback(g_on_realloc_callback);
 }
 
 void
 dispatch_realloc(MemoryToolsService & service)
 {
-  dispatch_callback(g_on_realloc_callback.load(), service);
+  dispatch_hook(g_on_realloc_callback, service);
 }
 
 void
 on_calloc(AnyMemoryToolsCallback callback)
 {
-  // prevents new from triggering existing hooks
-  ScopedImplementationSection implementation_section;
-  // duplicate user callback and then delete the old one
-  delete g_on_calloc_callback.exchange(new AnyMemoryToolsCallback(callback));
+  replace_callback(g_on_calloc_callback, callback);
 }
 
 AnyMemoryToolsCallback
 get_on_calloc()
 {
-  auto current = g_on_calloc_callback.load();
-  if (current) {
-    return *current;
-  }
-  return nullptr;
+  return get_callback(g_on_calloc_callback);
 }
 
 void
 dispatch_calloc(MemoryToolsService & service)
 {
-  dispatch_callback(g_on_calloc_callback.load(), service);
+  dispatch_hook(g_on_calloc_callback, service);
 }
 
 void
 on_free(AnyMemoryToolsCallback callback)
 {
-  // prevents new from triggering existing hooks
-  ScopedImplementationSection implementation_section;
-  // duplicate user callback and then delete the old one
-  delete g_on_free_callback.exchange(new AnyMemoryToolsCallback(callback));
+  replace_callback(g_on_free_callback, callback);
 }
 
 AnyMemoryToolsCallback
 get_on_free()
 {
-  auto current = g_on_free_callback.load();
-  if (current) {
-    return *current;
-  }
-  return nullptr;
+  return get_callback(g_on_free_callback);
 }
 
 void
 dispatch_free(MemoryToolsService & service)
 {
-  dispatch_callback(g_on_free_callback.load(), service);
+  dispatch_hook(g_on_free_callback, service);
+}
+
+void
+on_aligned_alloc(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_aligned_alloc_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_aligned_alloc()
+{
+  return get_callback(g_on_aligned_alloc_callback);
+}
+
+void
+dispatch_aligned_alloc(MemoryToolsService & service)
+{
+  dispatch_hook(g_on_aligned_alloc_callback, service);
+}
+
+void
+on_operator_new(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_operator_new_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_operator_new()
+{
+  return get_callback(g_on_operator_new_callback);
+}
+
+void
+dispatch_operator_new(MemoryToolsService & service)
+{
+  dispatch_hook_or_fallback(g_on_operator_new_callback, g_on_malloc_callback, service);
+}
+
+void
+on_operator_delete(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_operator_delete_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_operator_delete()
+{
+  return get_callback(g_on_operator_delete_callback);
+}
+
+void
+dispatch_operator_delete(MemoryToolsService & service)
+{
+  dispatch_hook_or_fallback(g_on_operator_delete_callback, g_on_free_callback, service);
+}
+
+void
+on_mmap(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_mmap_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_mmap()
+{
+  return get_callback(g_on_mmap_callback);
+}
+
+void
+dispatch_mmap(MemoryToolsService & service)
+{
+  dispatch_hook(g_on_mmap_callback, service);
+}
+
+void
+on_mremap(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_mremap_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_mremap()
+{
+  return get_callback(g_on_mremap_callback);
+}
+
+void
+dispatch_mremap(MemoryToolsService & service)
+{
+  dispatch_hook(g_on_mremap_callback, service);
+}
+
+void
+on_munmap(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_munmap_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_munmap()
+{
+  return get_callback(g_on_munmap_callback);
+}
+
+void
+dispatch_munmap(MemoryToolsService & service)
+{
+  dispatch_hook(g_on_munmap_callback, service);
+}
+
+void
+on_brk(AnyMemoryToolsCallback callback)
+{
+  replace_callback(g_on_brk_callback, callback);
+}
+
+AnyMemoryToolsCallback
+get_on_brk()
+{
+  return get_callback(g_on_brk_callback);
+}
+
+void
+dispatch_brk(MemoryToolsService & service)
+{
+  dispatch_hook(g_on_brk_callback, service);
 }
 
 }  // namespace memory_tools
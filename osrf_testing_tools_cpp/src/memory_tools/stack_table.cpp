@@ -0,0 +1,239 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./stack_table.hpp"
+#include "./unwinder.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+#include <vector>
+
+#include "./symbol_cache_impl.hpp"
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// Must be a power of two, like STACK_TABLE_CAPACITY, the memory is only committed as it is used.
+static constexpr size_t STACK_TABLE_FRAME_POOL_SIZE = 1 << 19;
+// Bounds the cost of interning a new stack, the table is considered full if no slot is free within.
+static constexpr size_t STACK_TABLE_PROBE_LIMIT = 32;
+
+static constexpr uint32_t FRAMES_UNPUBLISHED = 0;
+static constexpr uint32_t FRAMES_UNAVAILABLE = std::numeric_limits<uint32_t>::max();
+
+/// A slot of the open addressing hash table.
+/**
+ * A slot is claimed by setting its hash from 0, and published by setting
+ * frames_begin, after which it never changes again.
+ */
+struct StackTableSlot
+{
+  std::atomic<uint64_t> hash;
+  /// Index of the first frame in the frame pool plus one, or one of the FRAMES_* values.
+  std::atomic<uint32_t> frames_begin;
+  uint32_t depth;
+};
+
+static StackTableSlot g_slots[STACK_TABLE_CAPACITY];
+static void * g_frame_pool[STACK_TABLE_FRAME_POOL_SIZE];
+static std::atomic<size_t> g_frame_pool_used(0);
+static std::atomic<size_t> g_interned_stack_count(0);
+// Set once a stack could not be interned, after which every stack is the unknown stack.
+static std::atomic<bool> g_stack_table_full(false);
+
+static
+uint64_t
+hash_frames(void * const * frames, size_t depth) noexcept
+{
+  uint64_t hash = 0xcbf29ce484222325ULL ^ depth;
+  for (size_t i = 0; i < depth; ++i) {
+    hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(frames[i]));
+    hash *= 0x100000001b3ULL;
+    hash ^= hash >> 29;
+  }
+  // 0 marks an empty slot
+  return (0 == hash) ? 1 : hash;
+}
+
+static
+bool
+slot_matches(const StackTableSlot & slot, void * const * frames, size_t depth) noexcept
+{
+  // wait for a concurrent insertion of the same hash to be published, it is only a copy
+  uint32_t frames_begin = slot.frames_begin.load(std::memory_order_acquire);
+  while (FRAMES_UNPUBLISHED == frames_begin) {
+    std::this_thread::yield();
+    frames_begin = slot.frames_begin.load(std::memory_order_acquire);
+  }
+  if (FRAMES_UNAVAILABLE == frames_begin || slot.depth != depth) {
+    return false;
+  }
+  void * const * slot_frames = &g_frame_pool[frames_begin - 1];
+  for (size_t i = 0; i < depth; ++i) {
+    if (slot_frames[i] != frames[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Copy the frames into a claimed slot and publish it, returning false if out of space.
+static
+bool
+publish_slot(StackTableSlot & slot, void * const * frames, size_t depth) noexcept
+{
+  const size_t begin = g_frame_pool_used.fetch_add(depth, std::memory_order_relaxed);
+  if (begin + depth > STACK_TABLE_FRAME_POOL_SIZE) {
+    slot.frames_begin.store(FRAMES_UNAVAILABLE, std::memory_order_release);
+    g_stack_table_full.store(true, std::memory_order_relaxed);
+    return false;
+  }
+  for (size_t i = 0; i < depth; ++i) {
+    g_frame_pool[begin + i] = frames[i];
+  }
+  slot.depth = static_cast<uint32_t>(depth);
+  slot.frames_begin.store(static_cast<uint32_t>(begin + 1), std::memory_order_release);
+  g_interned_stack_count.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+uint32_t
+intern_stack(void * const * frames, size_t depth) noexcept
+{
+  if (g_stack_table_full.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+  if (depth > STACK_TABLE_MAX_DEPTH) {
+    depth = STACK_TABLE_MAX_DEPTH;
+  }
+  const uint64_t hash = hash_frames(frames, depth);
+  for (size_t probe = 0; probe < STACK_TABLE_PROBE_LIMIT; ++probe) {
+    const size_t index = (hash + probe) & (STACK_TABLE_CAPACITY - 1);
+    StackTableSlot & slot = g_slots[index];
+    uint64_t slot_hash = slot.hash.load(std::memory_order_acquire);
+    if (0 == slot_hash) {
+      if (slot.hash.compare_exchange_strong(slot_hash, hash, std::memory_order_acq_rel)) {
+        return publish_slot(slot, frames, depth) ? static_cast<uint32_t>(index + 1) : 0;
+      }
+      // lost the race for this slot, slot_hash now holds the winner's hash
+    }
+    if (slot_hash == hash && slot_matches(slot, frames, depth)) {
+      return static_cast<uint32_t>(index + 1);
+    }
+  }
+  g_stack_table_full.store(true, std::memory_order_relaxed);
+  return 0;
+}
+
+uint32_t
+capture_stack_id() noexcept
+{
+  void * frames[STACK_TABLE_MAX_DEPTH];
+  size_t max_depth = get_max_stack_depth();
+  if (max_depth > STACK_TABLE_MAX_DEPTH) {
+    max_depth = STACK_TABLE_MAX_DEPTH;
+  }
+  const size_t depth = capture_stack(frames, max_depth);
+  if (0 == depth) {
+    return 0;
+  }
+  return intern_stack(frames, depth);
+}
+
+size_t
+get_interned_stack(uint32_t stack_id, void * const ** frames) noexcept
+{
+  if (0 == stack_id || stack_id > STACK_TABLE_CAPACITY) {
+    return 0;
+  }
+  const StackTableSlot & slot = g_slots[stack_id - 1];
+  const uint32_t frames_begin = slot.frames_begin.load(std::memory_order_acquire);
+  if (FRAMES_UNPUBLISHED == frames_begin || FRAMES_UNAVAILABLE == frames_begin) {
+    return 0;
+  }
+  *frames = &g_frame_pool[frames_begin - 1];
+  return slot.depth;
+}
+
+size_t
+get_interned_stack_count() noexcept
+{
+  return g_interned_stack_count.load(std::memory_order_relaxed);
+}
+
+void
+write_interned_stacks(FILE * out)
+{
+  for (uint32_t stack_id = 1; stack_id <= STACK_TABLE_CAPACITY; ++stack_id) {
+    void * const * frames = nullptr;
+    const size_t depth = get_interned_stack(stack_id, &frames);
+    if (0 == depth) {
+      continue;
+    }
+    fprintf(out, "stack %" PRIu32 "\n", stack_id);
+#if !defined(_WIN32) && !defined(__ANDROID__)
+    // frames shared between stacks, e.g. main(), are only symbolized once
+    std::vector<backward::ResolvedTrace> resolved_traces = resolve_frames(frames, depth);
+    for (const auto & resolved : resolved_traces) {
+      fprintf(out, "  #%-2zu %p in %s at %s\n",
+        resolved.idx, resolved.addr, resolved.object_function.c_str(),
+        resolved.object_filename.c_str());
+    }
+#else
+    for (size_t i = 0; i < depth; ++i) {
+      fprintf(out, "  #%-2zu %p\n", i, frames[i]);
+    }
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+  }
+}
+
+std::string
+format_interned_stack(uint32_t stack_id, size_t max_depth, const char * indent)
+{
+  std::ostringstream out;
+  void * const * frames = nullptr;
+  size_t depth = get_interned_stack(stack_id, &frames);
+  if (0 == depth) {
+    out << indent << "<unknown stack>\n";
+    return out.str();
+  }
+  if (depth > max_depth) {
+    depth = max_depth;
+  }
+#if !defined(_WIN32) && !defined(__ANDROID__)
+  for (const auto & resolved : resolve_frames(frames, depth)) {
+    out << indent << "#" << resolved.idx << " " << resolved.addr << " in " <<
+      resolved.object_function << " at " << resolved.object_filename << "\n";
+  }
+#else
+  for (size_t i = 0; i < depth; ++i) {
+    out << indent << "#" << i << " " << frames[i] << "\n";
+  }
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+  return out.str();
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
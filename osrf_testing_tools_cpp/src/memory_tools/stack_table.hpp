@@ -0,0 +1,83 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__STACK_TABLE_HPP_
+#define MEMORY_TOOLS__STACK_TABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Maximum number of frames stored for an interned stack, deeper stacks are truncated.
+static constexpr size_t STACK_TABLE_MAX_DEPTH = 32;
+
+/// Number of unique stacks the table can hold, stack ids go from 1 to this value.
+static constexpr size_t STACK_TABLE_CAPACITY = 1 << 16;
+
+/// Return a compact id for the given program counters, adding them to the table if new.
+/**
+ * The table is process-wide, lock-free and never shrinks, so a stack id is
+ * valid until the process exits and the same frames always get the same id.
+ * Once the table is full, i.e. a new stack found no free slot within a few
+ * probes, every call returns 0, the unknown stack, right away.
+ */
+uint32_t
+intern_stack(void * const * frames, size_t depth) noexcept;
+
+/// Capture the program counters of the calling thread with capture_stack() and intern them.
+/**
+ * Does not allocate, except possibly the first time in the unwinder, and
+ * does not symbolize anything.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+uint32_t
+capture_stack_id() noexcept;
+
+/// Get the frames of an interned stack, returning the number of frames.
+/** Returns 0, with frames unset, for unknown or invalid stack ids. */
+size_t
+get_interned_stack(uint32_t stack_id, void * const ** frames) noexcept;
+
+/// Return the number of unique stacks interned so far.
+size_t
+get_interned_stack_count() noexcept;
+
+/// Write every interned stack, symbolized, to the given file.
+/**
+ * Each frame is symbolized once per unique stack, no matter how many memory
+ * operations refer to the stack.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+void
+write_interned_stacks(FILE * out);
+
+/// Return the frames of an interned stack, symbolized, one line per frame starting with indent.
+/**
+ * At most max_depth frames are given, and "<unknown stack>" for an unknown
+ * or invalid stack id.
+ * Must be called with a ScopedRecursionGuard alive in this thread.
+ */
+std::string
+format_interned_stack(uint32_t stack_id, size_t max_depth, const char * indent);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__STACK_TABLE_HPP_
@@ -103,6 +103,7 @@ const std::string &
 Trace::object_filename() const
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
+  impl_->resolve();
   return impl_->resolved_trace.object_filename;
 #else
   throw std::runtime_error("not implemented on Windows or Android");
@@ -113,6 +114,7 @@ const std::string &
 Trace::object_function() const
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
+  impl_->resolve();
   return impl_->resolved_trace.object_function;
 #else
   throw std::runtime_error("not implemented on Windows or Android");
@@ -123,6 +125,7 @@ const SourceLocation &
 Trace::source_location() const
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
+  impl_->resolve();
   return impl_->source_location;
 #else
   throw std::runtime_error("not implemented on Windows or Android");
@@ -133,6 +136,7 @@ const std::vector<SourceLocation> &
 Trace::inlined_source_locations() const
 {
 #if !defined(_WIN32) && !defined(__ANDROID__)
+  impl_->resolve();
   return impl_->inlined_source_locations;
 #else
   throw std::runtime_error("not implemented on Windows or Android");
@@ -15,21 +15,18 @@
 #ifndef OSRF_TESTING_TOOLS_CPP__STACK_TRACE_IMPL_HPP_
 #define OSRF_TESTING_TOOLS_CPP__STACK_TRACE_IMPL_HPP_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "osrf_testing_tools_cpp/memory_tools/stack_trace.hpp"
 
 #if !defined(_WIN32) && !defined(__ANDROID__)
 
-#pragma GCC diagnostic push
-#ifdef __clang__
-# pragma clang diagnostic ignored "-Wgnu-include-next"
-# pragma clang diagnostic ignored "-Wunused-parameter"
-#endif
-#include "./vendor/bombela/backward-cpp/backward.hpp"
-#pragma GCC diagnostic pop
+#include "./symbol_cache_impl.hpp"
 
 namespace osrf_testing_tools_cpp
 {
@@ -48,48 +45,81 @@ struct SourceLocationImpl
   const backward::ResolvedTrace::SourceLoc * source_location;
 };
 
+/// A frame of a stack trace, symbolized only when something other than its address is read.
 struct TraceImpl
 {
   TraceImpl() = delete;
 
-  TraceImpl(backward::TraceResolver * trace_resolver, const backward::Trace & trace)
-  : TraceImpl(trace_resolver->resolve(trace))
-  {}
-
   TraceImpl(const TraceImpl & other)
-  : TraceImpl(other.resolved_trace)
-  {}
+  : TraceImpl(other.resolved_trace.addr, other.resolved_trace.idx, other.frame_resolver)
+  {
+    if (other.resolved.load(std::memory_order_acquire)) {
+      set_resolved_trace(other.resolved_trace);
+    }
+  }
 
-  explicit TraceImpl(backward::ResolvedTrace resolved_trace_input)
-  : resolved_trace(resolved_trace_input),
-    source_location(
-      std::unique_ptr<SourceLocationImpl>(new SourceLocationImpl(&resolved_trace.source)))
+  TraceImpl(void * address, size_t index, std::shared_ptr<FrameResolver> frame_resolver_input)
+  : source_location(
+      std::unique_ptr<SourceLocationImpl>(new SourceLocationImpl(&resolved_trace.source))),
+    frame_resolver(std::move(frame_resolver_input))
   {
+    resolved_trace.addr = address;
+    resolved_trace.idx = index;
+  }
+
+  virtual ~TraceImpl() {}
+
+  /// Symbolize the frame through the symbol cache, if not done yet.
+  void
+  resolve()
+  {
+    if (resolved.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(resolve_mutex);
+    if (!resolved.load(std::memory_order_relaxed)) {
+      set_resolved_trace(frame_resolver->resolve(resolved_trace.idx));
+    }
+  }
+
+  backward::ResolvedTrace resolved_trace;
+  // points into resolved_trace, so it is only valid once resolved
+  SourceLocation source_location;
+  std::vector<SourceLocation> inlined_source_locations;
+  // shared with the other frames of the stack trace, and with copies of this frame
+  std::shared_ptr<FrameResolver> frame_resolver;
+
+private:
+  void
+  set_resolved_trace(const backward::ResolvedTrace & resolved_trace_input)
+  {
+    const size_t index = resolved_trace.idx;
+    resolved_trace = resolved_trace_input;
+    resolved_trace.idx = index;
     inlined_source_locations.reserve(resolved_trace.inliners.size());
     for (const auto & inliner : resolved_trace.inliners) {
       inlined_source_locations.emplace_back(
         std::shared_ptr<SourceLocationImpl>(new SourceLocationImpl(&inliner))
       );
     }
+    resolved.store(true, std::memory_order_release);
   }
 
-  virtual ~TraceImpl() {}
-
-  backward::ResolvedTrace resolved_trace;
-  SourceLocation source_location;
-  std::vector<SourceLocation> inlined_source_locations;
+  std::mutex resolve_mutex;
+  std::atomic<bool> resolved{false};
 };
 
 struct StackTraceImpl
 {
   StackTraceImpl() = delete;
-  explicit StackTraceImpl(backward::StackTrace st, std::thread::id tid)
-  : stack_trace(st), thread_id(tid)
+  StackTraceImpl(void * const * frames, size_t depth, std::thread::id tid)
+  : thread_id(tid)
   {
-    trace_resolver.load_stacktrace(stack_trace);
-    traces.reserve(stack_trace.size());
-    for (size_t i = 0; i < stack_trace.size(); ++i) {
-      std::unique_ptr<TraceImpl> tmp(new TraceImpl(&trace_resolver, stack_trace[i]));
+    // only the addresses are stored, each frame is symbolized when it is first read
+    std::shared_ptr<FrameResolver> frame_resolver(new FrameResolver(frames, depth));
+    traces.reserve(depth);
+    for (size_t i = 0; i < depth; ++i) {
+      std::unique_ptr<TraceImpl> tmp(new TraceImpl(frames[i], i, frame_resolver));
       traces.emplace_back(
         std::move(tmp)
       );
@@ -98,9 +128,7 @@ struct StackTraceImpl
 
   virtual ~StackTraceImpl() {}
 
-  backward::StackTrace stack_trace;
   std::thread::id thread_id;
-  backward::TraceResolver trace_resolver;
   std::vector<Trace> traces;
 };
 
@@ -0,0 +1,259 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./get_environment_variable.hpp"
+#include "./symbol_cache_impl.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/symbol_cache.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+
+static
+size_t
+get_symbol_cache_capacity_from_env()
+{
+  char value[32];
+  if (!get_environment_variable("MEMORY_TOOLS_SYMBOL_CACHE_SIZE", value, sizeof(value))) {
+    return 16384;
+  }
+  return static_cast<size_t>(std::strtoull(value, nullptr, 10));
+}
+
+/// Least recently used cache from frame address to its symbolization.
+class SymbolCache
+{
+public:
+  SymbolCache()
+  : capacity_(get_symbol_cache_capacity_from_env())
+  {}
+
+  /// Copy the cached symbolization into result and return true, if there is one.
+  bool
+  lookup(void * address, backward::ResolvedTrace & result)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(address);
+    if (index_.end() == it) {
+      misses_++;
+      return false;
+    }
+    hits_++;
+    // move it to the front, as the most recently used
+    entries_.splice(entries_.begin(), entries_, it->second);
+    result = it->second->second;
+    return true;
+  }
+
+  void
+  insert(void * address, const backward::ResolvedTrace & resolved)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (0 == capacity_ || index_.end() != index_.find(address)) {
+      // another thread may have resolved the same address in the meantime
+      return;
+    }
+    entries_.emplace_front(address, resolved);
+    index_[address] = entries_.begin();
+    evict_to(capacity_);
+  }
+
+  SymbolCacheStatistics
+  get_statistics()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_, misses_, evictions_, index_.size(), capacity_};
+  }
+
+  void
+  set_capacity(size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    evict_to(capacity_);
+  }
+
+private:
+  void
+  evict_to(size_t capacity)
+  {
+    while (index_.size() > capacity) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+      evictions_++;
+    }
+  }
+
+  using Entry = std::pair<void *, backward::ResolvedTrace>;
+
+  std::mutex mutex_;
+  std::list<Entry> entries_;
+  std::unordered_map<void *, std::list<Entry>::iterator> index_;
+  size_t capacity_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+};
+
+static
+SymbolCache &
+get_symbol_cache()
+{
+  // never destroyed, the reports printed at exit may still symbolize after static destructors ran
+  static SymbolCache * symbol_cache = new SymbolCache();
+  return *symbol_cache;
+}
+
+std::vector<backward::ResolvedTrace>
+resolve_frames(void * const * frames, size_t count)
+{
+  SymbolCache & symbol_cache = get_symbol_cache();
+  std::vector<backward::ResolvedTrace> result(count);
+  std::vector<void *> missing_frames;
+  std::vector<size_t> missing_indexes;
+  for (size_t i = 0; i < count; ++i) {
+    if (!symbol_cache.lookup(frames[i], result[i])) {
+      missing_frames.push_back(frames[i]);
+      missing_indexes.push_back(i);
+    }
+  }
+  if (!missing_frames.empty()) {
+    // the resolver is only created if needed, creating it is not free either
+    backward::TraceResolver trace_resolver;
+    trace_resolver.load_addresses(missing_frames.data(), static_cast<int>(missing_frames.size()));
+    for (size_t i = 0; i < missing_frames.size(); ++i) {
+      backward::ResolvedTrace resolved = trace_resolver.resolve(
+        backward::ResolvedTrace(backward::Trace(missing_frames[i], i)));
+      symbol_cache.insert(missing_frames[i], resolved);
+      result[missing_indexes[i]] = std::move(resolved);
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    result[i].addr = frames[i];
+    result[i].idx = i;
+  }
+  return result;
+}
+
+FrameResolver::FrameResolver(void * const * frames, size_t count)
+: frames_(frames, frames + count)
+{}
+
+backward::ResolvedTrace
+FrameResolver::resolve(size_t index)
+{
+  SymbolCache & symbol_cache = get_symbol_cache();
+  void * frame = frames_[index];
+  backward::ResolvedTrace resolved;
+  if (!symbol_cache.lookup(frame, resolved)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!trace_resolver_) {
+      // the addresses are loaded once, the resolver may symbolize them all at once
+      trace_resolver_.reset(new backward::TraceResolver());
+      trace_resolver_->load_addresses(frames_.data(), static_cast<int>(frames_.size()));
+    }
+    resolved = trace_resolver_->resolve(backward::ResolvedTrace(backward::Trace(frame, index)));
+    symbol_cache.insert(frame, resolved);
+  }
+  resolved.addr = frame;
+  resolved.idx = index;
+  return resolved;
+}
+
+static
+void
+print_source_location(
+  FILE * out, const char * indent, const backward::ResolvedTrace::SourceLoc & source_location)
+{
+  fprintf(out, "%sSource \"%s\", line %u, in %s\n",
+    indent, source_location.filename.c_str(), source_location.line,
+    source_location.function.c_str());
+}
+
+void
+print_frames(void * const * frames, size_t count, size_t thread_id, FILE * out)
+{
+  std::vector<backward::ResolvedTrace> resolved_traces = resolve_frames(frames, count);
+  if (0 != thread_id) {
+    fprintf(out, "Stack trace (most recent call last) in thread %zu:\n", thread_id);
+  } else {
+    fprintf(out, "Stack trace (most recent call last):\n");
+  }
+  for (size_t i = count; i > 0; --i) {
+    const backward::ResolvedTrace & trace = resolved_traces[i - 1];
+    fprintf(out, "#%-2zu", trace.idx);
+    bool already_indented = true;
+    if (trace.source.filename.empty()) {
+      fprintf(out, "   Object \"%s\", at %p, in %s\n",
+        trace.object_filename.c_str(), trace.addr, trace.object_function.c_str());
+      already_indented = false;
+    }
+    for (size_t inliner_index = trace.inliners.size(); inliner_index > 0; --inliner_index) {
+      if (!already_indented) {
+        fprintf(out, "   ");
+      }
+      print_source_location(out, " | ", trace.inliners[inliner_index - 1]);
+      already_indented = false;
+    }
+    if (!trace.source.filename.empty()) {
+      if (!already_indented) {
+        fprintf(out, "   ");
+      }
+      print_source_location(out, "   ", trace.source);
+    }
+  }
+  fflush(out);
+}
+
+SymbolCacheStatistics
+get_symbol_cache_statistics()
+{
+  return get_symbol_cache().get_statistics();
+}
+
+void
+set_symbol_cache_capacity(size_t capacity)
+{
+  get_symbol_cache().set_capacity(capacity);
+}
+
+#else  // !defined(_WIN32) && !defined(__ANDROID__)
+
+SymbolCacheStatistics
+get_symbol_cache_statistics()
+{
+  return {0, 0, 0, 0, 0};
+}
+
+void
+set_symbol_cache_capacity(size_t capacity)
+{
+  (void)capacity;
+}
+
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,78 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__SYMBOL_CACHE_IMPL_HPP_
+#define MEMORY_TOOLS__SYMBOL_CACHE_IMPL_HPP_
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "osrf_testing_tools_cpp/memory_tools/symbol_cache.hpp"
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+
+#pragma GCC diagnostic push
+#ifdef __clang__
+# pragma clang diagnostic ignored "-Wgnu-include-next"
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "./vendor/bombela/backward-cpp/backward.hpp"
+#pragma GCC diagnostic pop
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Symbolize the given frames, only addresses missing from the cache are resolved.
+/** The index of each result is its position in frames. */
+std::vector<backward::ResolvedTrace>
+resolve_frames(void * const * frames, size_t count);
+
+/// Symbolizes the frames of one stack trace one at a time, sharing a single resolver.
+/**
+ * Frames found in the cache are not resolved at all, and the resolver is
+ * only created, for all the frames, on the first frame missing from it, so
+ * reading a few frames costs only those, and reading all of them costs a
+ * single resolver setup, like resolve_frames().
+ */
+class FrameResolver
+{
+public:
+  FrameResolver(void * const * frames, size_t count);
+
+  /// Symbolize the frame at the given index, through the cache.
+  backward::ResolvedTrace
+  resolve(size_t index);
+
+private:
+  std::mutex mutex_;
+  std::vector<void *> frames_;
+  std::unique_ptr<backward::TraceResolver> trace_resolver_;
+};
+
+/// Print the given frames, innermost first, in the same format as backward::Printer.
+/** A thread id of 0 is not printed, like backward::StackTrace::thread_id() for the main thread. */
+void
+print_frames(void * const * frames, size_t count, size_t thread_id, FILE * out);
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+#endif  // MEMORY_TOOLS__SYMBOL_CACHE_IMPL_HPP_
@@ -25,6 +25,13 @@ static std::atomic<bool> g_malloc_unexpected(false);
 static std::atomic<bool> g_realloc_unexpected(false);
 static std::atomic<bool> g_calloc_unexpected(false);
 static std::atomic<bool> g_free_unexpected(false);
+static std::atomic<bool> g_aligned_alloc_unexpected(false);
+static std::atomic<bool> g_operator_new_unexpected(false);
+static std::atomic<bool> g_operator_delete_unexpected(false);
+static std::atomic<bool> g_mmap_unexpected(false);
+static std::atomic<bool> g_mremap_unexpected(false);
+static std::atomic<bool> g_munmap_unexpected(false);
+static std::atomic<bool> g_brk_unexpected(false);
 
 void
 on_unexpected_malloc(AnyMemoryToolsCallback callback)
@@ -146,5 +153,215 @@ expect_no_free_end()
   g_free_unexpected.store(false);
 }
 
+void
+on_unexpected_aligned_alloc(AnyMemoryToolsCallback callback)
+{
+  on_aligned_alloc(
+    [callback](MemoryToolsService & service) {
+      if (g_aligned_alloc_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+aligned_alloc_expected()
+{
+  return !g_aligned_alloc_unexpected.load();
+}
+
+void
+expect_no_aligned_alloc_begin()
+{
+  g_aligned_alloc_unexpected.store(true);
+}
+
+void
+expect_no_aligned_alloc_end()
+{
+  g_aligned_alloc_unexpected.store(false);
+}
+
+void
+on_unexpected_operator_new(AnyMemoryToolsCallback callback)
+{
+  on_operator_new(
+    [callback](MemoryToolsService & service) {
+      if (g_operator_new_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+operator_new_expected()
+{
+  return !g_operator_new_unexpected.load();
+}
+
+void
+expect_no_operator_new_begin()
+{
+  g_operator_new_unexpected.store(true);
+}
+
+void
+expect_no_operator_new_end()
+{
+  g_operator_new_unexpected.store(false);
+}
+
+void
+on_unexpected_operator_delete(AnyMemoryToolsCallback callback)
+{
+  on_operator_delete(
+    [callback](MemoryToolsService & service) {
+      if (g_operator_delete_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+operator_delete_expected()
+{
+  return !g_operator_delete_unexpected.load();
+}
+
+void
+expect_no_operator_delete_begin()
+{
+  g_operator_delete_unexpected.store(true);
+}
+
+void
+expect_no_operator_delete_end()
+{
+  g_operator_delete_unexpected.store(false);
+}
+
+void
+on_unexpected_mmap(AnyMemoryToolsCallback callback)
+{
+  on_mmap(
+    [callback](MemoryToolsService & service) {
+      if (g_mmap_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+mmap_expected()
+{
+  return !g_mmap_unexpected.load();
+}
+
+void
+expect_no_mmap_begin()
+{
+  g_mmap_unexpected.store(true);
+}
+
+void
+expect_no_mmap_end()
+{
+  g_mmap_unexpected.store(false);
+}
+
+void
+on_unexpected_mremap(AnyMemoryToolsCallback callback)
+{
+  on_mremap(
+    [callback](MemoryToolsService & service) {
+      if (g_mremap_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+mremap_expected()
+{
+  return !g_mremap_unexpected.load();
+}
+
+void
+expect_no_mremap_begin()
+{
+  g_mremap_unexpected.store(true);
+}
+
+void
+expect_no_mremap_end()
+{
+  g_mremap_unexpected.store(false);
+}
+
+void
+on_unexpected_munmap(AnyMemoryToolsCallback callback)
+{
+  on_munmap(
+    [callback](MemoryToolsService & service) {
+      if (g_munmap_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+munmap_expected()
+{
+  return !g_munmap_unexpected.load();
+}
+
+void
+expect_no_munmap_begin()
+{
+  g_munmap_unexpected.store(true);
+}
+
+void
+expect_no_munmap_end()
+{
+  g_munmap_unexpected.store(false);
+}
+
+void
+on_unexpected_brk(AnyMemoryToolsCallback callback)
+{
+  on_brk(
+    [callback](MemoryToolsService & service) {
+      if (g_brk_unexpected.load()) {
+        service.unignore();
+        dispatch_callback(&callback, service);
+      }
+    });
+}
+
+bool
+brk_expected()
+{
+  return !g_brk_unexpected.load();
+}
+
+void
+expect_no_brk_begin()
+{
+  g_brk_unexpected.store(true);
+}
+
+void
+expect_no_brk_end()
+{
+  g_brk_unexpected.store(false);
+}
+
 }  // namespace memory_tools
 }  // namespace osrf_testing_tools_cpp
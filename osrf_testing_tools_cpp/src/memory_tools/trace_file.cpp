@@ -0,0 +1,227 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./trace_file.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+#include "./get_environment_variable.hpp"
+#include "./interposition_armed.hpp"
+#include "./recursion_guard.hpp"
+#include "./safe_fwrite.hpp"
+#include "./stack_table.hpp"
+#include "./trace_file_format.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static std::atomic<bool> g_trace_file_enabled(false);
+
+bool
+trace_file_enabled() noexcept
+{
+  return g_trace_file_enabled.load(std::memory_order_relaxed);
+}
+
+#if !defined(_WIN32)
+
+static char g_trace_file_path[4096];
+static int g_trace_file_fd = -1;
+static uint8_t * g_trace_file_mapping = nullptr;
+static uint64_t g_trace_file_capacity = 0;
+static uint64_t g_trace_file_start_ns = 0;
+static std::atomic<uint64_t> g_trace_file_next_offset(sizeof(TraceFileHeader));
+static std::atomic<uint64_t> g_trace_file_dropped(0);
+// True if the records have stack ids, see enable_memory_event_stacks().
+static bool g_trace_file_stacks = false;
+
+void
+trace_file_record(const MemoryEvent & event) noexcept
+{
+  const uint64_t offset =
+    g_trace_file_next_offset.fetch_add(sizeof(TraceFileRecord), std::memory_order_relaxed);
+  if (offset + sizeof(TraceFileRecord) > g_trace_file_capacity) {
+    g_trace_file_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  TraceFileRecord * record = reinterpret_cast<TraceFileRecord *>(g_trace_file_mapping + offset);
+  record->timestamp_ns = get_timestamp_ns() - g_trace_file_start_ns;
+  // a calloc rejected as too large asks for more than fits, which is saturated
+  if (__builtin_mul_overflow(event.count, event.size, &record->size)) {
+    record->size = std::numeric_limits<uint64_t>::max();
+  }
+  record->memory_in = reinterpret_cast<uintptr_t>(event.memory_in);
+  record->memory_out = reinterpret_cast<uintptr_t>(event.memory_out);
+  // other recorders may have captured it, but the stacks are only written if enabled
+  record->stack_id = g_trace_file_stacks ? event.stack_id : 0;
+  record->memory_function_type = static_cast<uint16_t>(event.memory_function_type);
+  // written last, a zero thread index marks a record which is not complete
+  std::atomic_thread_fence(std::memory_order_release);
+  record->thread_index = get_thread_index();
+}
+
+/// Write the interned stacks next to the trace, so records can be mapped to call stacks.
+static
+void
+write_trace_file_stacks()
+{
+  char stacks_path[sizeof(g_trace_file_path) + 8];
+  snprintf(stacks_path, sizeof(stacks_path), "%s.stacks", g_trace_file_path);
+  FILE * stacks_file = fopen(stacks_path, "w");
+  if (nullptr == stacks_file) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to open the trace stacks file\n");
+    return;
+  }
+  write_interned_stacks(stacks_file);
+  fclose(stacks_file);
+}
+
+static
+void
+close_trace_file()
+{
+  if (!g_trace_file_enabled.exchange(false)) {
+    return;
+  }
+  if (g_trace_file_stacks) {
+    disable_memory_event_stacks();
+  }
+  // symbolizing the stacks allocates, which should not be seen by memory tools
+  ScopedRecursionGuard recursion_guard;
+  // any writer getting an offset after this drops its record
+  uint64_t end = g_trace_file_next_offset.exchange(g_trace_file_capacity);
+  if (end > g_trace_file_capacity) {
+    end = g_trace_file_capacity;
+  }
+  TraceFileHeader * header = reinterpret_cast<TraceFileHeader *>(g_trace_file_mapping);
+  // includes the records other threads are still writing, which the decoder stops at
+  header->record_count = (end - sizeof(TraceFileHeader)) / sizeof(TraceFileRecord);
+  header->dropped_record_count = g_trace_file_dropped.load();
+  msync(g_trace_file_mapping, end, MS_SYNC);
+  if (0 != ftruncate(g_trace_file_fd, static_cast<off_t>(end))) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to truncate the trace file\n");
+  }
+  close(g_trace_file_fd);
+  if (g_trace_file_stacks) {
+    write_trace_file_stacks();
+  }
+  // the mapping is deliberately kept, a late writer may still be finishing its record
+}
+
+static
+void
+open_trace_file()
+{
+  char * path = g_trace_file_path;
+  if (!get_environment_variable("MEMORY_TOOLS_TRACE_FILE", path, sizeof(g_trace_file_path))) {
+    return;
+  }
+  uint64_t size_mb = 1024;
+  char size_mb_str[32];
+  if (
+    get_environment_variable("MEMORY_TOOLS_TRACE_FILE_SIZE_MB", size_mb_str, sizeof(size_mb_str)))
+  {
+    size_mb = std::strtoull(size_mb_str, nullptr, 10);
+  }
+  g_trace_file_capacity = size_mb * 1024 * 1024;
+  if (g_trace_file_capacity < sizeof(TraceFileHeader)) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] MEMORY_TOOLS_TRACE_FILE_SIZE_MB is too small\n");
+    return;
+  }
+
+  g_trace_file_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (g_trace_file_fd < 0) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to open MEMORY_TOOLS_TRACE_FILE=");
+    SAFE_FWRITE(stderr, path);
+    SAFE_FWRITE(stderr, "\n");
+    return;
+  }
+  // the file is sparse, so only the written part takes up space
+  if (0 != ftruncate(g_trace_file_fd, static_cast<off_t>(g_trace_file_capacity))) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to size the trace file\n");
+    close(g_trace_file_fd);
+    return;
+  }
+  void * mapping = mmap(
+    nullptr, g_trace_file_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, g_trace_file_fd, 0);
+  if (MAP_FAILED == mapping) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] failed to map the trace file\n");
+    close(g_trace_file_fd);
+    return;
+  }
+  g_trace_file_mapping = static_cast<uint8_t *>(mapping);
+
+  TraceFileHeader * header = reinterpret_cast<TraceFileHeader *>(g_trace_file_mapping);
+  std::memcpy(header->magic, TRACE_FILE_MAGIC, sizeof(header->magic));
+  header->version = TRACE_FILE_VERSION;
+  header->record_size = sizeof(TraceFileRecord);
+  header->start_time_ns = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+  g_trace_file_start_ns = get_timestamp_ns();
+
+  std::atexit(close_trace_file);
+  char stacks[8];
+  if (
+    !get_environment_variable("MEMORY_TOOLS_TRACE_FILE_STACKS", stacks, sizeof(stacks)) ||
+    0 != std::strcmp("0", stacks))
+  {
+    g_trace_file_stacks = true;
+    enable_memory_event_stacks();
+  }
+  g_trace_file_enabled.store(true);
+  // every memory operation has to reach the custom memory functions to be recorded
+  arm_interposition();
+}
+
+#else  // !defined(_WIN32)
+
+void
+trace_file_record(const MemoryEvent & event) noexcept
+{
+  (void)event;
+}
+
+static
+void
+open_trace_file()
+{}
+
+#endif  // !defined(_WIN32)
+
+/// Opens the trace file, if requested, when the library is loaded.
+static struct TraceFileInitializer
+{
+  TraceFileInitializer()
+  {
+    open_trace_file();
+  }
+} g_trace_file_initializer;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,50 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__TRACE_FILE_HPP_
+#define MEMORY_TOOLS__TRACE_FILE_HPP_
+
+#include "./memory_event.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// Return true if memory events are being written to the binary trace file.
+/**
+ * The trace is enabled at load time by setting the `MEMORY_TOOLS_TRACE_FILE`
+ * environment variable to the path of the file to write.
+ * The file is memory-mapped with a fixed capacity, given in MiB by
+ * `MEMORY_TOOLS_TRACE_FILE_SIZE_MB` (default 1024), and truncated to the
+ * written size at exit.
+ * Records which do not fit are dropped and counted in the header.
+ *
+ * Each record carries the id of its call stack, and the interned stacks are
+ * written symbolized to `<trace file>.stacks` at exit.
+ * Set `MEMORY_TOOLS_TRACE_FILE_STACKS=0` to skip capturing stacks.
+ *
+ * Decode it with the memory_tools_trace_decoder executable.
+ */
+bool
+trace_file_enabled() noexcept;
+
+/// Append a record for the given event to the trace file.
+void
+trace_file_record(const MemoryEvent & event) noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__TRACE_FILE_HPP_
@@ -0,0 +1,113 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__TRACE_FILE_FORMAT_HPP_
+#define MEMORY_TOOLS__TRACE_FILE_FORMAT_HPP_
+
+#include <cstdint>
+
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools_service.hpp"
+
+// Layout of the binary trace written when MEMORY_TOOLS_TRACE_FILE is set.
+// Shared by the writer in memory_tools and by memory_tools_trace_decoder.
+//
+// The file is a TraceFileHeader followed by TraceFileRecord's, all in the
+// byte order of the machine which wrote it.
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+static constexpr char TRACE_FILE_MAGIC[8] = {'M', 'T', 'T', 'R', 'A', 'C', 'E', '\0'};
+static constexpr uint32_t TRACE_FILE_VERSION = 1;
+
+struct TraceFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  /// Size of TraceFileRecord, to detect mismatched writer and reader.
+  uint32_t record_size;
+  /// Number of records, only valid once the trace was closed, otherwise 0.
+  /**
+   * Records still being written when the trace was closed are counted, and
+   * left with a zero thread index, so the records end at the first of them.
+   */
+  uint64_t record_count;
+  /// Number of records which did not fit in the file.
+  uint64_t dropped_record_count;
+  /// Wall clock time at which the trace was started, in nanoseconds since the epoch.
+  uint64_t start_time_ns;
+  uint64_t reserved[3];
+};
+
+struct TraceFileRecord
+{
+  /// Nanoseconds since the trace was started.
+  uint64_t timestamp_ns;
+  /// Bytes requested, i.e. count * size for calloc, 0 for free, known only for sized delete.
+  uint64_t size;
+  /// Memory given to realloc or free.
+  uint64_t memory_in;
+  /// Memory returned by the operation.
+  uint64_t memory_out;
+  /// See get_thread_index(), written last so that 0 marks a record which is not complete.
+  uint32_t thread_index;
+  /// Identifies the call stack of the operation, 0 if unknown.
+  uint32_t stack_id;
+  /// Value of the MemoryFunctionType.
+  uint16_t memory_function_type;
+  uint16_t reserved[3];
+};
+
+static_assert(sizeof(TraceFileHeader) == 64, "unexpected TraceFileHeader size");
+static_assert(sizeof(TraceFileRecord) == 48, "unexpected TraceFileRecord size");
+
+/// Return the name of a MemoryFunctionType stored in a trace record.
+inline
+const char *
+trace_file_memory_function_type_str(uint16_t memory_function_type)
+{
+  switch (static_cast<MemoryFunctionType>(memory_function_type)) {
+    case MemoryFunctionType::Malloc:
+      return "malloc";
+    case MemoryFunctionType::Realloc:
+      return "realloc";
+    case MemoryFunctionType::Calloc:
+      return "calloc";
+    case MemoryFunctionType::Free:
+      return "free";
+    case MemoryFunctionType::AlignedAlloc:
+      return "aligned_alloc";
+    case MemoryFunctionType::OperatorNew:
+      return "new";
+    case MemoryFunctionType::OperatorDelete:
+      return "delete";
+    case MemoryFunctionType::Mmap:
+      return "mmap";
+    case MemoryFunctionType::Mremap:
+      return "mremap";
+    case MemoryFunctionType::Munmap:
+      return "munmap";
+    case MemoryFunctionType::Brk:
+      return "brk";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__TRACE_FILE_FORMAT_HPP_
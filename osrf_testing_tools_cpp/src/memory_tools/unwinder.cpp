@@ -0,0 +1,363 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./unwinder.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+// both keep the previous frame pointer and the return address at the frame pointer
+#define MEMORY_TOOLS_HAS_FRAME_POINTER_UNWINDER
+#endif
+
+#if defined(__linux__)
+#include <link.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+#pragma GCC diagnostic push
+#ifdef __clang__
+# pragma clang diagnostic ignored "-Wgnu-include-next"
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "./vendor/bombela/backward-cpp/backward.hpp"
+#pragma GCC diagnostic pop
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+#include "./get_environment_variable.hpp"
+#include "./safe_fwrite.hpp"
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+// room for the frames of the unwinder and of memory tools, which are left out
+static constexpr size_t STACK_CAPTURE_SKIP_SLACK = 32;
+
+bool
+frame_pointer_unwinder_is_available() noexcept
+{
+#if defined(MEMORY_TOOLS_HAS_FRAME_POINTER_UNWINDER)
+  return true;
+#else
+  return false;
+#endif
+}
+
+static
+UnwinderBackend
+get_unwinder_backend_from_env()
+{
+  char value[32];
+  if (!get_environment_variable("MEMORY_TOOLS_UNWINDER", value, sizeof(value))) {
+    return UnwinderBackend::backward;
+  }
+  if (0 == std::strcmp("backward", value) || 0 == std::strcmp("BACKWARD", value)) {
+    return UnwinderBackend::backward;
+  }
+  if (0 == std::strcmp("frame_pointer", value) || 0 == std::strcmp("FRAME_POINTER", value)) {
+    if (!frame_pointer_unwinder_is_available()) {
+      SAFE_FWRITE(stderr,
+        "[memory_tools][WARN] MEMORY_TOOLS_UNWINDER=frame_pointer is not available on this "
+        "platform, using backward.\n");
+      return UnwinderBackend::backward;
+    }
+    return UnwinderBackend::frame_pointer;
+  }
+  SAFE_FWRITE(stderr, "[memory_tools][WARN] Given MEMORY_TOOLS_UNWINDER=");
+  SAFE_FWRITE(stderr, value);
+  SAFE_FWRITE(stderr, " but that is not one of {backward, frame_pointer}, using backward.\n");
+  return UnwinderBackend::backward;
+}
+
+// function local, so that it is initialized before its first use by another static initializer
+static
+std::atomic<UnwinderBackend> &
+get_unwinder_backend_storage()
+{
+  static std::atomic<UnwinderBackend> backend(get_unwinder_backend_from_env());
+  return backend;
+}
+
+UnwinderBackend
+get_unwinder_backend() noexcept
+{
+  return get_unwinder_backend_storage().load(std::memory_order_relaxed);
+}
+
+UnwinderBackend
+set_unwinder_backend(UnwinderBackend backend) noexcept
+{
+  if (UnwinderBackend::frame_pointer == backend && !frame_pointer_unwinder_is_available()) {
+    backend = UnwinderBackend::backward;
+  }
+  return get_unwinder_backend_storage().exchange(backend);
+}
+
+static
+size_t
+get_max_stack_depth_from_env()
+{
+  char value[32];
+  if (!get_environment_variable("MEMORY_TOOLS_STACK_DEPTH", value, sizeof(value))) {
+    return 64;
+  }
+  char * end = nullptr;
+  unsigned long long depth = std::strtoull(value, &end, 10);  // NOLINT(runtime/int)
+  if ('\0' != *end || 0 == depth || depth > STACK_CAPTURE_MAX_DEPTH) {
+    SAFE_FWRITE(stderr, "[memory_tools][WARN] Given MEMORY_TOOLS_STACK_DEPTH=");
+    SAFE_FWRITE(stderr, value);
+    SAFE_FWRITE(stderr, " but that is not a number in [1, 256], using 64.\n");
+    return 64;
+  }
+  return static_cast<size_t>(depth);
+}
+
+size_t
+get_max_stack_depth() noexcept
+{
+  static const size_t max_stack_depth = get_max_stack_depth_from_env();
+  return max_stack_depth;
+}
+
+#if defined(MEMORY_TOOLS_HAS_FRAME_POINTER_UNWINDER)
+
+static thread_local uintptr_t g_tls_stack_begin = 0;
+static thread_local uintptr_t g_tls_stack_end = 0;
+
+/// Get the bounds of the calling thread's stack, so that a bad frame pointer is never followed.
+static
+bool
+load_thread_stack_bounds() noexcept
+{
+  if (0 != g_tls_stack_end) {
+    return true;
+  }
+  pthread_attr_t attributes;
+  if (0 != pthread_getattr_np(pthread_self(), &attributes)) {
+    return false;
+  }
+  void * stack_address = nullptr;
+  size_t stack_size = 0;
+  if (0 == pthread_attr_getstack(&attributes, &stack_address, &stack_size)) {
+    g_tls_stack_begin = reinterpret_cast<uintptr_t>(stack_address);
+    g_tls_stack_end = g_tls_stack_begin + stack_size;
+  }
+  pthread_attr_destroy(&attributes);
+  return 0 != g_tls_stack_end;
+}
+
+__attribute__((noinline))
+static
+size_t
+capture_with_frame_pointers(void ** frames, size_t max_depth) noexcept
+{
+  uintptr_t frame_pointer = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+  size_t depth = 0;
+  while (depth < max_depth) {
+    if (
+      frame_pointer < g_tls_stack_begin ||
+      frame_pointer + 2 * sizeof(void *) > g_tls_stack_end ||
+      0 != frame_pointer % sizeof(void *))
+    {
+      break;
+    }
+    void * const * frame = reinterpret_cast<void * const *>(frame_pointer);
+    const uintptr_t return_address = reinterpret_cast<uintptr_t>(frame[1]);
+    if (0 == return_address) {
+      break;
+    }
+    // point into the call instruction, like backward does
+    frames[depth++] = reinterpret_cast<void *>(return_address - 1);
+    const uintptr_t next_frame_pointer = reinterpret_cast<uintptr_t>(frame[0]);
+    // the stack grows down, so the caller's frame must be above this one
+    if (next_frame_pointer <= frame_pointer) {
+      break;
+    }
+    frame_pointer = next_frame_pointer;
+  }
+  return depth;
+}
+
+#endif  // defined(MEMORY_TOOLS_HAS_FRAME_POINTER_UNWINDER)
+
+#if defined(__linux__)
+
+struct AddressRange
+{
+  uintptr_t begin;
+  uintptr_t end;
+};
+
+/// The executable segments of libmemory_tools and libmemory_tools_interpose.
+struct MemoryToolsCodeRanges
+{
+  AddressRange ranges[16];
+  size_t count = 0;
+};
+
+static
+int
+collect_memory_tools_code_ranges(struct dl_phdr_info * info, size_t size, void * data)
+{
+  (void)size;
+  auto code_ranges = static_cast<MemoryToolsCodeRanges *>(data);
+  if (nullptr == info->dlpi_name || nullptr == std::strstr(info->dlpi_name, "libmemory_tools")) {
+    return 0;
+  }
+  for (size_t i = 0; i < info->dlpi_phnum; ++i) {
+    const auto & header = info->dlpi_phdr[i];
+    if (PT_LOAD != header.p_type || 0 == (header.p_flags & PF_X)) {
+      continue;
+    }
+    if (code_ranges->count == sizeof(code_ranges->ranges) / sizeof(code_ranges->ranges[0])) {
+      return 1;
+    }
+    const uintptr_t begin = info->dlpi_addr + header.p_vaddr;
+    code_ranges->ranges[code_ranges->count++] = {begin, begin + header.p_memsz};
+  }
+  return 0;
+}
+
+static
+bool
+is_memory_tools_frame(void * frame) noexcept
+{
+  static const MemoryToolsCodeRanges code_ranges = []() {
+      MemoryToolsCodeRanges result;
+      dl_iterate_phdr(collect_memory_tools_code_ranges, &result);
+      return result;
+    }();
+  const uintptr_t address = reinterpret_cast<uintptr_t>(frame);
+  for (size_t i = 0; i < code_ranges.count; ++i) {
+    if (address >= code_ranges.ranges[i].begin && address < code_ranges.ranges[i].end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#elif defined(__APPLE__)
+
+static
+bool
+is_memory_tools_frame(void * frame) noexcept
+{
+  Dl_info info;
+  return
+    0 != dladdr(frame, &info) &&
+    nullptr != info.dli_fname &&
+    nullptr != std::strstr(info.dli_fname, "libmemory_tools");
+}
+
+#else
+
+static
+bool
+is_memory_tools_frame(void * frame) noexcept
+{
+  (void)frame;
+  return false;
+}
+
+#endif
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+
+/// Stores the frames reported by backward's unwinder, which does not allocate.
+struct CaptureFrames
+{
+  void ** frames;
+
+  void
+  operator()(size_t index, void * address)
+  {
+    frames[index] = address;
+  }
+};
+
+size_t
+capture_stack(void ** frames, size_t max_depth) noexcept
+{
+  if (max_depth > STACK_CAPTURE_MAX_DEPTH) {
+    max_depth = STACK_CAPTURE_MAX_DEPTH;
+  }
+  void * raw_frames[STACK_CAPTURE_MAX_DEPTH + STACK_CAPTURE_SKIP_SLACK];
+  const size_t raw_max_depth = max_depth + STACK_CAPTURE_SKIP_SLACK;
+  size_t raw_depth = 0;
+#if defined(MEMORY_TOOLS_HAS_FRAME_POINTER_UNWINDER)
+  if (UnwinderBackend::frame_pointer == get_unwinder_backend() && load_thread_stack_bounds()) {
+    raw_depth = capture_with_frame_pointers(raw_frames, raw_max_depth);
+  } else {
+    raw_depth = backward::details::unwind(CaptureFrames{raw_frames}, raw_max_depth);
+  }
+#else
+  raw_depth = backward::details::unwind(CaptureFrames{raw_frames}, raw_max_depth);
+#endif
+  // leave out everything up to and including the outermost frame of memory tools
+  size_t begin = 0;
+  for (size_t i = 0; i < raw_depth; ++i) {
+    if (is_memory_tools_frame(raw_frames[i])) {
+      begin = i + 1;
+    }
+  }
+  size_t depth = 0;
+  for (size_t i = begin; i < raw_depth && depth < max_depth; ++i) {
+    frames[depth++] = raw_frames[i];
+  }
+  return depth;
+}
+
+#else  // !defined(_WIN32) && !defined(__ANDROID__)
+
+size_t
+capture_stack(void ** frames, size_t max_depth) noexcept
+{
+  (void)frames;
+  (void)max_depth;
+  return 0;
+}
+
+#endif  // !defined(_WIN32) && !defined(__ANDROID__)
+
+size_t
+get_backtrace_thread_id() noexcept
+{
+#if defined(__linux__)
+  const size_t thread_id = static_cast<size_t>(syscall(SYS_gettid));
+  return (static_cast<size_t>(getpid()) == thread_id) ? 0 : thread_id;
+#elif defined(__APPLE__)
+  if (pthread_main_np() == 1) {
+    return 0;
+  }
+  uint64_t thread_id = 0;
+  pthread_threadid_np(pthread_self(), &thread_id);
+  return static_cast<size_t>(thread_id);
+#else
+  return 0;
+#endif
+}
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
@@ -0,0 +1,84 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_TOOLS__UNWINDER_HPP_
+#define MEMORY_TOOLS__UNWINDER_HPP_
+
+#include <cstddef>
+
+namespace osrf_testing_tools_cpp
+{
+namespace memory_tools
+{
+
+/// How the program counters of a stack are captured.
+enum class UnwinderBackend
+{
+  /// backward-cpp's unwinder, based on _Unwind_Backtrace, works with any code.
+  backward,
+  /// Follows the frame pointers, much faster, but only correct for code built
+  /// with `-fno-omit-frame-pointer`, and only available on Linux.
+  frame_pointer,
+};
+
+/// Upper bound of get_max_stack_depth().
+static constexpr size_t STACK_CAPTURE_MAX_DEPTH = 256;
+
+/// Return the unwinder backend used by capture_stack().
+/**
+ * The initial value comes from the `MEMORY_TOOLS_UNWINDER` environment
+ * variable, which may be `backward` (the default) or `frame_pointer`.
+ */
+UnwinderBackend
+get_unwinder_backend() noexcept;
+
+/// Set the unwinder backend, returning the previous one.
+/** Falls back to the backward backend if the requested one is not available. */
+UnwinderBackend
+set_unwinder_backend(UnwinderBackend backend) noexcept;
+
+/// Return true if the frame pointer backend can be used on this platform.
+bool
+frame_pointer_unwinder_is_available() noexcept;
+
+/// Return the maximum number of frames captured for stack traces and backtraces.
+/**
+ * Comes from the `MEMORY_TOOLS_STACK_DEPTH` environment variable, 64 by
+ * default, and is at most STACK_CAPTURE_MAX_DEPTH.
+ */
+size_t
+get_max_stack_depth() noexcept;
+
+/// Capture the program counters of the calling thread, innermost first.
+/**
+ * The frames of memory tools itself, i.e. everything up to and including the
+ * outermost frame in libmemory_tools or libmemory_tools_interpose, are left
+ * out, so the first frame is where the memory operation was made.
+ * Each program counter points into the call instruction, as backward reports them.
+ *
+ * Does not allocate, except possibly the first time it is called in a thread.
+ *
+ * \return the number of frames written, at most max_depth
+ */
+size_t
+capture_stack(void ** frames, size_t max_depth) noexcept;
+
+/// Return the thread id printed in backtraces, 0 for the main thread, like backward does.
+size_t
+get_backtrace_thread_id() noexcept;
+
+}  // namespace memory_tools
+}  // namespace osrf_testing_tools_cpp
+
+#endif  // MEMORY_TOOLS__UNWINDER_HPP_
@@ -0,0 +1,263 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "memory_tools/trace_file_format.hpp"
+
+using osrf_testing_tools_cpp::memory_tools::MemoryFunctionType;
+using osrf_testing_tools_cpp::memory_tools::TRACE_FILE_MAGIC;
+using osrf_testing_tools_cpp::memory_tools::TRACE_FILE_VERSION;
+using osrf_testing_tools_cpp::memory_tools::TraceFileHeader;
+using osrf_testing_tools_cpp::memory_tools::TraceFileRecord;
+using osrf_testing_tools_cpp::memory_tools::trace_file_memory_function_type_str;
+
+void
+usage(const std::string & program_name)
+{
+  printf("usage: %s [--text | --csv | --summary] <trace_file>\n", program_name.c_str());
+}
+
+struct OperationSummary
+{
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+/// Accumulates the summary, one record at a time in trace order.
+class Summary
+{
+public:
+  void
+  add(const TraceFileRecord & record)
+  {
+    auto & operation = operations_[record.memory_function_type];
+    operation.count++;
+    operation.bytes += record.size;
+    threads_[record.thread_index]++;
+    // the sizes of sized delete and munmap are not requested, so they are left out of the stacks
+    const auto type = static_cast<MemoryFunctionType>(record.memory_function_type);
+    const bool releases =
+      MemoryFunctionType::OperatorDelete == type || MemoryFunctionType::Munmap == type;
+    if (0 != record.stack_id && 0 != record.size && !releases) {
+      auto & stack = stacks_[record.stack_id];
+      stack.count++;
+      stack.bytes += record.size;
+    }
+    if (record.timestamp_ns > duration_ns_) {
+      duration_ns_ = record.timestamp_ns;
+    }
+
+    switch (type) {
+      case MemoryFunctionType::Malloc:
+      case MemoryFunctionType::Calloc:
+      case MemoryFunctionType::AlignedAlloc:
+      case MemoryFunctionType::OperatorNew:
+      case MemoryFunctionType::Mmap:
+        allocate(record.memory_out, record.size);
+        break;
+      case MemoryFunctionType::Realloc:
+      case MemoryFunctionType::Mremap:
+        if (0 != record.memory_out) {
+          release(record.memory_in);
+          allocate(record.memory_out, record.size);
+        }
+        break;
+      case MemoryFunctionType::Free:
+      case MemoryFunctionType::OperatorDelete:
+      case MemoryFunctionType::Munmap:
+        release(record.memory_in);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void
+  print(const TraceFileHeader & header, uint64_t record_count) const
+  {
+    printf("records: %" PRIu64 "\n", record_count);
+    printf("dropped records: %" PRIu64 "\n", header.dropped_record_count);
+    printf("duration: %.6f s\n", static_cast<double>(duration_ns_) / 1e9);
+    printf("peak live bytes: %" PRIu64 "\n", peak_live_bytes_);
+    printf("live bytes at end: %" PRIu64 " in %zu allocations\n", live_bytes_, live_.size());
+    printf("\n%-10s %14s %18s\n", "operation", "count", "bytes");
+    for (const auto & pair : operations_) {
+      printf("%-10s %14" PRIu64 " %18" PRIu64 "\n",
+        trace_file_memory_function_type_str(pair.first), pair.second.count, pair.second.bytes);
+    }
+    printf("\n%-10s %14s\n", "thread", "operations");
+    for (const auto & pair : threads_) {
+      printf("%-10" PRIu32 " %14" PRIu64 "\n", pair.first, pair.second);
+    }
+    if (stacks_.empty()) {
+      return;
+    }
+    std::vector<std::pair<uint32_t, OperationSummary>> top_stacks(stacks_.begin(), stacks_.end());
+    std::sort(top_stacks.begin(), top_stacks.end(), [](const auto & a, const auto & b) {
+      return a.second.bytes > b.second.bytes;
+    });
+    if (top_stacks.size() > 10) {
+      top_stacks.resize(10);
+    }
+    printf("\ntop stacks by bytes requested, see the .stacks file next to the trace\n");
+    printf("%-10s %14s %18s\n", "stack", "count", "bytes");
+    for (const auto & pair : top_stacks) {
+      printf("%-10" PRIu32 " %14" PRIu64 " %18" PRIu64 "\n",
+        pair.first, pair.second.count, pair.second.bytes);
+    }
+  }
+
+private:
+  void
+  allocate(uint64_t memory, uint64_t size)
+  {
+    if (0 == memory) {
+      return;
+    }
+    live_[memory] = size;
+    live_bytes_ += size;
+    if (live_bytes_ > peak_live_bytes_) {
+      peak_live_bytes_ = live_bytes_;
+    }
+  }
+
+  void
+  release(uint64_t memory)
+  {
+    auto it = live_.find(memory);
+    // memory allocated before the trace started is not known
+    if (live_.end() == it) {
+      return;
+    }
+    live_bytes_ -= it->second;
+    live_.erase(it);
+  }
+
+  std::map<uint16_t, OperationSummary> operations_;
+  std::map<uint32_t, uint64_t> threads_;
+  std::unordered_map<uint32_t, OperationSummary> stacks_;
+  std::unordered_map<uint64_t, uint64_t> live_;
+  uint64_t live_bytes_ = 0;
+  uint64_t peak_live_bytes_ = 0;
+  uint64_t duration_ns_ = 0;
+};
+
+int
+main(int argc, char const * argv[])
+{
+  std::string mode = "text";
+  std::string path;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      usage(argv[0]);
+      return 0;
+    } else if (arg == "--text") {
+      mode = "text";
+    } else if (arg == "--csv") {
+      mode = "csv";
+    } else if (arg == "--summary") {
+      mode = "summary";
+    } else if (path.empty()) {
+      path = arg;
+    } else {
+      fprintf(stderr, "unexpected positional argument: %s\n", arg.c_str());
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (path.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE * file = fopen(path.c_str(), "rb");
+  if (nullptr == file) {
+    fprintf(stderr, "failed to open trace file '%s'\n", path.c_str());
+    return 1;
+  }
+  TraceFileHeader header;
+  if (1 != fread(&header, sizeof(header), 1, file)) {
+    fprintf(stderr, "failed to read the trace file header\n");
+    fclose(file);
+    return 1;
+  }
+  if (0 != std::memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic))) {
+    fprintf(stderr, "'%s' is not a memory_tools trace file\n", path.c_str());
+    fclose(file);
+    return 1;
+  }
+  if (TRACE_FILE_VERSION != header.version || sizeof(TraceFileRecord) != header.record_size) {
+    fprintf(stderr,
+      "unsupported trace file version %" PRIu32 " with record size %" PRIu32 "\n",
+      header.version, header.record_size);
+    fclose(file);
+    return 1;
+  }
+  // a trace which was not closed, e.g. after a crash, has no record count
+  const bool closed = (0 != header.record_count);
+
+  if (mode == "csv") {
+    printf("timestamp_ns,thread,operation,size,memory_in,memory_out,stack_id\n");
+  }
+  Summary summary;
+  uint64_t record_count = 0;
+  std::vector<TraceFileRecord> records(4096);
+  bool done = false;
+  while (!done) {
+    size_t read = fread(records.data(), sizeof(TraceFileRecord), records.size(), file);
+    if (read < records.size()) {
+      done = true;
+    }
+    for (size_t i = 0; i < read; ++i) {
+      const TraceFileRecord & record = records[i];
+      // a record still being written when the trace was closed is counted but not complete
+      if ((closed && record_count == header.record_count) || 0 == record.thread_index) {
+        done = true;
+        break;
+      }
+      ++record_count;
+      if (mode == "text") {
+        printf("%16.9f thread %-4" PRIu32 " %-8s %12" PRIu64 " 0x%016" PRIx64 " -> 0x%016"
+          PRIx64 " stack %" PRIu32 "\n",
+          static_cast<double>(record.timestamp_ns) / 1e9, record.thread_index,
+          trace_file_memory_function_type_str(record.memory_function_type), record.size,
+          record.memory_in, record.memory_out, record.stack_id);
+      } else if (mode == "csv") {
+        printf("%" PRIu64 ",%" PRIu32 ",%s,%" PRIu64 ",0x%" PRIx64 ",0x%" PRIx64 ",%" PRIu32 "\n",
+          record.timestamp_ns, record.thread_index,
+          trace_file_memory_function_type_str(record.memory_function_type), record.size,
+          record.memory_in, record.memory_out, record.stack_id);
+      } else {
+        summary.add(record);
+      }
+    }
+  }
+  fclose(file);
+
+  if (mode == "summary") {
+    summary.print(header, record_count);
+  }
+  return 0;
+}
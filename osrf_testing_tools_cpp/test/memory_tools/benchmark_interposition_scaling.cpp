@@ -0,0 +1,113 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "osrf_testing_tools_cpp/memory_tools/memory_tools.hpp"
+#include "osrf_testing_tools_cpp/scope_exit.hpp"
+
+/**
+ * Measures the throughput of intercepted malloc/free pairs with 1 to N threads.
+ *
+ * Must be run with memory_tools_interpose preloaded for the numbers to mean
+ * anything, e.g. through the test_runner as done by the CMake test.
+ *
+ * Usage: benchmark_interposition_scaling [max_threads [iterations_per_thread]]
+ */
+
+// thread-specific so that the threads do not share a cache line through the sink
+static thread_local void * volatile g_tls_sink = nullptr;
+
+static
+double
+run_threads(size_t number_of_threads, size_t iterations, bool enable_monitoring = true)
+{
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  threads.reserve(number_of_threads);
+  for (size_t i = 0; i < number_of_threads; ++i) {
+    threads.emplace_back([&go, iterations, enable_monitoring]() {
+      if (enable_monitoring) {
+        osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+      }
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      for (size_t j = 0; j < iterations; ++j) {
+        void * memory = std::malloc(64 + (j & 0xff));
+        g_tls_sink = memory;
+        std::free(memory);
+      }
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  go.store(true);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int
+main(int argc, char ** argv)
+{
+  size_t max_threads = std::thread::hardware_concurrency();
+  if (0 == max_threads) {
+    max_threads = 4;
+  }
+  size_t iterations = 200000;
+  if (argc > 1) {
+    max_threads = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    iterations = std::stoul(argv[2]);
+  }
+
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+  // an empty callback, so the measurement is of the hook dispatch and not of user code
+  osrf_testing_tools_cpp::memory_tools::on_malloc([]() {});
+
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+  printf("memory_tools working: %s\n",
+    osrf_testing_tools_cpp::memory_tools::is_working() ? "yes" : "no");
+  osrf_testing_tools_cpp::memory_tools::disable_monitoring();
+  // with nothing enabled the replacement functions should be a thin passthrough
+  double passthrough_seconds = run_threads(1, iterations, false);
+  printf("passthrough with monitoring disabled: %.1f ns per operation\n",
+    passthrough_seconds * 1e9 / (2.0 * static_cast<double>(iterations)));
+
+  printf("%8s %14s %10s %14s %18s\n",
+    "threads", "operations", "seconds", "Mops/s", "Mops/s/thread");
+  for (size_t number_of_threads = 1; number_of_threads <= max_threads; ++number_of_threads) {
+    double seconds = run_threads(number_of_threads, iterations);
+    // each iteration is one malloc and one free
+    double operations = 2.0 * static_cast<double>(number_of_threads * iterations);
+    double mops = operations / seconds / 1e6;
+    printf("%8zu %14.0f %10.4f %14.3f %18.3f\n",
+      number_of_threads, operations, seconds, mops,
+      mops / static_cast<double>(number_of_threads));
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "memory_tools/count_function_occurrences_in_backtrace.hpp"
+#include "memory_tools/recursion_guard.hpp"
+
+/**
+ * Compares the cost of the two ways of detecting that a memory function recursed.
+ *
+ * The old way searched the backtrace for the function with backtrace() and
+ * dladdr(), the new way uses a thread-local depth in ScopedRecursionGuard.
+ * Both are measured at the same, configurable, call stack depth.
+ *
+ * Usage: benchmark_recursion_detection [iterations [stack_depth]]
+ */
+
+static volatile size_t g_sink = 0;
+
+static void checked_function(size_t iterations);
+
+static
+void
+backtrace_check(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    g_sink = osrf_testing_tools_cpp::memory_tools::count_function_occurrences_in_backtrace(
+      checked_function);
+  }
+}
+
+static
+void
+guard_check(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    osrf_testing_tools_cpp::memory_tools::ScopedRecursionGuard guard;
+    g_sink = guard.recursed();
+  }
+}
+
+static void checked_function(size_t iterations) {(void)iterations;}
+
+template<typename FunctionT>
+static
+double
+at_depth(size_t depth, FunctionT && function)
+{
+  if (depth > 0) {
+    double result = at_depth(depth - 1, function);
+    g_sink = g_sink + 1;  // prevent tail call optimization
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int
+main(int argc, char ** argv)
+{
+  size_t iterations = 100000;
+  size_t stack_depth = 20;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    stack_depth = std::stoul(argv[2]);
+  }
+
+  double backtrace_seconds = at_depth(stack_depth, [iterations]() {backtrace_check(iterations);});
+  double guard_seconds = at_depth(stack_depth, [iterations]() {guard_check(iterations);});
+
+  auto ns_per_check = [iterations](double seconds) {
+      return seconds * 1e9 / static_cast<double>(iterations);
+    };
+  printf("stack depth: ~%zu frames, iterations: %zu\n", stack_depth, iterations);
+  printf("%-40s %12.1f ns per check\n",
+    "count_function_occurrences_in_backtrace", ns_per_check(backtrace_seconds));
+  printf("%-40s %12.1f ns per check\n",
+    "ScopedRecursionGuard", ns_per_check(guard_seconds));
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "memory_tools/unwinder.hpp"
+
+/**
+ * Compares the latency of capturing a stack with each unwinder backend.
+ *
+ * This executable is built with frame pointers, so both backends see the
+ * frames of at_depth(), and the frame pointer walk ends where the frames
+ * without frame pointers, e.g. of libc, begin.
+ *
+ * Usage: benchmark_stack_capture [iterations [stack_depth]]
+ */
+
+using osrf_testing_tools_cpp::memory_tools::UnwinderBackend;
+
+static volatile size_t g_sink = 0;
+
+static
+void
+capture(size_t iterations)
+{
+  void * frames[osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH];
+  for (size_t i = 0; i < iterations; ++i) {
+    g_sink = osrf_testing_tools_cpp::memory_tools::capture_stack(
+      frames, osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH);
+  }
+}
+
+template<typename FunctionT>
+static
+double
+at_depth(size_t depth, FunctionT && function)
+{
+  if (depth > 0) {
+    double result = at_depth(depth - 1, function);
+    g_sink = g_sink + 1;  // prevent tail call optimization
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int
+main(int argc, char ** argv)
+{
+  size_t iterations = 10000;
+  size_t stack_depth = 30;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    stack_depth = std::stoul(argv[2]);
+  }
+
+  printf("stack depth: ~%zu frames, iterations: %zu\n", stack_depth, iterations);
+  printf("%-16s %10s %18s\n", "backend", "frames", "ns per capture");
+  for (UnwinderBackend backend : {UnwinderBackend::backward, UnwinderBackend::frame_pointer}) {
+    const char * name = (UnwinderBackend::backward == backend) ? "backward" : "frame_pointer";
+    if (
+      UnwinderBackend::frame_pointer == backend &&
+      !osrf_testing_tools_cpp::memory_tools::frame_pointer_unwinder_is_available())
+    {
+      printf("%-16s %10s %18s\n", name, "-", "not available");
+      continue;
+    }
+    osrf_testing_tools_cpp::memory_tools::set_unwinder_backend(backend);
+    double seconds = at_depth(stack_depth, [iterations]() {capture(iterations);});
+    // the sink holds the number of frames of the last capture, plus the unwinding of at_depth()
+    const size_t frames = g_sink - stack_depth;
+    printf("%-16s %10zu %18.1f\n",
+      name, frames, seconds * 1e9 / static_cast<double>(iterations));
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "memory_tools/stack_trace_impl.hpp"
+#include "memory_tools/symbol_cache_impl.hpp"
+#include "memory_tools/unwinder.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/stack_trace.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/symbol_cache.hpp"
+
+/**
+ * Measures the cost of a StackTrace for callbacks which read only its first few frames.
+ *
+ * Frames are symbolized on first access, so reading the first N frames only
+ * pays for N of them, rather than for the whole stack as before.
+ * Reading all of them is compared with symbolizing the whole stack up front,
+ * as before, which the lazy path should match since its frames share a
+ * single resolver.
+ * It is measured with the symbol cache disabled, so every frame is cold, to
+ * show the cost of the symbolization itself, and enabled, as it is by default.
+ *
+ * Usage: benchmark_stack_trace_resolution [iterations [stack_depth]]
+ */
+
+using osrf_testing_tools_cpp::memory_tools::StackTrace;
+using osrf_testing_tools_cpp::memory_tools::StackTraceImpl;
+
+static volatile size_t g_sink = 0;
+
+/// Capture a stack trace and read the object function of the first frames_to_read frames.
+static
+void
+read_first_frames(size_t iterations, size_t frames_to_read)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    void * frames[osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH];
+    const size_t depth = osrf_testing_tools_cpp::memory_tools::capture_stack(
+      frames, osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH);
+    StackTrace stack_trace(std::unique_ptr<StackTraceImpl>(
+      new StackTraceImpl(frames, depth, std::this_thread::get_id())));
+    const auto & traces = stack_trace.get_traces();
+    for (size_t j = 0; j < frames_to_read && j < traces.size(); ++j) {
+      g_sink = g_sink + traces[j].object_function().size();
+    }
+  }
+}
+
+/// Capture a stack trace and symbolize all of its frames up front, like before frames were lazy.
+static
+void
+resolve_all_frames_eagerly(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    void * frames[osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH];
+    const size_t depth = osrf_testing_tools_cpp::memory_tools::capture_stack(
+      frames, osrf_testing_tools_cpp::memory_tools::STACK_CAPTURE_MAX_DEPTH);
+    const auto resolved_traces =
+      osrf_testing_tools_cpp::memory_tools::resolve_frames(frames, depth);
+    for (const auto & resolved : resolved_traces) {
+      g_sink = g_sink + resolved.object_function.size();
+    }
+  }
+}
+
+template<typename FunctionT>
+static
+double
+at_depth(size_t depth, FunctionT && function)
+{
+  if (depth > 0) {
+    double result = at_depth(depth - 1, function);
+    g_sink = g_sink + 1;  // prevent tail call optimization
+    return result;
+  }
+  auto start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int
+main(int argc, char ** argv)
+{
+  size_t iterations = 1000;
+  size_t stack_depth = 30;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    stack_depth = std::stoul(argv[2]);
+  }
+
+  auto us_per_stack_trace = [iterations](double seconds) {
+      return seconds * 1e6 / static_cast<double>(iterations);
+    };
+  printf("stack depth: ~%zu frames, iterations: %zu\n", stack_depth, iterations);
+  printf("%-14s %-10s %18s\n", "frames read", "cache", "us per stack trace");
+  const size_t all_frames = 256;
+  for (size_t cache_capacity : {size_t(0), size_t(16384)}) {
+    osrf_testing_tools_cpp::memory_tools::set_symbol_cache_capacity(cache_capacity);
+    for (size_t frames_to_read : {size_t(0), size_t(1), size_t(3), all_frames}) {
+      double seconds = at_depth(stack_depth, [iterations, frames_to_read]() {
+          read_first_frames(iterations, frames_to_read);
+        });
+      printf("%-14s %-10s %18.2f\n",
+        (all_frames == frames_to_read ? "all" : std::to_string(frames_to_read)).c_str(),
+        (0 == cache_capacity ? "disabled" : "enabled"), us_per_stack_trace(seconds));
+    }
+    double seconds = at_depth(stack_depth, [iterations]() {
+        resolve_all_frames_eagerly(iterations);
+      });
+    printf("%-14s %-10s %18.2f\n",
+      "all, eager", (0 == cache_capacity ? "disabled" : "enabled"), us_per_stack_trace(seconds));
+  }
+  return 0;
+}
@@ -15,11 +15,30 @@
 #include <gtest/gtest.h>
 #include <gtest/gtest-spi.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "osrf_testing_tools_cpp/memory_tools/gtest_quickstart.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/memory_tools.hpp"
+#include "osrf_testing_tools_cpp/memory_tools/verbosity.hpp"
 #include "osrf_testing_tools_cpp/scope_exit.hpp"
 #include "memory_tools/impl/static_allocator.hpp"
+#include "memory_tools/stack_table.hpp"
 
 /**
  * Tests the dynamic memory checking tools.
@@ -150,6 +169,790 @@ TEST(TestMemoryTools, test_allocation_checking_tools) {
   EXPECT_EQ(4u, unexpected_frees);
 }
 
+// volatile, so that the compiler cannot elide the allocation and free pairs in the tests
+static void * volatile g_escaped_memory = nullptr;
+
+/**
+ * Tests that the aligned allocation functions are checked too.
+ */
+TEST(TestMemoryTools, test_aligned_allocation_checking) {
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+
+  std::vector<std::string> unexpected_functions;
+  std::vector<size_t> unexpected_alignments;
+  auto on_unexpected_aligned_alloc =
+    [&unexpected_functions, &unexpected_alignments](
+    osrf_testing_tools_cpp::memory_tools::MemoryToolsService & service) {
+      unexpected_functions.push_back(service.get_source_function_name());
+      unexpected_alignments.push_back(service.get_alignment());
+    };
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_aligned_alloc(on_unexpected_aligned_alloc);
+  // reserved up front, so that recording the callbacks does not allocate
+  unexpected_functions.reserve(8);
+  unexpected_alignments.reserve(8);
+
+  auto use_aligned_memory_functions = []() -> void {
+      void * mem = nullptr;
+      ASSERT_EQ(0, posix_memalign(&mem, 64, 1024));
+      ASSERT_NE(nullptr, mem);
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(mem) % 64);
+      free(mem);
+      mem = aligned_alloc(128, 1024);
+      ASSERT_NE(nullptr, mem);
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(mem) % 128);
+      free(mem);
+    };
+
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+  use_aligned_memory_functions();
+  EXPECT_TRUE(unexpected_functions.empty());
+
+  EXPECT_NO_ALIGNED_ALLOC(use_aligned_memory_functions());
+  ASSERT_EQ(2u, unexpected_functions.size());
+  EXPECT_EQ("posix_memalign", unexpected_functions[0]);
+  EXPECT_EQ(64u, unexpected_alignments[0]);
+  EXPECT_EQ("aligned_alloc", unexpected_functions[1]);
+  EXPECT_EQ(128u, unexpected_alignments[1]);
+
+  // errors are still reported by the return value of posix_memalign
+  void * mem = nullptr;
+  EXPECT_EQ(EINVAL, posix_memalign(&mem, 3, 1024));
+  EXPECT_EQ(nullptr, mem);
+
+  // the aligned allocation functions are part of all memory operations
+  unexpected_functions.clear();
+  EXPECT_NO_MEMORY_OPERATIONS({
+    g_escaped_memory = aligned_alloc(64, 64);
+  });
+  free(g_escaped_memory);
+  EXPECT_EQ(1u, unexpected_functions.size());
+}
+
+struct alignas(64) CacheLineAligned
+{
+  char data[64];
+};
+
+/**
+ * Tests that operator new and operator delete are reported as such.
+ */
+TEST(TestMemoryTools, test_operator_new_checking) {
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+
+  struct Operation
+  {
+    std::string function_name;
+    size_t size;
+    size_t alignment;
+  };
+  std::vector<Operation> operations;
+  auto on_unexpected_operation =
+    [&operations](osrf_testing_tools_cpp::memory_tools::MemoryToolsService & service) {
+      operations.push_back(
+        {service.get_source_function_name(), service.get_size(), service.get_alignment()});
+    };
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_operator_new(on_unexpected_operation);
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_operator_delete(on_unexpected_operation);
+  size_t unexpected_mallocs = 0;
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_malloc(
+    [&unexpected_mallocs]() {
+      unexpected_mallocs++;
+    });
+  // reserved up front, so that recording the callbacks does not allocate
+  operations.reserve(8);
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+
+  EXPECT_NO_MEMORY_OPERATIONS({
+    int * array = new int[4];
+    g_escaped_memory = array;
+    delete[] array;
+    CacheLineAligned * aligned = new CacheLineAligned;
+    g_escaped_memory = aligned;
+    delete aligned;
+  });
+  // none of it is reported as malloc
+  EXPECT_EQ(0u, unexpected_mallocs);
+  ASSERT_EQ(4u, operations.size());
+  EXPECT_EQ("operator new[]", operations[0].function_name);
+  EXPECT_EQ(4 * sizeof(int), operations[0].size);
+  EXPECT_EQ(0u, operations[0].alignment);
+  EXPECT_EQ("operator delete[]", operations[1].function_name);
+  EXPECT_EQ("operator new", operations[2].function_name);
+  EXPECT_EQ(sizeof(CacheLineAligned), operations[2].size);
+  EXPECT_EQ(64u, operations[2].alignment);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(g_escaped_memory) % 64);
+  EXPECT_EQ("operator delete", operations[3].function_name);
+  EXPECT_EQ(64u, operations[3].alignment);
+
+  // without operator new hooks, operator new is reported to the malloc hooks
+  osrf_testing_tools_cpp::memory_tools::on_operator_new(nullptr);
+  EXPECT_NO_MALLOC({
+    int * value = new int(42);
+    g_escaped_memory = value;
+    delete value;
+  });
+  EXPECT_EQ(1u, unexpected_mallocs);
+}
+
+#if defined(__linux__)
+/**
+ * Tests that memory mappings are reported, MEMORY_TOOLS_TRACK_MMAP is set for this test.
+ */
+TEST(TestMemoryTools, test_mmap_checking) {
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+
+  std::vector<std::string> operations;
+  std::vector<size_t> sizes;
+  auto on_unexpected_operation =
+    [&operations, &sizes](osrf_testing_tools_cpp::memory_tools::MemoryToolsService & service) {
+      operations.push_back(service.get_memory_function_type_str());
+      sizes.push_back(service.get_size());
+    };
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_mmap(on_unexpected_operation);
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_mremap(on_unexpected_operation);
+  osrf_testing_tools_cpp::memory_tools::on_unexpected_munmap(on_unexpected_operation);
+  // reserved up front, so that recording the callbacks does not allocate
+  operations.reserve(8);
+  sizes.reserve(8);
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void * memory = MAP_FAILED;
+  EXPECT_NO_MEMORY_OPERATIONS({
+    memory = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, memory);
+    memory = mremap(memory, page_size, 2 * page_size, MREMAP_MAYMOVE);
+    ASSERT_NE(MAP_FAILED, memory);
+    ASSERT_EQ(0, munmap(memory, 2 * page_size));
+  });
+  ASSERT_EQ(3u, operations.size());
+  EXPECT_EQ("mmap", operations[0]);
+  EXPECT_EQ(page_size, sizes[0]);
+  EXPECT_EQ("mremap", operations[1]);
+  EXPECT_EQ(2 * page_size, sizes[1]);
+  EXPECT_EQ("munmap", operations[2]);
+  EXPECT_EQ(2 * page_size, sizes[2]);
+
+  // errors are still reported through errno
+  errno = 0;
+  EXPECT_EQ(MAP_FAILED, mmap(nullptr, 0, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  EXPECT_EQ(EINVAL, errno);
+}
+#endif  // defined(__linux__)
+
+/**
+ * Tests that ScopedAllocationStats counts the memory operations made while it is alive.
+ */
+TEST(TestMemoryTools, test_scoped_allocation_stats) {
+  using osrf_testing_tools_cpp::memory_tools::AllocationStats;
+  using osrf_testing_tools_cpp::memory_tools::AllocationStatsScope;
+  using osrf_testing_tools_cpp::memory_tools::MemoryFunctionType;
+  using osrf_testing_tools_cpp::memory_tools::ScopedAllocationStats;
+
+  ScopedAllocationStats stats;
+  EXPECT_EQ(AllocationStatsScope::this_thread, stats.get_scope());
+  void * memory = malloc(100);
+  g_escaped_memory = memory;
+  memory = realloc(memory, 200);
+  g_escaped_memory = memory;
+  AllocationStats inner_stats;
+  {
+    ScopedAllocationStats inner;
+    int * array = new int[1000];
+    g_escaped_memory = array;
+    delete[] array;
+    inner_stats = inner.get();
+  }
+  free(memory);
+  AllocationStats result = stats.get();
+
+  EXPECT_EQ(1u, inner_stats.count(MemoryFunctionType::OperatorNew));
+  EXPECT_EQ(1000 * sizeof(int), inner_stats.bytes(MemoryFunctionType::OperatorNew));
+  EXPECT_EQ(0u, inner_stats.count(MemoryFunctionType::Malloc));
+  EXPECT_EQ(0, inner_stats.live_bytes);
+  EXPECT_GE(inner_stats.peak_live_bytes, static_cast<int64_t>(1000 * sizeof(int)));
+
+  EXPECT_EQ(1u, result.count(MemoryFunctionType::Malloc));
+  EXPECT_EQ(100u, result.bytes(MemoryFunctionType::Malloc));
+  EXPECT_EQ(1u, result.count(MemoryFunctionType::Realloc));
+  EXPECT_EQ(1u, result.count(MemoryFunctionType::Free));
+  EXPECT_EQ(1u, result.count(MemoryFunctionType::OperatorNew));
+  EXPECT_EQ(1u, result.count(MemoryFunctionType::OperatorDelete));
+  // malloc, realloc and new, and realloc, free and delete
+  EXPECT_EQ(3u, result.allocation_count);
+  EXPECT_EQ(3u, result.deallocation_count);
+  EXPECT_EQ(100 + 200 + 1000 * sizeof(int), result.bytes_requested);
+  EXPECT_GE(result.bytes_allocated, result.bytes_requested);
+  EXPECT_EQ(result.bytes_allocated, result.bytes_freed);
+  EXPECT_EQ(0, result.live_bytes);
+  // the peak is seen by the enclosing instance too
+  EXPECT_GE(result.peak_live_bytes, inner_stats.peak_live_bytes);
+
+  // all threads, including ones which have exited
+  ScopedAllocationStats all_threads_stats(AllocationStatsScope::all_threads);
+  std::thread thread([]() {
+      g_escaped_memory = malloc(1000);
+    });
+  thread.join();
+  AllocationStats all_threads_result = all_threads_stats.get();
+  free(g_escaped_memory);
+  EXPECT_GE(all_threads_result.count(MemoryFunctionType::Malloc), 1u);
+  EXPECT_GE(all_threads_result.live_bytes, 1000);
+  EXPECT_GE(all_threads_result.peak_live_bytes, 1000);
+}
+
+__attribute__((noinline))
+static void
+allocate_from_budget_test_call_site(size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    g_escaped_memory = malloc(64);
+    free(g_escaped_memory);
+  }
+}
+
+/**
+ * Tests the allocation budget macros, and that a failure names the call sites.
+ */
+TEST(TestMemoryTools, test_allocation_budget) {
+  EXPECT_MAX_ALLOCATIONS(2, {
+    allocate_from_budget_test_call_site(2);
+  });
+  EXPECT_MAX_BYTES(128, {
+    allocate_from_budget_test_call_site(2);
+  });
+  EXPECT_MAX_PEAK_LIVE_BYTES(1024, {
+    allocate_from_budget_test_call_site(100);
+  });
+  EXPECT_NONFATAL_FAILURE({
+    EXPECT_MAX_ALLOCATIONS(2, {
+      allocate_from_budget_test_call_site(3);
+    });
+  }, "allocations: 3, budget 2");
+  EXPECT_NONFATAL_FAILURE({
+    EXPECT_MAX_PEAK_LIVE_BYTES(64, {
+      int * array = new int[100];
+      g_escaped_memory = array;
+      delete[] array;
+    });
+  }, "peak live bytes");
+
+  osrf_testing_tools_cpp::memory_tools::ScopedAllocationBudget budget(
+    osrf_testing_tools_cpp::memory_tools::AllocationBudget().with_max_bytes(100));
+  allocate_from_budget_test_call_site(3);
+  std::string report;
+  EXPECT_FALSE(budget.check(&report));
+  EXPECT_EQ(192u, budget.get_stats().bytes_requested);
+  EXPECT_NE(std::string::npos, report.find("bytes requested: 192, budget 100")) << report;
+  EXPECT_NE(std::string::npos, report.find("3 allocation(s), 192 bytes requested")) << report;
+#if defined(__linux__)
+  // the stack of the call site, symbols are not available in this executable
+  EXPECT_NE(std::string::npos, report.find("#0 ")) << report;
+#endif
+}
+
+/**
+ * Tests that leaks are found by EXPECT_NO_LEAKS and ScopedLeakCheck.
+ */
+TEST(TestMemoryTools, test_leak_checking) {
+  EXPECT_NO_LEAKS({
+    std::vector<int> values(100);
+    g_escaped_memory = values.data();
+    void * memory = malloc(10);
+    memory = realloc(memory, 1000);
+    free(memory);
+  });
+
+  void * leaked = nullptr;
+  EXPECT_NONFATAL_FAILURE({
+    EXPECT_NO_LEAKS({
+      leaked = malloc(100);
+    });
+  }, "leaked: 1 allocation(s), 100 bytes");
+  free(leaked);
+
+  // a failed realloc keeps the memory given to it
+  volatile size_t too_large = SIZE_MAX / 2;
+  EXPECT_NONFATAL_FAILURE({
+    EXPECT_NO_LEAKS({
+      leaked = malloc(100);
+      g_escaped_memory = leaked;
+      EXPECT_EQ(nullptr, realloc(leaked, too_large));
+    });
+  }, "leaked: 1 allocation(s), 100 bytes");
+  free(leaked);
+
+  // memory allocated before the check, or by another thread, does not count
+  void * allocated_before = malloc(100);
+  // started before the check, creating a thread may allocate for it in this thread
+  std::atomic<int> thread_step(0);
+  std::thread thread([&thread_step]() {
+      while (0 == thread_step.load()) {
+        std::this_thread::yield();
+      }
+      g_escaped_memory = malloc(100);
+      thread_step.store(2);
+    });
+  osrf_testing_tools_cpp::memory_tools::ScopedLeakCheck leak_check;
+  free(allocated_before);
+  thread_step.store(1);
+  while (2 != thread_step.load()) {
+    std::this_thread::yield();
+  }
+  void * memory = calloc(2, 50);
+  int * value = new int(42);
+  std::string report;
+  EXPECT_FALSE(leak_check.check(&report));
+  const auto leaks = leak_check.get_leaks();
+  EXPECT_EQ(2u, leaks.count);
+  EXPECT_EQ(100 + sizeof(int), leaks.bytes);
+  EXPECT_NE(std::string::npos, report.find("leaked: 2 allocation(s)")) << report;
+  free(memory);
+  delete value;
+  EXPECT_TRUE(leak_check.check());
+  thread.join();
+  free(g_escaped_memory);
+}
+
+static std::string
+read_file(const std::string & path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+/**
+ * Tests that the heap profile counts allocations by call stack, in both formats.
+ */
+TEST(TestMemoryTools, test_heap_profile) {
+  using osrf_testing_tools_cpp::memory_tools::HeapProfileFormat;
+  osrf_testing_tools_cpp::memory_tools::reset_heap_profile();
+  osrf_testing_tools_cpp::memory_tools::enable_heap_profiling();
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::heap_profiling_enabled());
+  allocate_from_budget_test_call_site(3);
+  osrf_testing_tools_cpp::memory_tools::disable_heap_profiling();
+  // not counted anymore
+  allocate_from_budget_test_call_site(1);
+
+  const std::string path = testing::TempDir() + "test_heap_profile";
+  ASSERT_TRUE(
+    osrf_testing_tools_cpp::memory_tools::write_heap_profile(
+      path + ".collapsed", HeapProfileFormat::collapsed));
+  ASSERT_TRUE(
+    osrf_testing_tools_cpp::memory_tools::write_heap_profile(
+      path + ".pb", HeapProfileFormat::pprof));
+  const std::string collapsed = read_file(path + ".collapsed");
+  const std::string pprof = read_file(path + ".pb");
+  std::remove((path + ".collapsed").c_str());
+  std::remove((path + ".pb").c_str());
+#if defined(__linux__)
+  // three allocations of 64 bytes from the same call stack
+  EXPECT_NE(std::string::npos, collapsed.find(" 192\n")) << collapsed;
+  EXPECT_EQ(std::string::npos, collapsed.find(" 256\n")) << collapsed;
+  EXPECT_NE(std::string::npos, pprof.find("alloc_space"));
+#endif
+
+  // sampled, the estimate is scaled back up from about one allocation in 16 here
+  osrf_testing_tools_cpp::memory_tools::set_heap_profile_sample_rate(1024);
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::set_heap_profile_sample_rate(0);
+  });
+  osrf_testing_tools_cpp::memory_tools::reset_heap_profile();
+  osrf_testing_tools_cpp::memory_tools::enable_heap_profiling();
+  allocate_from_budget_test_call_site(10000);
+  osrf_testing_tools_cpp::memory_tools::disable_heap_profiling();
+  ASSERT_TRUE(
+    osrf_testing_tools_cpp::memory_tools::write_heap_profile(
+      path + ".collapsed", HeapProfileFormat::collapsed));
+  const std::string sampled = read_file(path + ".collapsed");
+  std::remove((path + ".collapsed").c_str());
+#if defined(__linux__)
+  // the biggest call stack comes first
+  const size_t first_line_end = sampled.find('\n');
+  ASSERT_NE(std::string::npos, first_line_end) << sampled;
+  const size_t bytes_begin = sampled.rfind(' ', first_line_end) + 1;
+  const double bytes = std::stod(sampled.substr(bytes_begin, first_line_end - bytes_begin));
+  EXPECT_NEAR(640000.0, bytes, 640000.0 * 0.25) << sampled;
+#endif
+}
+
+/**
+ * Tests that allocation sizes are bucketed by power of two for each call stack.
+ */
+TEST(TestMemoryTools, test_allocation_size_histograms) {
+  using osrf_testing_tools_cpp::memory_tools::get_allocation_size_bucket;
+  EXPECT_EQ(0u, get_allocation_size_bucket(0));
+  EXPECT_EQ(1u, get_allocation_size_bucket(1));
+  EXPECT_EQ(7u, get_allocation_size_bucket(64));
+  EXPECT_EQ(7u, get_allocation_size_bucket(127));
+  EXPECT_EQ(64u, get_allocation_size_bucket(UINT64_MAX));
+
+  osrf_testing_tools_cpp::memory_tools::reset_allocation_size_histograms();
+  osrf_testing_tools_cpp::memory_tools::enable_allocation_size_histograms();
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::allocation_size_histograms_enabled());
+  allocate_from_budget_test_call_site(3);
+  osrf_testing_tools_cpp::memory_tools::disable_allocation_size_histograms();
+  // not counted anymore
+  allocate_from_budget_test_call_site(1);
+
+  const auto histograms = osrf_testing_tools_cpp::memory_tools::get_allocation_size_histograms();
+  const std::string report =
+    osrf_testing_tools_cpp::memory_tools::format_allocation_size_histograms();
+#if defined(__linux__)
+  ASSERT_FALSE(histograms.empty());
+  // three allocations of 64 bytes from the same call stack, which made the most allocations
+  EXPECT_EQ(3u, histograms[0].count());
+  EXPECT_EQ(3u, histograms[0].buckets[7]);
+  EXPECT_EQ(192u, histograms[0].bytes_requested);
+  EXPECT_FALSE(histograms[0].stack.empty());
+  EXPECT_NE(std::string::npos, report.find("3 allocation(s), 192 bytes requested")) << report;
+  EXPECT_NE(std::string::npos, report.find("[64, 128): 3 (100%)")) << report;
+#endif
+}
+
+/**
+ * Tests that allocations freed right away, again and again, are flagged by the lifetime analysis.
+ */
+TEST(TestMemoryTools, test_allocation_lifetimes) {
+  osrf_testing_tools_cpp::memory_tools::reset_allocation_lifetimes();
+  if (!osrf_testing_tools_cpp::memory_tools::enable_allocation_lifetime_analysis()) {
+    GTEST_SKIP() << "the live allocation table is not available";
+  }
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::allocation_lifetime_analysis_enabled());
+  allocate_from_budget_test_call_site(100);
+  osrf_testing_tools_cpp::memory_tools::disable_allocation_lifetime_analysis();
+  // not counted anymore
+  allocate_from_budget_test_call_site(1);
+
+  const auto lifetimes = osrf_testing_tools_cpp::memory_tools::get_allocation_lifetimes();
+  const std::string report = osrf_testing_tools_cpp::memory_tools::format_allocation_lifetimes();
+  ASSERT_FALSE(lifetimes.empty());
+  // the call stack which freed the most comes first
+  EXPECT_EQ(100u, lifetimes[0].freed_count());
+  EXPECT_EQ(6400u, lifetimes[0].bytes_freed);
+  EXPECT_EQ(100u, lifetimes[0].freed_by_allocating_thread_count);
+  EXPECT_EQ(99u, lifetimes[0].allocated_after_free_count);
+  EXPECT_TRUE(lifetimes[0].is_short_lived());
+  EXPECT_TRUE(lifetimes[0].is_allocated_in_loop());
+  EXPECT_NE(std::string::npos, report.find("100 allocation(s) freed, 6400 bytes")) << report;
+  EXPECT_NE(std::string::npos, report.find("allocated in a loop: 99%")) << report;
+}
+
+__attribute__((noinline))
+static void
+grow_buffer_by_realloc(size_t final_size)
+{
+  void * buffer = malloc(16);
+  for (size_t size = 32; size <= final_size; size *= 2) {
+    buffer = realloc(buffer, size);
+  }
+  free(buffer);
+}
+
+/**
+ * Tests that blocks grown by realloc are followed back to the allocation which created them.
+ */
+TEST(TestMemoryTools, test_realloc_chains) {
+  osrf_testing_tools_cpp::memory_tools::reset_realloc_chains();
+  if (!osrf_testing_tools_cpp::memory_tools::enable_realloc_chain_analysis()) {
+    GTEST_SKIP() << "the live allocation table is not available";
+  }
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::realloc_chain_analysis_enabled());
+  // from the same call stack, the count is not a constant so that the loop cannot be unrolled
+  volatile size_t count = 2;
+  for (size_t i = 0; i < count; ++i) {
+    grow_buffer_by_realloc(4096);
+  }
+  osrf_testing_tools_cpp::memory_tools::disable_realloc_chain_analysis();
+  // not counted anymore
+  grow_buffer_by_realloc(4096);
+
+  const auto chains = osrf_testing_tools_cpp::memory_tools::get_realloc_chains();
+  const std::string report = osrf_testing_tools_cpp::memory_tools::format_realloc_chains();
+  ASSERT_FALSE(chains.empty());
+  const auto growing = std::find_if(
+    chains.begin(), chains.end(), [](const auto & call_site) {
+      return 2u == call_site.chain_count;
+    });
+  ASSERT_NE(chains.end(), growing) << report;
+  // from 16 to 4096 bytes, doubling each time
+  EXPECT_EQ(16u, growing->realloc_count);
+  EXPECT_EQ(16u, growing->geometric_growth_count);
+  EXPECT_EQ(8u, growing->max_chain_length);
+  EXPECT_EQ(4096u, growing->max_size);
+  EXPECT_TRUE(growing->is_missing_reserve());
+  EXPECT_TRUE(growing->grows_geometrically());
+  EXPECT_NE(
+    std::string::npos,
+    report.find("2 block(s) reallocated 16 time(s), 8.0 on average and at most 8")) << report;
+  EXPECT_NE(std::string::npos, report.find("consider allocating 4096 bytes up front")) << report;
+}
+
+/**
+ * Tests that memory freed by another thread is counted for the pair of threads and call stacks.
+ */
+TEST(TestMemoryTools, test_cross_thread_frees) {
+  // started before, creating a thread may allocate in this thread and free in the new one
+  std::atomic<int> thread_step(0);
+  uint32_t freeing_thread = 0;
+  std::thread thread([&thread_step, &freeing_thread]() {
+      freeing_thread = osrf_testing_tools_cpp::memory_tools::get_current_thread_index();
+      thread_step.store(1);
+      while (2 != thread_step.load()) {
+        std::this_thread::yield();
+      }
+      free(g_escaped_memory);
+      thread_step.store(3);
+    });
+  while (1 != thread_step.load()) {
+    std::this_thread::yield();
+  }
+  osrf_testing_tools_cpp::memory_tools::reset_cross_thread_frees();
+  if (!osrf_testing_tools_cpp::memory_tools::enable_cross_thread_free_analysis()) {
+    thread_step.store(2);
+    thread.join();
+    GTEST_SKIP() << "the live allocation table is not available";
+  }
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::cross_thread_free_analysis_enabled());
+  // freed by this thread
+  g_escaped_memory = malloc(10);
+  free(g_escaped_memory);
+  g_escaped_memory = malloc(100);
+  thread_step.store(2);
+  while (3 != thread_step.load()) {
+    std::this_thread::yield();
+  }
+  osrf_testing_tools_cpp::memory_tools::disable_cross_thread_free_analysis();
+  thread.join();
+
+  const auto totals = osrf_testing_tools_cpp::memory_tools::get_cross_thread_free_totals();
+  EXPECT_GE(totals.free_count, 2u);
+  EXPECT_EQ(1u, totals.cross_thread_free_count);
+  EXPECT_EQ(100u, totals.cross_thread_bytes);
+  const auto frees = osrf_testing_tools_cpp::memory_tools::get_cross_thread_frees();
+  ASSERT_EQ(1u, frees.size());
+  EXPECT_EQ(1u, frees[0].count);
+  EXPECT_EQ(100u, frees[0].bytes);
+  EXPECT_EQ(
+    osrf_testing_tools_cpp::memory_tools::get_current_thread_index(), frees[0].allocating_thread);
+  EXPECT_EQ(freeing_thread, frees[0].freeing_thread);
+  const std::string report = osrf_testing_tools_cpp::memory_tools::format_cross_thread_frees();
+  EXPECT_NE(std::string::npos, report.find("1 free(s), 100 bytes, allocated by thread")) << report;
+}
+
+/**
+ * Tests that the time spent in the original allocator is counted per thread, operation and size.
+ */
+TEST(TestMemoryTools, test_allocator_latency_histograms) {
+  using osrf_testing_tools_cpp::memory_tools::ALLOCATOR_LATENCY_BUCKET_COUNT;
+  using osrf_testing_tools_cpp::memory_tools::get_allocator_latency_bucket;
+  using osrf_testing_tools_cpp::memory_tools::get_allocator_latency_bucket_limit;
+  EXPECT_EQ(3u, get_allocator_latency_bucket(3));
+  EXPECT_EQ(4u, get_allocator_latency_bucket(4));
+  EXPECT_EQ(8u, get_allocator_latency_bucket(9));
+  EXPECT_EQ(ALLOCATOR_LATENCY_BUCKET_COUNT - 1, get_allocator_latency_bucket(UINT64_MAX));
+  for (size_t bucket = 0; bucket < ALLOCATOR_LATENCY_BUCKET_COUNT - 1; ++bucket) {
+    const uint64_t limit = get_allocator_latency_bucket_limit(bucket);
+    EXPECT_EQ(bucket, get_allocator_latency_bucket(limit));
+    EXPECT_EQ(bucket + 1, get_allocator_latency_bucket(limit + 1));
+  }
+
+  osrf_testing_tools_cpp::memory_tools::reset_allocator_latency_histograms();
+  osrf_testing_tools_cpp::memory_tools::enable_allocator_latency_histograms();
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::allocator_latency_histograms_enabled());
+  allocate_from_budget_test_call_site(100);
+  osrf_testing_tools_cpp::memory_tools::disable_allocator_latency_histograms();
+
+  const auto histograms =
+    osrf_testing_tools_cpp::memory_tools::get_allocator_latency_histograms();
+  const auto merged =
+    osrf_testing_tools_cpp::memory_tools::get_merged_allocator_latency_histograms();
+  const std::string report =
+    osrf_testing_tools_cpp::memory_tools::format_allocator_latency_histograms();
+#if defined(__linux__)
+  using osrf_testing_tools_cpp::memory_tools::MemoryFunctionType;
+  const uint32_t thread_index = osrf_testing_tools_cpp::memory_tools::get_current_thread_index();
+  const auto mallocs = std::find_if(
+    histograms.begin(), histograms.end(), [thread_index](const auto & histogram) {
+      return histogram.thread_index == thread_index &&
+      histogram.memory_function_type == MemoryFunctionType::Malloc && 0 == histogram.size_class;
+    });
+  ASSERT_NE(histograms.end(), mallocs) << report;
+  EXPECT_GE(mallocs->count(), 100u);
+  EXPECT_LE(mallocs->get_percentile_ns(50.0), mallocs->get_percentile_ns(99.0));
+  EXPECT_LE(mallocs->get_percentile_ns(99.0), mallocs->get_percentile_ns(99.9));
+  EXPECT_LE(mallocs->get_percentile_ns(99.9), mallocs->max_ns);
+  EXPECT_GE(mallocs->total_ns, mallocs->max_ns);
+  const auto frees = std::find_if(
+    merged.begin(), merged.end(), [](const auto & histogram) {
+      return 0u == histogram.thread_index &&
+      histogram.memory_function_type == MemoryFunctionType::Free && 0 == histogram.size_class;
+    });
+  ASSERT_NE(merged.end(), frees) << report;
+  EXPECT_GE(frees->count(), 100u);
+  EXPECT_NE(std::string::npos, report.find("p99.9 ns")) << report;
+  EXPECT_NE(std::string::npos, report.find("malloc          <=256B")) << report;
+  EXPECT_NE(std::string::npos, report.find("thread " + std::to_string(thread_index))) << report;
+#endif
+}
+
+/**
+ * Tests that the allocations of each thread are counted under its name, also after it exited.
+ */
+TEST(TestMemoryTools, test_thread_allocation_accounting) {
+  osrf_testing_tools_cpp::memory_tools::enable_thread_allocation_accounting();
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::thread_allocation_accounting_enabled());
+  uint32_t registered_thread = 0;
+  std::thread registered([&registered_thread]() {
+      registered_thread = osrf_testing_tools_cpp::memory_tools::get_current_thread_index();
+      osrf_testing_tools_cpp::memory_tools::set_current_thread_name("registered worker");
+      allocate_from_budget_test_call_site(10);
+    });
+  registered.join();
+#if defined(__linux__)
+  uint32_t system_named_thread = 0;
+  std::thread system_named([&system_named_thread]() {
+      system_named_thread = osrf_testing_tools_cpp::memory_tools::get_current_thread_index();
+      pthread_setname_np(pthread_self(), "io_worker");
+      // enough for the system name to be read again
+      allocate_from_budget_test_call_site(5000);
+    });
+  system_named.join();
+#endif
+  osrf_testing_tools_cpp::memory_tools::disable_thread_allocation_accounting();
+  EXPECT_FALSE(osrf_testing_tools_cpp::memory_tools::thread_allocation_accounting_enabled());
+
+  const auto threads = osrf_testing_tools_cpp::memory_tools::get_thread_allocation_stats();
+  const std::string report =
+    osrf_testing_tools_cpp::memory_tools::format_thread_allocation_stats();
+  const auto find_thread = [&threads](uint32_t thread_index) {
+      return std::find_if(
+        threads.begin(), threads.end(), [thread_index](const auto & thread) {
+          return thread.thread_index == thread_index;
+        });
+    };
+  const auto registered_stats = find_thread(registered_thread);
+  ASSERT_NE(threads.end(), registered_stats) << report;
+  EXPECT_EQ("registered worker", registered_stats->name);
+  EXPECT_GE(registered_stats->stats.allocation_count, 10u);
+  EXPECT_GE(registered_stats->stats.deallocation_count, 10u);
+  EXPECT_GE(registered_stats->stats.peak_live_bytes, 64);
+  EXPECT_NE(std::string::npos, report.find("registered worker")) << report;
+#if defined(__linux__)
+  const auto system_named_stats = find_thread(system_named_thread);
+  ASSERT_NE(threads.end(), system_named_stats) << report;
+  EXPECT_EQ("io_worker", system_named_stats->name);
+  EXPECT_GE(system_named_stats->stats.allocation_count, 5000u);
+  // most allocations first
+  EXPECT_EQ(system_named_thread, threads[0].thread_index) << report;
+#endif
+}
+
+/**
+ * Tests that the allocation report ranks the call sites by count, bytes and live bytes.
+ */
+TEST(TestMemoryTools, test_allocation_report) {
+  osrf_testing_tools_cpp::memory_tools::reset_heap_profile();
+  if (!osrf_testing_tools_cpp::memory_tools::enable_allocation_report()) {
+    osrf_testing_tools_cpp::memory_tools::disable_allocation_report();
+    GTEST_SKIP() << "the live allocation table is not available";
+  }
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::allocation_report_enabled());
+  EXPECT_TRUE(osrf_testing_tools_cpp::memory_tools::heap_profiling_enabled());
+  allocate_from_budget_test_call_site(100);
+  g_escaped_memory = malloc(100000);
+  osrf_testing_tools_cpp::memory_tools::disable_allocation_report();
+  EXPECT_FALSE(osrf_testing_tools_cpp::memory_tools::heap_profiling_enabled());
+
+  const auto hotspots = osrf_testing_tools_cpp::memory_tools::get_allocation_hotspots();
+  const std::string report =
+    osrf_testing_tools_cpp::memory_tools::format_allocation_report(3);
+  free(g_escaped_memory);
+  ASSERT_GE(hotspots.size(), 2u) << report;
+  // the loop made the most allocations, all freed
+  EXPECT_EQ(100u, hotspots[0].count) << report;
+  EXPECT_EQ(6400u, hotspots[0].bytes);
+  EXPECT_EQ(0u, hotspots[0].live_count);
+  const auto live = std::find_if(
+    hotspots.begin(), hotspots.end(), [](const auto & hotspot) {
+      return 100000u == hotspot.live_bytes;
+    });
+  ASSERT_NE(hotspots.end(), live) << report;
+  EXPECT_EQ(1u, live->count);
+  EXPECT_EQ(1u, live->live_count);
+  EXPECT_FALSE(live->stack.empty());
+  EXPECT_NE(std::string::npos, report.find("top 3 call site(s) by allocation count:\n#1: 100 "))
+    << report;
+  EXPECT_NE(std::string::npos, report.find("top 3 call site(s) by bytes allocated:\n#1: 1 "))
+    << report;
+  EXPECT_NE(std::string::npos, report.find("top 3 call site(s) by live bytes:\n#1: 1 "))
+    << report;
+}
+
+/**
+ * Tests that hooks can be replaced and cleared while other threads are calling them.
+ */
+TEST(TestMemoryTools, test_hook_replacement_while_allocating) {
+  static constexpr uint64_t MAGIC = 0x6d656d6f7279746fu;
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> calls(0);
+  std::atomic<size_t> corrupted_calls(0);
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring_in_all_threads();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&stop]() {
+        void * volatile memory = nullptr;
+        while (!stop.load()) {
+          memory = malloc(32);
+          free(memory);
+        }
+      });
+  }
+  for (uint64_t round = 0; round < 2000; ++round) {
+    // the captures are read after the callback may have been replaced, so a deleted one shows
+    const uint64_t expected_magic = MAGIC ^ round;
+    osrf_testing_tools_cpp::memory_tools::on_malloc(
+      [&calls, &corrupted_calls, expected_magic, round]() {
+        if ((MAGIC ^ round) != expected_magic) {
+          corrupted_calls++;
+        }
+        calls++;
+      });
+    if (0 == round % 3) {
+      osrf_testing_tools_cpp::memory_tools::on_malloc(nullptr);
+    }
+    // replacing a hook from within itself defers deleting it
+    osrf_testing_tools_cpp::memory_tools::on_free(
+      []() {
+        osrf_testing_tools_cpp::memory_tools::on_free(nullptr);
+      });
+  }
+  stop.store(true);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  osrf_testing_tools_cpp::memory_tools::on_malloc(nullptr);
+  osrf_testing_tools_cpp::memory_tools::on_free(nullptr);
+  EXPECT_GT(calls.load(), 0u);
+  EXPECT_EQ(0u, corrupted_calls.load());
+}
+
 void my_first_function(const std::string& str)
 {
   osrf_testing_tools_cpp::memory_tools::guaranteed_malloc(str);
@@ -254,4 +1057,154 @@ TEST(TestMemoryTools, test_static_allocation_alignment) {
     ASSERT_EQ(reinterpret_cast<size_t>(memory) % max_align, size_t(0));
     ASSERT_TRUE(allocator.deallocate(memory));
   }
+
+  // Check that aligned allocations honor alignments bigger than max_align.
+  for (const size_t alignment : {size_t(8), max_align, size_t(64), size_t(256)}) {
+    void * memory = allocator.aligned_allocate(alignment, 24);
+    ASSERT_NE(nullptr, memory);
+    ASSERT_EQ(reinterpret_cast<size_t>(memory) % alignment, size_t(0));
+    ASSERT_TRUE(allocator.deallocate(memory));
+  }
+  EXPECT_EQ(nullptr, allocator.aligned_allocate(3, 24));
+}
+
+/**
+ * Tests that logged memory events are written out once the event log is flushed.
+ */
+TEST(TestMemoryTools, test_event_log_flush) {
+  using osrf_testing_tools_cpp::memory_tools::VerbosityLevel;
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  auto previous_verbosity =
+    osrf_testing_tools_cpp::memory_tools::set_verbosity_level(VerbosityLevel::debug);
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::set_verbosity_level(previous_verbosity);
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+  if (!osrf_testing_tools_cpp::memory_tools::is_working()) {
+    GTEST_SKIP() << "memory tools is not working, e.g. not preloaded";
+  }
+  // the events from is_working() may otherwise be flushed while capturing
+  osrf_testing_tools_cpp::memory_tools::flush_event_log();
+
+  testing::internal::CaptureStdout();
+  g_escaped_memory = malloc(1234);
+  free(g_escaped_memory);
+  osrf_testing_tools_cpp::memory_tools::disable_monitoring();
+  osrf_testing_tools_cpp::memory_tools::flush_event_log();
+  std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_NE(std::string::npos, output.find(" malloc  (    expected) 1234 -> ")) << output;
+  EXPECT_NE(std::string::npos, output.find(" free    (    expected) ")) << output;
+  EXPECT_EQ(0u, osrf_testing_tools_cpp::memory_tools::get_dropped_event_count());
+}
+
+/**
+ * Tests that equal program counters are interned once and get the same id.
+ */
+TEST(TestMemoryTools, test_stack_table_interning) {
+  using osrf_testing_tools_cpp::memory_tools::get_interned_stack;
+  using osrf_testing_tools_cpp::memory_tools::intern_stack;
+  int markers[3];
+  void * stack_a[] = {&markers[0], &markers[1], &markers[2]};
+  void * stack_b[] = {&markers[0], &markers[1]};
+
+  uint32_t id_a = intern_stack(stack_a, 3);
+  uint32_t id_b = intern_stack(stack_b, 2);
+  ASSERT_NE(0u, id_a);
+  ASSERT_NE(0u, id_b);
+  EXPECT_NE(id_a, id_b);
+  EXPECT_EQ(id_a, intern_stack(stack_a, 3));
+
+  void * const * frames = nullptr;
+  ASSERT_EQ(3u, get_interned_stack(id_a, &frames));
+  EXPECT_EQ(&markers[2], frames[2]);
+  EXPECT_EQ(0u, get_interned_stack(0, &frames));
+}
+
+__attribute__((noinline))
+static void
+allocate_from_stack_id_test_call_site(size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    g_escaped_memory = malloc(42);
+    free(g_escaped_memory);
+  }
+}
+
+/**
+ * Tests that the stack id given to callbacks identifies the call site.
+ */
+TEST(TestMemoryTools, test_stack_id) {
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsService;
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+  if (!osrf_testing_tools_cpp::memory_tools::is_working()) {
+    GTEST_SKIP() << "memory tools is not working, e.g. not preloaded";
+  }
+
+  std::vector<uint32_t> stack_ids;
+  stack_ids.reserve(8);
+  osrf_testing_tools_cpp::memory_tools::on_malloc([&stack_ids](MemoryToolsService & service) {
+    service.ignore();
+    stack_ids.push_back(service.get_stack_id());
+  });
+  // not a constant, so that the loop cannot be unrolled into two call sites
+  volatile size_t count = 2;
+  allocate_from_stack_id_test_call_site(count);
+  g_escaped_memory = malloc(42);
+  free(g_escaped_memory);
+  osrf_testing_tools_cpp::memory_tools::disable_monitoring();
+  osrf_testing_tools_cpp::memory_tools::on_malloc(nullptr);
+
+  ASSERT_EQ(3u, stack_ids.size());
+  EXPECT_NE(0u, stack_ids[0]);
+  EXPECT_EQ(stack_ids[0], stack_ids[1]);
+  EXPECT_NE(stack_ids[0], stack_ids[2]);
+}
+
+/**
+ * Tests that repeated stack traces from the same call site hit the symbol cache.
+ */
+TEST(TestMemoryTools, test_symbol_cache) {
+  using osrf_testing_tools_cpp::memory_tools::MemoryToolsService;
+  using osrf_testing_tools_cpp::memory_tools::get_symbol_cache_statistics;
+  osrf_testing_tools_cpp::memory_tools::initialize();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT({
+    osrf_testing_tools_cpp::memory_tools::uninitialize();
+  });
+  osrf_testing_tools_cpp::memory_tools::enable_monitoring();
+  if (!osrf_testing_tools_cpp::memory_tools::is_working()) {
+    GTEST_SKIP() << "memory tools is not working, e.g. not preloaded";
+  }
+
+  std::vector<std::string> innermost_functions;
+  osrf_testing_tools_cpp::memory_tools::on_malloc(
+    [&innermost_functions](MemoryToolsService & service) {
+      service.ignore();
+      auto stack_trace = service.get_stack_trace();
+      if (nullptr != stack_trace && !stack_trace->get_traces().empty()) {
+        innermost_functions.push_back(stack_trace->get_traces()[0].object_function());
+      }
+    });
+  osrf_testing_tools_cpp::memory_tools::SymbolCacheStatistics after_first {};
+  for (int i = 0; i < 3; ++i) {
+    g_escaped_memory = malloc(42);
+    free(g_escaped_memory);
+    if (0 == i) {
+      after_first = get_symbol_cache_statistics();
+    }
+  }
+  auto after_repeats = get_symbol_cache_statistics();
+  osrf_testing_tools_cpp::memory_tools::disable_monitoring();
+
+  ASSERT_EQ(3u, innermost_functions.size());
+  EXPECT_EQ(innermost_functions[0], innermost_functions[2]);
+  EXPECT_GT(after_first.size, 0u);
+  // only the innermost frame is read, and it is the same call site every time
+  EXPECT_EQ(after_first.misses, after_repeats.misses);
+  EXPECT_EQ(after_first.hits + 2, after_repeats.hits);
 }